@@ -0,0 +1,448 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "BlockCompression.h"
+#include "ParallelFor.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+#include <emmintrin.h>
+#endif
+
+// Bytes of one encoded 4x4 block for both BC1 and BC4
+static const uint32 BytesPerBlock = 8;
+
+uint32 GetBlockCompressedSize(uint32 width, uint32 height)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * BytesPerBlock;
+}
+
+// Copies the 4x4 block at (blockX, blockY) into block, repeating the edge 
+// pixels of the image where the block extends past it.
+template<uint32 BytesPerPixel>
+static inline void LoadBlock(const uint8* image, uint32 width, uint32 height, uint32 blockX, uint32 blockY, uint8* block)
+{
+	for (uint32 y = 0; y < 4; ++y) {
+		const uint8* row = image + FMath::Min(blockY * 4 + y, height - 1) * width * BytesPerPixel;
+		for (uint32 x = 0; x < 4; ++x) {
+			const uint8* pixel = row + FMath::Min(blockX * 4 + x, width - 1) * BytesPerPixel;
+			for (uint32 c = 0; c < BytesPerPixel; ++c) {
+				*block++ = pixel[c];
+			}
+		}
+	}
+}
+
+// Computes the per-channel minimum and maximum of the 16 BGRA pixels of a block.
+static inline void ColorBounds(const uint8* block, uint8* minColor, uint8* maxColor)
+{
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	const __m128i* pixels = reinterpret_cast<const __m128i*>(block);
+	__m128i minimum = _mm_loadu_si128(pixels);
+	__m128i maximum = minimum;
+	for (uint32 i = 1; i < 4; ++i) {
+		const __m128i p = _mm_loadu_si128(pixels + i);
+		minimum = _mm_min_epu8(minimum, p);
+		maximum = _mm_max_epu8(maximum, p);
+	}
+	minimum = _mm_min_epu8(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+	maximum = _mm_max_epu8(maximum, _mm_shuffle_epi32(maximum, _MM_SHUFFLE(1, 0, 3, 2)));
+	minimum = _mm_min_epu8(minimum, _mm_shuffle_epi32(minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+	maximum = _mm_max_epu8(maximum, _mm_shuffle_epi32(maximum, _MM_SHUFFLE(2, 3, 0, 1)));
+	const uint32 packedMin = static_cast<uint32>(_mm_cvtsi128_si32(minimum));
+	const uint32 packedMax = static_cast<uint32>(_mm_cvtsi128_si32(maximum));
+	for (uint32 c = 0; c < 4; ++c) {
+		minColor[c] = static_cast<uint8>(packedMin >> (8 * c));
+		maxColor[c] = static_cast<uint8>(packedMax >> (8 * c));
+	}
+#else
+	for (uint32 c = 0; c < 4; ++c) {
+		minColor[c] = maxColor[c] = block[c];
+	}
+	for (uint32 i = 1; i < 16; ++i) {
+		for (uint32 c = 0; c < 4; ++c) {
+			minColor[c] = FMath::Min(minColor[c], block[i * 4 + c]);
+			maxColor[c] = FMath::Max(maxColor[c], block[i * 4 + c]);
+		}
+	}
+#endif
+}
+
+// Packs a BGR color given as floats into RGB 565.
+static inline uint16 PackColor565(const float* bgr)
+{
+	const int32 b = FMath::Clamp(FMath::RoundToInt(bgr[0] * (31.0f / 255.0f)), 0, 31);
+	const int32 g = FMath::Clamp(FMath::RoundToInt(bgr[1] * (63.0f / 255.0f)), 0, 63);
+	const int32 r = FMath::Clamp(FMath::RoundToInt(bgr[2] * (31.0f / 255.0f)), 0, 31);
+	return static_cast<uint16>((r << 11) | (g << 5) | b);
+}
+
+// Expands RGB 565 into BGR with 8 bits per channel.
+static inline void UnpackColor565(uint16 color, int32* bgr)
+{
+	const int32 r = (color >> 11) & 31;
+	const int32 g = (color >> 5) & 63;
+	const int32 b = color & 31;
+	bgr[0] = (b << 3) | (b >> 2);
+	bgr[1] = (g << 2) | (g >> 4);
+	bgr[2] = (r << 3) | (r >> 2);
+}
+
+// Builds the four-color palette of a BC1 block with color0 > color1.
+static inline void BuildPalette(uint16 color0, uint16 color1, int32 palette[4][3])
+{
+	UnpackColor565(color0, palette[0]);
+	UnpackColor565(color1, palette[1]);
+	for (uint32 c = 0; c < 3; ++c) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+}
+
+// Chooses the closest palette entry for every pixel and returns the 2-bit 
+// indices packed as stored in the block.
+static inline uint32 SelectIndices(const uint8* block, const int32 palette[4][3])
+{
+	uint32 indices = 0;
+	for (uint32 i = 0; i < 16; ++i) {
+		const uint8* p = block + i * 4;
+		int32 bestError = MAX_int32;
+		uint32 best = 0;
+		for (uint32 k = 0; k < 4; ++k) {
+			const int32 db = p[0] - palette[k][0];
+			const int32 dg = p[1] - palette[k][1];
+			const int32 dr = p[2] - palette[k][2];
+			const int32 error = db * db + dg * dg + dr * dr;
+			if (error < bestError) {
+				bestError = error;
+				best = k;
+			}
+		}
+		indices |= best << (2 * i);
+	}
+	return indices;
+}
+
+// Orders the endpoints for the four-color mode, then writes the block.
+static inline void WriteBC1Block(const uint8* block, uint16 color0, uint16 color1, uint8* out)
+{
+	uint32 indices = 0;
+	if (color0 < color1) {
+		Swap(color0, color1);
+	}
+	if (color0 != color1) {
+		int32 palette[4][3];
+		BuildPalette(color0, color1, palette);
+		indices = SelectIndices(block, palette);
+	}
+
+	out[0] = static_cast<uint8>(color0);
+	out[1] = static_cast<uint8>(color0 >> 8);
+	out[2] = static_cast<uint8>(color1);
+	out[3] = static_cast<uint8>(color1 >> 8);
+	out[4] = static_cast<uint8>(indices);
+	out[5] = static_cast<uint8>(indices >> 8);
+	out[6] = static_cast<uint8>(indices >> 16);
+	out[7] = static_cast<uint8>(indices >> 24);
+}
+
+// Takes the endpoints from the bounding box of the block, inset by 1/16 of its
+// size. Channels that decrease while the widest channel increases swap their
+// ends so that the diagonal follows the colors.
+static void EncodeBC1BlockFast(const uint8* block, uint8* out)
+{
+	uint8 minColor[4];
+	uint8 maxColor[4];
+	ColorBounds(block, minColor, maxColor);
+
+	uint32 widest = 0;
+	for (uint32 c = 1; c < 3; ++c) {
+		if (maxColor[c] - minColor[c] > maxColor[widest] - minColor[widest]) {
+			widest = c;
+		}
+	}
+
+	int32 mean[3] = { 0, 0, 0 };
+	for (uint32 i = 0; i < 16; ++i) {
+		for (uint32 c = 0; c < 3; ++c) {
+			mean[c] += block[i * 4 + c];
+		}
+	}
+	int32 covariance[3] = { 0, 0, 0 };
+	for (uint32 i = 0; i < 16; ++i) {
+		const int32 w = 16 * block[i * 4 + widest] - mean[widest];
+		for (uint32 c = 0; c < 3; ++c) {
+			covariance[c] += w * (16 * block[i * 4 + c] - mean[c]);
+		}
+	}
+
+	float endpoint0[3];
+	float endpoint1[3];
+	for (uint32 c = 0; c < 3; ++c) {
+		const float inset = (maxColor[c] - minColor[c]) / 16.0f;
+		const float high = maxColor[c] - inset;
+		const float low = minColor[c] + inset;
+		endpoint0[c] = (covariance[c] < 0) ? low : high;
+		endpoint1[c] = (covariance[c] < 0) ? high : low;
+	}
+
+	WriteBC1Block(block, PackColor565(endpoint0), PackColor565(endpoint1), out);
+}
+
+// Takes the endpoints from the extent of the block along the principal axis 
+// of its colors, then refits them by least squares to the indices chosen for
+// those endpoints.
+static void EncodeBC1BlockHighQuality(const uint8* block, uint8* out)
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (uint32 i = 0; i < 16; ++i) {
+		for (uint32 c = 0; c < 3; ++c) {
+			mean[c] += block[i * 4 + c];
+		}
+	}
+	for (uint32 c = 0; c < 3; ++c) {
+		mean[c] /= 16.0f;
+	}
+
+	float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (uint32 i = 0; i < 16; ++i) {
+		const float b = block[i * 4 + 0] - mean[0];
+		const float g = block[i * 4 + 1] - mean[1];
+		const float r = block[i * 4 + 2] - mean[2];
+		covariance[0] += b * b;
+		covariance[1] += b * g;
+		covariance[2] += b * r;
+		covariance[3] += g * g;
+		covariance[4] += g * r;
+		covariance[5] += r * r;
+	}
+
+	// Power iteration, starting from the luminance direction
+	float axis[3] = { 0.25f, 0.5f, 0.25f };
+	for (uint32 iteration = 0; iteration < 8; ++iteration) {
+		const float b = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+		const float g = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+		const float r = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+		const float length = FMath::Max3(FMath::Abs(b), FMath::Abs(g), FMath::Abs(r));
+		if (length < KINDA_SMALL_NUMBER) {
+			break;
+		}
+		axis[0] = b / length;
+		axis[1] = g / length;
+		axis[2] = r / length;
+	}
+	const float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+	float minProjection = MAX_flt;
+	float maxProjection = -MAX_flt;
+	for (uint32 i = 0; i < 16; ++i) {
+		const float t = (block[i * 4 + 0] - mean[0]) * axis[0] + 
+						(block[i * 4 + 1] - mean[1]) * axis[1] + 
+						(block[i * 4 + 2] - mean[2]) * axis[2];
+		minProjection = FMath::Min(minProjection, t);
+		maxProjection = FMath::Max(maxProjection, t);
+	}
+
+	float endpoint0[3];
+	float endpoint1[3];
+	for (uint32 c = 0; c < 3; ++c) {
+		endpoint0[c] = mean[c] + axis[c] * maxProjection / FMath::Max(axisLengthSquared, KINDA_SMALL_NUMBER);
+		endpoint1[c] = mean[c] + axis[c] * minProjection / FMath::Max(axisLengthSquared, KINDA_SMALL_NUMBER);
+	}
+
+	uint16 color0 = PackColor565(endpoint0);
+	uint16 color1 = PackColor565(endpoint1);
+	if (color0 < color1) {
+		Swap(color0, color1);
+	}
+
+	// Least squares fit of the endpoints to the chosen indices, where every
+	// pixel is alpha * endpoint0 + beta * endpoint1.
+	if (color0 != color1) {
+		int32 palette[4][3];
+		BuildPalette(color0, color1, palette);
+		const uint32 indices = SelectIndices(block, palette);
+
+		static const float Weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		float alpha2 = 0.0f;
+		float beta2 = 0.0f;
+		float alphaBeta = 0.0f;
+		float alphaX[3] = { 0.0f, 0.0f, 0.0f };
+		float betaX[3] = { 0.0f, 0.0f, 0.0f };
+		for (uint32 i = 0; i < 16; ++i) {
+			const float alpha = Weights[(indices >> (2 * i)) & 3];
+			const float beta = 1.0f - alpha;
+			alpha2 += alpha * alpha;
+			beta2 += beta * beta;
+			alphaBeta += alpha * beta;
+			for (uint32 c = 0; c < 3; ++c) {
+				alphaX[c] += alpha * block[i * 4 + c];
+				betaX[c] += beta * block[i * 4 + c];
+			}
+		}
+
+		const float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+		if (FMath::Abs(determinant) > KINDA_SMALL_NUMBER) {
+			for (uint32 c = 0; c < 3; ++c) {
+				endpoint0[c] = (alphaX[c] * beta2 - betaX[c] * alphaBeta) / determinant;
+				endpoint1[c] = (betaX[c] * alpha2 - alphaX[c] * alphaBeta) / determinant;
+			}
+
+			// Keep the refit endpoints only if they lower the error
+			const uint16 refit0 = PackColor565(endpoint0);
+			const uint16 refit1 = PackColor565(endpoint1);
+			uint8 original[BytesPerBlock];
+			uint8 refit[BytesPerBlock];
+			WriteBC1Block(block, color0, color1, original);
+			WriteBC1Block(block, refit0, refit1, refit);
+
+			uint8 decoded[64];
+			int64 errors[2] = { 0, 0 };
+			const uint8* candidates[2] = { original, refit };
+			for (uint32 k = 0; k < 2; ++k) {
+				DecodeBC1(candidates[k], 4, 4, decoded);
+				for (uint32 i = 0; i < 16; ++i) {
+					for (uint32 c = 0; c < 3; ++c) {
+						const int32 d = decoded[i * 4 + c] - block[i * 4 + c];
+						errors[k] += d * d;
+					}
+				}
+			}
+			FMemory::Memcpy(out, (errors[1] < errors[0]) ? refit : original, BytesPerBlock);
+			return;
+		}
+	}
+
+	WriteBC1Block(block, color0, color1, out);
+}
+
+void EncodeBC1(const uint8* bgra, uint32 width, uint32 height, bool bHighQuality, uint8* out)
+{
+	const uint32 blocksX = (width + 3) / 4;
+	const uint32 blocksY = (height + 3) / 4;
+
+	ParallelFor(blocksY, [=](int32 blockY) {
+		uint8 block[64];
+		uint8* blockOut = out + blockY * blocksX * BytesPerBlock;
+		for (uint32 blockX = 0; blockX < blocksX; ++blockX) {
+			LoadBlock<4>(bgra, width, height, blockX, blockY, block);
+			if (bHighQuality) {
+				EncodeBC1BlockHighQuality(block, blockOut);
+			}
+			else {
+				EncodeBC1BlockFast(block, blockOut);
+			}
+			blockOut += BytesPerBlock;
+		}
+	});
+}
+
+// Uses the eight-value mode with the block maximum as endpoint 0 and the 
+// minimum as endpoint 1, which stores the values 1/7 apart in between.
+static void EncodeBC4Block(const uint8* block, uint8* out)
+{
+	uint8 minValue = block[0];
+	uint8 maxValue = block[0];
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	__m128i minimum = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+	__m128i maximum = minimum;
+	minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 8));
+	maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 8));
+	minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 4));
+	maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 4));
+	minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 2));
+	maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 2));
+	minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 1));
+	maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 1));
+	minValue = static_cast<uint8>(_mm_cvtsi128_si32(minimum));
+	maxValue = static_cast<uint8>(_mm_cvtsi128_si32(maximum));
+#else
+	for (uint32 i = 1; i < 16; ++i) {
+		minValue = FMath::Min(minValue, block[i]);
+		maxValue = FMath::Max(maxValue, block[i]);
+	}
+#endif
+
+	uint64 indices = 0;
+	const int32 range = maxValue - minValue;
+	if (range > 0) {
+		for (uint32 i = 0; i < 16; ++i) {
+			// Position between the minimum (0) and the maximum (7), rounded
+			const int32 step = ((block[i] - minValue) * 14 + range) / (2 * range);
+			const uint64 index = (step == 7) ? 0 : ((step == 0) ? 1 : (8 - step));
+			indices |= index << (3 * i);
+		}
+	}
+
+	out[0] = maxValue;
+	out[1] = minValue;
+	for (uint32 i = 0; i < 6; ++i) {
+		out[2 + i] = static_cast<uint8>(indices >> (8 * i));
+	}
+}
+
+void EncodeBC4(const uint8* values, uint32 width, uint32 height, uint8* out)
+{
+	const uint32 blocksX = (width + 3) / 4;
+	const uint32 blocksY = (height + 3) / 4;
+
+	ParallelFor(blocksY, [=](int32 blockY) {
+		uint8 block[16];
+		uint8* blockOut = out + blockY * blocksX * BytesPerBlock;
+		for (uint32 blockX = 0; blockX < blocksX; ++blockX) {
+			LoadBlock<1>(values, width, height, blockX, blockY, block);
+			EncodeBC4Block(block, blockOut);
+			blockOut += BytesPerBlock;
+		}
+	});
+}
+
+void DecodeBC1(const uint8* blocks, uint32 width, uint32 height, uint8* bgra)
+{
+	const uint32 blocksX = (width + 3) / 4;
+	const uint32 blocksY = (height + 3) / 4;
+	for (uint32 blockY = 0; blockY < blocksY; ++blockY) {
+		for (uint32 blockX = 0; blockX < blocksX; ++blockX) {
+			const uint8* block = blocks + (blockY * blocksX + blockX) * BytesPerBlock;
+			const uint16 color0 = block[0] | (block[1] << 8);
+			const uint16 color1 = block[2] | (block[3] << 8);
+			const uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32>(block[7]) << 24);
+
+			int32 palette[4][3];
+			BuildPalette(color0, color1, palette);
+			if (color0 <= color1) {
+				// Three-color mode, never written by the encoder
+				for (uint32 c = 0; c < 3; ++c) {
+					palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+					palette[3][c] = 0;
+				}
+			}
+
+			for (uint32 y = 0; y < 4; ++y) {
+				for (uint32 x = 0; x < 4; ++x) {
+					if ((blockX * 4 + x >= width) || (blockY * 4 + y >= height)) {
+						continue;
+					}
+					const int32* color = palette[(indices >> (2 * (y * 4 + x))) & 3];
+					uint8* pixel = bgra + ((blockY * 4 + y) * width + blockX * 4 + x) * 4;
+					pixel[0] = static_cast<uint8>(color[0]);
+					pixel[1] = static_cast<uint8>(color[1]);
+					pixel[2] = static_cast<uint8>(color[2]);
+					pixel[3] = 255;
+				}
+			}
+		}
+	}
+}
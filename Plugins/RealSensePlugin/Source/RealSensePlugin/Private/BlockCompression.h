@@ -0,0 +1,42 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+// Block compression (BC1 / DXT1 and BC4) of camera images on the CPU.
+//
+// Images are split into rows of 4x4 blocks that are encoded in parallel with
+// ParallelFor. Blocks that extend past the image border repeat the edge 
+// pixels. Both encoders trade some quality for speed compared to offline 
+// texture compressors, so that a full color frame can be encoded every tick:
+// - The fast BC1 mode takes the endpoints from the bounding box of the block 
+//   colors, oriented along the sign of their covariance.
+// - The high quality BC1 mode takes the endpoints from the principal axis of 
+//   the block colors and refines them once by least squares.
+// - BC4 takes the endpoints from the range of the block values.
+
+// Returns the size in bytes of a BC1 or BC4 image of the given size.
+uint32 GetBlockCompressedSize(uint32 width, uint32 height);
+
+// Encodes a BGRA image into BC1 blocks. Alpha is ignored.
+void EncodeBC1(const uint8* bgra, uint32 width, uint32 height, bool bHighQuality, uint8* out);
+
+// Encodes a single-channel 8-bit image into BC4 blocks.
+void EncodeBC4(const uint8* values, uint32 width, uint32 height, uint8* out);
+
+// Decodes BC1 blocks into a BGRA image, used to measure the encoding error.
+void DecodeBC1(const uint8* blocks, uint32 width, uint32 height, uint8* bgra);
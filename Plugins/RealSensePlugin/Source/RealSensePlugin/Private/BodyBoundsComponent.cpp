@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "BodyBoundsComponent.h"
+
+UBodyBoundsComponent::UBodyBoundsComponent(const class FObjectInitializer& ObjInit) 
+	: Super(ObjInit) 
+{ 
+	m_feature = RealSenseFeature::CAMERA_STREAMING;
+}
+
+void UBodyBoundsComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, 
+										 FActorComponentTickFunction *ThisTickFunction) 
+{
+	if (globalRealSenseSession->IsCameraRunning() == false) {
+		return;
+	}
+
+	// The bounds drive gameplay, so the data is read on every tick
+	globalRealSenseSession->NotifyDataAccess();
+
+	const bool bWasDetected = BodyBounds.bDetected;
+	BodyBounds = globalRealSenseSession->GetBodyBounds();
+
+	if (BodyBounds.bDetected && (bWasDetected == false)) {
+		OnBodyFound.Broadcast();
+	}
+	else if ((BodyBounds.bDetected == false) && bWasDetected) {
+		OnBodyLost.Broadcast();
+	}
+}
+
+void UBodyBoundsComponent::EnableBodyBounds()
+{
+	globalRealSenseSession->EnableBodyBounds();
+}
+
+void UBodyBoundsComponent::DisableBodyBounds()
+{
+	globalRealSenseSession->DisableBodyBounds();
+}
+
+void UBodyBoundsComponent::SetFloorPlane(FVector Point, FVector Normal)
+{
+	globalRealSenseSession->SetFloorPlane(FPlane(Point, Normal.GetSafeNormal()));
+}
+
+void UBodyBoundsComponent::ClearFloorPlane()
+{
+	globalRealSenseSession->ClearFloorPlane();
+}
@@ -0,0 +1,240 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "BodyBoundsEstimator.h"
+#include "RealSenseUtils.h"
+
+#include <algorithm>
+
+DECLARE_CYCLE_STAT(TEXT("Body Bounds"), STAT_RealSenseBodyBounds, STATGROUP_RealSense);
+
+// Points closer to the floor than this (in centimeters) belong to the floor
+static const float MinFloorDistance = 5.0f;
+
+// Neighbouring points belong to the same object if their depths differ by at
+// most the larger of MinDepthStep millimeters and DepthStepRatio times the depth
+static const float MinDepthStep = 100.0f;
+static const float DepthStepRatio = 0.05f;
+
+// Range of plausible body sizes (in centimeters)
+static const float MinBodyHeight = 30.0f;
+static const float MaxBodyHeight = 250.0f;
+static const float MaxBodyWidth = 150.0f;
+
+// Percentile of the point heights taken as the top of the head, which 
+// ignores single points of noise above the head
+static const float HeadPercentile = 0.98f;
+
+// Weight of the latest centroid derivative in the smoothed velocity
+static const float VelocitySmoothing = 0.5f;
+
+BodyBoundsEstimator::BodyBoundsEstimator()
+{
+	Reset();
+}
+
+void BodyBoundsEstimator::Reset()
+{
+	bHadBody = false;
+	previousCentroid = FVector::ZeroVector;
+	previousTimestamp = 0.0;
+	velocity = FVector::ZeroVector;
+}
+
+int32 BodyBoundsEstimator::Find(int32 i)
+{
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+void BodyBoundsEstimator::Union(int32 a, int32 b)
+{
+	a = Find(a);
+	b = Find(b);
+	if (a < b) {
+		parent[b] = a;
+	}
+	else if (b < a) {
+		parent[a] = b;
+	}
+}
+
+FBodyBounds BodyBoundsEstimator::Estimate(const TArray<uint16>& depth, const uint32 width, const uint32 height,
+										  float horizontalFOV, float verticalFOV, const FTransform& cameraToWorld,
+										  const FPlane* floor, double timestamp)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseBodyBounds);
+
+	FBodyBounds bounds;
+	if ((depth.Num() < (int32)(width * height)) || (width == 0) || (height == 0)) {
+		bHadBody = false;
+		return bounds;
+	}
+
+	const float fx = 0.5f * width / FMath::Tan(FMath::DegreesToRadians(horizontalFOV * 0.5f));
+	const float fy = 0.5f * height / FMath::Tan(FMath::DegreesToRadians(verticalFOV * 0.5f));
+	const float cx = 0.5f * width;
+	const float cy = 0.5f * height;
+
+	// Camera space in millimeters to world space in centimeters
+	const float millimetersToCentimeters = 0.1f;
+	const FVector origin = cameraToWorld.GetLocation();
+	const FVector ray0 = cameraToWorld.TransformVector(ConvertRSVectorToUnreal(FVector(-cx / fx, -cy / fy, 1.0f)) * millimetersToCentimeters);
+	const FVector rayU = cameraToWorld.TransformVector(ConvertRSVectorToUnreal(FVector(1.0f / fx, 0.0f, 0.0f)) * millimetersToCentimeters);
+	const FVector rayV = cameraToWorld.TransformVector(ConvertRSVectorToUnreal(FVector(0.0f, 1.0f / fy, 0.0f)) * millimetersToCentimeters);
+
+	// Heights are measured along up, from the floor if there is one
+	const FVector up = floor ? FVector(floor->X, floor->Y, floor->Z).GetSafeNormal() : FVector::UpVector;
+	const float floorHeight = floor ? floor->W / FVector(floor->X, floor->Y, floor->Z).Size() : 0.0f;
+	FVector axis0, axis1;
+	up.FindBestAxisVectors(axis0, axis1);
+
+	// Deprojects the decimated grid
+	const uint32 step = FMath::Max(width / GridWidth, 1u);
+	const int32 columns = (width + step - 1) / step;
+	const int32 rows = (height + step - 1) / step;
+	const int32 count = columns * rows;
+	points.SetNumUninitialized(count);
+	depths.SetNumUninitialized(count);
+	parent.SetNumUninitialized(count);
+	for (int32 row = 0; row < rows; ++row) {
+		const uint32 v = row * step;
+		const uint16* line = depth.GetData() + v * width;
+		const FVector rowRay = ray0 + rayV * (float)v;
+		for (int32 column = 0; column < columns; ++column) {
+			const uint32 u = column * step;
+			const int32 i = row * columns + column;
+			const float z = line[u];
+			points[i] = origin + (rowRay + rayU * (float)u) * z;
+			depths[i] = z;
+			const bool bValid = (z > 0.0f) && (FVector::DotProduct(up, points[i]) - floorHeight > MinFloorDistance);
+			parent[i] = bValid ? i : INDEX_NONE;
+		}
+	}
+
+	// Joins neighbouring points at similar depths
+	auto IsConnected = [this](int32 a, int32 b) {
+		return (parent[a] != INDEX_NONE) && (parent[b] != INDEX_NONE) && 
+			   (FMath::Abs(depths[a] - depths[b]) <= FMath::Max(MinDepthStep, DepthStepRatio * depths[a]));
+	};
+	for (int32 row = 0; row < rows; ++row) {
+		for (int32 column = 0; column < columns; ++column) {
+			const int32 i = row * columns + column;
+			if ((column + 1 < columns) && IsConnected(i, i + 1)) {
+				Union(i, i + 1);
+			}
+			if ((row + 1 < rows) && IsConnected(i, i + columns)) {
+				Union(i, i + columns);
+			}
+		}
+	}
+
+	// Measures every component in the horizontal basis and along up
+	components.Reset();
+	componentIndex.SetNumUninitialized(count);
+	for (int32 i = 0; i < count; ++i) {
+		if (parent[i] == INDEX_NONE) {
+			continue;
+		}
+		const int32 root = Find(i);
+		const FVector p(FVector::DotProduct(axis0, points[i]), FVector::DotProduct(axis1, points[i]), FVector::DotProduct(up, points[i]));
+		if (root == i) {
+			componentIndex[i] = components.Num();
+			components.Add(Component{ i, 0, 0.0f, p, p });
+		}
+		Component& component = components[componentIndex[root]];
+		component.count++;
+		component.depthSum += depths[i];
+		component.lower = component.lower.ComponentMin(p);
+		component.upper = component.upper.ComponentMax(p);
+	}
+
+	// Picks the nearest component of a plausible size
+	const Component* body = nullptr;
+	for (const Component& component : components) {
+		const FVector size = component.upper - component.lower;
+		if ((component.count >= MinPoints) && 
+			(size.Z >= MinBodyHeight) && (size.Z <= MaxBodyHeight) && 
+			(size.X <= MaxBodyWidth) && (size.Y <= MaxBodyWidth) &&
+			((body == nullptr) || (component.depthSum * body->count < body->depthSum * component.count))) {
+			body = &component;
+		}
+	}
+	if (body == nullptr) {
+		bHadBody = false;
+		return bounds;
+	}
+
+	// Collects the body points and their horizontal covariance
+	bodyPoints.Reset(body->count);
+	heights.Reset(body->count);
+	FVector centroid = FVector::ZeroVector;
+	for (int32 i = 0; i < count; ++i) {
+		if ((parent[i] != INDEX_NONE) && (Find(i) == body->root)) {
+			bodyPoints.Add(points[i]);
+			heights.Add(FVector::DotProduct(up, points[i]) - floorHeight);
+			centroid += points[i];
+		}
+	}
+	centroid /= bodyPoints.Num();
+
+	float cxx = 0.0f, cxy = 0.0f, cyy = 0.0f;
+	for (const FVector& point : bodyPoints) {
+		const float x = FVector::DotProduct(axis0, point - centroid);
+		const float y = FVector::DotProduct(axis1, point - centroid);
+		cxx += x * x;
+		cxy += x * y;
+		cyy += y * y;
+	}
+	const float angle = 0.5f * FMath::Atan2(2.0f * cxy, cxx - cyy);
+	const FVector boxX = axis0 * FMath::Cos(angle) + axis1 * FMath::Sin(angle);
+	const FVector boxY = FVector::CrossProduct(up, boxX);
+
+	FVector boxMin(MAX_flt), boxMax(-MAX_flt);
+	for (const FVector& point : bodyPoints) {
+		const FVector p(FVector::DotProduct(boxX, point), FVector::DotProduct(boxY, point), FVector::DotProduct(up, point));
+		boxMin = boxMin.ComponentMin(p);
+		boxMax = boxMax.ComponentMax(p);
+	}
+	const FVector center = (boxMin + boxMax) * 0.5f;
+
+	const int32 headIndex = FMath::FloorToInt(HeadPercentile * (heights.Num() - 1));
+	std::nth_element(heights.GetData(), heights.GetData() + headIndex, heights.GetData() + heights.Num());
+
+	if (bHadBody && (timestamp > previousTimestamp)) {
+		const FVector derivative = (centroid - previousCentroid) / (float)(timestamp - previousTimestamp);
+		velocity = FMath::Lerp(velocity, derivative, VelocitySmoothing);
+	}
+	else {
+		velocity = FVector::ZeroVector;
+	}
+	bHadBody = true;
+	previousCentroid = centroid;
+	previousTimestamp = timestamp;
+
+	bounds.bDetected = true;
+	bounds.Center = boxX * center.X + boxY * center.Y + up * center.Z;
+	bounds.Extent = (boxMax - boxMin) * 0.5f;
+	bounds.Rotation = FRotationMatrix::MakeFromXZ(boxX, up).Rotator();
+	bounds.HeadHeight = heights[headIndex];
+	bounds.Centroid = centroid;
+	bounds.Velocity = velocity;
+	bounds.NumPoints = bodyPoints.Num();
+	return bounds;
+}
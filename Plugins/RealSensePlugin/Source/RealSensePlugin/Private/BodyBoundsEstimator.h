@@ -0,0 +1,79 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+// Finds the bounds of the person closest to the depth camera without 
+// skeletal tracking.
+//
+// The depth image is decimated to a grid about GridWidth points wide and 
+// deprojected into world space. Points on or below the optional floor plane 
+// are discarded, and neighbouring grid points are joined into connected 
+// components with a union-find unless their depths differ by more than a 
+// step that grows with the distance. The nearest component whose size is 
+// plausible for a person is taken as the body. Its bounds are oriented along
+// the principal horizontal axis of its points, the top of the head is a 
+// high percentile of the point heights, and the velocity is the smoothed 
+// derivative of the centroid.
+class BodyBoundsEstimator {
+public:
+	BodyBoundsEstimator();
+
+	// Forgets the previous body, so that the next velocity starts at zero.
+	void Reset();
+
+	// Estimates the body in a depth image (in millimeters). cameraToWorld 
+	// places the camera in the world, with points converted to UE4 axes and 
+	// centimeters. floor is a world-space plane whose normal points up, or 
+	// nullptr if the floor is unknown, in which case world Z points up. 
+	// timestamp is the time of the frame in seconds.
+	FBodyBounds Estimate(const TArray<uint16>& depth, const uint32 width, const uint32 height,
+						 float horizontalFOV, float verticalFOV, const FTransform& cameraToWorld,
+						 const FPlane* floor, double timestamp);
+
+	// Approximate number of grid points per row of the decimated depth image
+	static const int32 GridWidth = 80;
+
+	// Fewest grid points of a body
+	static const int32 MinPoints = 20;
+
+private:
+	struct Component {
+		int32 root;
+		int32 count;
+		float depthSum;
+		FVector lower;  // Along the horizontal basis and up
+		FVector upper;
+	};
+
+	TArray<FVector> points;
+	TArray<float> depths;
+	TArray<int32> parent;
+	TArray<int32> componentIndex;
+	TArray<Component> components;
+	TArray<FVector> bodyPoints;
+	TArray<float> heights;
+
+	bool bHadBody;
+	FVector previousCentroid;
+	double previousTimestamp;
+	FVector velocity;
+
+	int32 Find(int32 i);
+
+	void Union(int32 a, int32 b);
+};
@@ -16,11 +16,14 @@
 
 #include "RealSensePluginPrivatePCH.h"
 #include "CameraStreamComponent.h"
+#include "BlockCompression.h"
 
 UCameraStreamComponent::UCameraStreamComponent(const class FObjectInitializer& ObjInit) 
 	: Super(ObjInit) 
 { 
 	m_feature = RealSenseFeature::CAMERA_STREAMING;
+
+	TextureCompression = ETextureCompression::NONE;
 }
 
 // Adds the CAMERA_STREAMING feature to the RealSenseSessionManager and
@@ -31,6 +34,11 @@ void UCameraStreamComponent::InitializeComponent()
 
 	ColorTexture = UTexture2D::CreateTransient(1, 1, EPixelFormat::PF_B8G8R8A8);
 	DepthTexture = UTexture2D::CreateTransient(1, 1, EPixelFormat::PF_B8G8R8A8);
+	UpsampledDepthTexture = UTexture2D::CreateTransient(1, 1, EPixelFormat::PF_B8G8R8A8);
+	DistanceFieldTexture = UTexture2D::CreateTransient(1, 1, EPixelFormat::PF_G8);
+
+	DepthUpsampleMilliseconds = 0.0f;
+	TextureUpdateMilliseconds = 0.0f;
 }
 
 // Copies the ColorBuffer and DepthBuffer from the RealSenseSessionManager.
@@ -41,8 +49,28 @@ void UCameraStreamComponent::TickComponent(float DeltaTime, enum ELevelTick Tick
 		return;
 	}
 
+	NotifyDataAccessIfRendered(ColorTexture);
+	NotifyDataAccessIfRendered(DepthTexture);
+	NotifyDataAccessIfRendered(UpsampledDepthTexture);
+	NotifyDataAccessIfRendered(DistanceFieldTexture);
+
 	ColorBuffer = globalRealSenseSession->GetColorBuffer();
 	DepthBuffer = globalRealSenseSession->GetDepthBuffer();
+	DepthQuality = globalRealSenseSession->GetDepthQuality();
+
+	if (bDepthUpsampleEnabled) {
+		UpsampledDepthBuffer = globalRealSenseSession->GetUpsampledDepthBuffer();
+		DepthUpsampleMilliseconds = globalRealSenseSession->GetDepthUpsampleMilliseconds();
+	}
+
+	if (bDistanceFieldEnabled) {
+		DistanceFieldBuffer = globalRealSenseSession->GetDistanceFieldBuffer();
+	}
+
+	if (bReplayStarted && (globalRealSenseSession->IsReplaying() == false)) {
+		bReplayStarted = false;
+		OnReplayFinished.Broadcast();
+	}
 }
 
 // If the supplied resolution is valid, this function will pass that resolution
@@ -59,7 +87,7 @@ void UCameraStreamComponent::SetColorCameraResolution(EColorResolution resolutio
 	int ColorImageWidth = globalRealSenseSession->GetColorImageWidth();
 	int ColorImageHeight = globalRealSenseSession->GetColorImageHeight();
 	ColorTexture = UTexture2D::CreateTransient(ColorImageWidth, ColorImageHeight,
-											   PF_B8G8R8A8);
+											   GetColorPixelFormat());
 	ColorTexture->UpdateResource();
 }
 
@@ -77,7 +105,7 @@ void UCameraStreamComponent::SetDepthCameraResolution(EDepthResolution resolutio
 	int DepthImageWidth = globalRealSenseSession->GetDepthImageWidth();
 	int DepthImageHeight = globalRealSenseSession->GetDepthImageHeight();
 	DepthTexture = UTexture2D::CreateTransient(DepthImageWidth, DepthImageHeight, 
-											   PF_B8G8R8A8);
+											   GetDepthPixelFormat());
 	DepthTexture->UpdateResource();
 }
 
@@ -89,4 +117,223 @@ void UCameraStreamComponent::Enable3DSegmentation(bool b3DSeg)
 		m_feature = RealSenseFeature::SEGMENTATION_3D;
 		Super::EnableFeature();
 	}
-}
\ No newline at end of file
+}
+
+// Enables depth upsampling in the RealSenseSessionManager and recreates the
+// UpsampledDepthTexture to have the resolution of the upsampled depth image.
+void UCameraStreamComponent::EnableDepthUpsampling(EDepthUpsampleScale Scale)
+{
+	globalRealSenseSession->EnableDepthUpsampling(Scale);
+
+	int UpsampledDepthImageWidth = globalRealSenseSession->GetUpsampledDepthImageWidth();
+	int UpsampledDepthImageHeight = globalRealSenseSession->GetUpsampledDepthImageHeight();
+	if ((UpsampledDepthImageWidth == 0) || (UpsampledDepthImageHeight == 0)) {
+		return;
+	}
+
+	bDepthUpsampleEnabled = true;
+	UpsampledDepthTexture = UTexture2D::CreateTransient(UpsampledDepthImageWidth, UpsampledDepthImageHeight,
+														GetDepthPixelFormat());
+	UpsampledDepthTexture->UpdateResource();
+}
+
+void UCameraStreamComponent::DisableDepthUpsampling()
+{
+	globalRealSenseSession->DisableDepthUpsampling();
+	bDepthUpsampleEnabled = false;
+}
+
+// Enables the distance field in the RealSenseSessionManager and recreates the
+// DistanceFieldTexture with a matching size and single-channel pixel format.
+void UCameraStreamComponent::EnableDistanceField(EDistanceFieldSource Source, int32 Width, int32 Height,
+												 EDistanceFieldFormat Format, float MaxDistance)
+{
+	if ((Width <= 0) || (Height <= 0)) {
+		return;
+	}
+
+	globalRealSenseSession->EnableDistanceField(Source, Width, Height, Format, MaxDistance);
+	bDistanceFieldEnabled = true;
+
+	DistanceFieldTexture = UTexture2D::CreateTransient(Width, Height, 
+													   (Format == EDistanceFieldFormat::G16) ? PF_G16 : PF_G8);
+	DistanceFieldTexture->UpdateResource();
+}
+
+void UCameraStreamComponent::DisableDistanceField()
+{
+	globalRealSenseSession->DisableDistanceField();
+	bDistanceFieldEnabled = false;
+}
+
+void UCameraStreamComponent::SetDistanceFieldDepthRange(int32 NearDepth, int32 FarDepth)
+{
+	globalRealSenseSession->SetDistanceFieldDepthRange(NearDepth, FarDepth);
+}
+
+EPixelFormat UCameraStreamComponent::GetColorPixelFormat() const
+{
+	return (TextureCompression == ETextureCompression::NONE) ? PF_B8G8R8A8 : PF_DXT1;
+}
+
+EPixelFormat UCameraStreamComponent::GetDepthPixelFormat() const
+{
+	return (TextureCompression == ETextureCompression::NONE) ? PF_B8G8R8A8 : PF_BC4;
+}
+
+// Recreates the textures that were already sized by the camera resolutions 
+// or by depth upsampling.
+void UCameraStreamComponent::SetTextureCompression(ETextureCompression Compression)
+{
+	TextureCompression = Compression;
+
+	if (ColorTexture && (ColorTexture->GetSizeX() > 1)) {
+		ColorTexture = UTexture2D::CreateTransient(ColorTexture->GetSizeX(), ColorTexture->GetSizeY(), 
+												   GetColorPixelFormat());
+		ColorTexture->UpdateResource();
+	}
+	if (DepthTexture && (DepthTexture->GetSizeX() > 1)) {
+		DepthTexture = UTexture2D::CreateTransient(DepthTexture->GetSizeX(), DepthTexture->GetSizeY(), 
+												   GetDepthPixelFormat());
+		DepthTexture->UpdateResource();
+	}
+	if (bDepthUpsampleEnabled) {
+		UpsampledDepthTexture = UTexture2D::CreateTransient(UpsampledDepthTexture->GetSizeX(), UpsampledDepthTexture->GetSizeY(),
+															GetDepthPixelFormat());
+		UpsampledDepthTexture->UpdateResource();
+	}
+}
+
+// The block encoders spread each texture over the task graph worker threads.
+void UCameraStreamComponent::UpdateTextures()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const bool bHighQuality = (TextureCompression == ETextureCompression::HIGH_QUALITY);
+
+	URealSenseBlueprintLibrary::ColorBufferToTexture(ColorBuffer, ColorTexture, bHighQuality);
+	globalRealSenseSession->RecordColorTextureUpload(ColorBuffer, ColorTexture);
+	URealSenseBlueprintLibrary::DepthBufferToTexture(DepthBuffer, DepthTexture);
+	if (bDepthUpsampleEnabled) {
+		URealSenseBlueprintLibrary::DepthBufferToTexture(UpsampledDepthBuffer, UpsampledDepthTexture);
+	}
+
+	const float Milliseconds = static_cast<float>(1000.0 * (FPlatformTime::Seconds() - StartTime));
+	TextureUpdateMilliseconds = (TextureUpdateMilliseconds > 0.0f) ? FMath::Lerp(TextureUpdateMilliseconds, Milliseconds, 0.1f) : Milliseconds;
+}
+
+// Reports the average encoding time over a number of runs and the peak 
+// signal-to-noise ratio of the decoded color image.
+void UCameraStreamComponent::BenchmarkTextureCompression()
+{
+	const int32 Width = globalRealSenseSession->GetColorImageWidth();
+	const int32 Height = globalRealSenseSession->GetColorImageHeight();
+	if ((Width == 0) || (ColorBuffer.Num() != Width * Height)) {
+		RS_LOG(Warning, "Texture compression benchmark needs a color image")
+		return;
+	}
+
+	const int32 NumRuns = 10;
+	const uint8* Pixels = reinterpret_cast<const uint8*>(ColorBuffer.GetData());
+	TArray<uint8> Blocks;
+	TArray<uint8> Decoded;
+	Blocks.SetNumUninitialized(GetBlockCompressedSize(Width, Height));
+	Decoded.SetNumUninitialized(Width * Height * 4);
+
+	RS_LOG(Log, "Texture compression of %d x %d color: %d KB uncompressed, %d KB BC1", Width, Height, 
+		   Width * Height * 4 / 1024, Blocks.Num() / 1024)
+
+	for (bool bHighQuality : { false, true }) {
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Run = 0; Run < NumRuns; ++Run) {
+			EncodeBC1(Pixels, Width, Height, bHighQuality, Blocks.GetData());
+		}
+		const double Milliseconds = 1000.0 * (FPlatformTime::Seconds() - StartTime) / NumRuns;
+
+		DecodeBC1(Blocks.GetData(), Width, Height, Decoded.GetData());
+		double SquaredError = 0.0;
+		for (int32 i = 0; i < Width * Height; ++i) {
+			for (int32 c = 0; c < 3; ++c) {
+				SquaredError += FMath::Square(static_cast<double>(Decoded[i * 4 + c]) - Pixels[i * 4 + c]);
+			}
+		}
+		const double MeanSquaredError = FMath::Max(SquaredError / (Width * Height * 3), 1e-6);
+		RS_LOG(Log, "  BC1 %s: %.2f ms, %.2f dB", bHighQuality ? TEXT("high quality") : TEXT("fast"), 
+			   Milliseconds, 10.0 * FMath::LogX(10.0f, 255.0f * 255.0f / MeanSquaredError))
+	}
+
+	const int32 DepthWidth = globalRealSenseSession->GetDepthImageWidth();
+	const int32 DepthHeight = globalRealSenseSession->GetDepthImageHeight();
+	if ((DepthWidth > 0) && (DepthBuffer.Num() == DepthWidth * DepthHeight)) {
+		TArray<uint8> Values;
+		Values.SetNumUninitialized(DepthBuffer.Num());
+		for (int32 i = 0; i < DepthBuffer.Num(); ++i) {
+			Values[i] = ConvertDepthValueTo8Bit(DepthBuffer[i], DepthWidth);
+		}
+		Blocks.SetNumUninitialized(GetBlockCompressedSize(DepthWidth, DepthHeight));
+
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Run = 0; Run < NumRuns; ++Run) {
+			EncodeBC4(Values.GetData(), DepthWidth, DepthHeight, Blocks.GetData());
+		}
+		RS_LOG(Log, "  BC4 depth %d x %d: %.2f ms, %d KB", DepthWidth, DepthHeight, 
+			   1000.0 * (FPlatformTime::Seconds() - StartTime) / NumRuns, Blocks.Num() / 1024)
+	}
+}
+
+void UCameraStreamComponent::EnableFrameRecording(float DurationSeconds, int32 MemoryLimitMB)
+{
+	globalRealSenseSession->EnableFrameRecording(DurationSeconds, MemoryLimitMB);
+}
+
+void UCameraStreamComponent::DisableFrameRecording()
+{
+	bReplayStarted = false;
+	globalRealSenseSession->DisableFrameRecording();
+}
+
+void UCameraStreamComponent::StartReplay(float SecondsAgo, float Speed)
+{
+	globalRealSenseSession->StartReplay(SecondsAgo, Speed);
+	bReplayStarted = globalRealSenseSession->IsReplaying();
+}
+
+void UCameraStreamComponent::SeekReplay(float SecondsAgo)
+{
+	globalRealSenseSession->SeekReplay(SecondsAgo);
+}
+
+void UCameraStreamComponent::SetReplaySpeed(float Speed)
+{
+	globalRealSenseSession->SetReplaySpeed(Speed);
+}
+
+void UCameraStreamComponent::StopReplay()
+{
+	bReplayStarted = false;
+	globalRealSenseSession->StopReplay();
+}
+
+bool UCameraStreamComponent::IsReplaying()
+{
+	return globalRealSenseSession->IsReplaying();
+}
+
+float UCameraStreamComponent::GetRecordedSeconds()
+{
+	return globalRealSenseSession->GetRecordedSeconds();
+}
+
+float UCameraStreamComponent::GetReplaySecondsAgo()
+{
+	return globalRealSenseSession->GetReplaySecondsAgo();
+}
+
+void UCameraStreamComponent::StartLatencyTest(float FramesPerSecond)
+{
+	globalRealSenseSession->StartLatencyTest(FramesPerSecond);
+}
+
+void UCameraStreamComponent::StopLatencyTest()
+{
+	globalRealSenseSession->StopLatencyTest();
+}
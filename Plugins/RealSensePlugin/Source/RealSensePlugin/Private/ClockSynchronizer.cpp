@@ -0,0 +1,157 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "ClockSynchronizer.h"
+#include <algorithm>
+#include <cmath>
+
+// Sensor timestamps are in units of 100 ns
+static const double SecondsPerTick = 1e-7;
+
+// Number of times the fit is repeated on the lower half of the residuals
+static const int32 NumRefinements = 3;
+
+ClockSynchronizer::ClockSynchronizer()
+{
+	Reset();
+}
+
+void ClockSynchronizer::Reset()
+{
+	samples.Reset();
+	nextSample = 0;
+	bHasOrigin = false;
+	originTimestamp = 0;
+	originHost = 0.0;
+	offset = 0.0;
+	rate = 1.0;
+	uncertainty = -1.0;
+	bFitted = false;
+}
+
+// The origins keep the fitted values small so that doubles keep sub-microsecond 
+// precision over long sessions.
+void ClockSynchronizer::AddSample(int64 sensorTimestamp, double hostSeconds)
+{
+	if (bHasOrigin == false) {
+		bHasOrigin = true;
+		originTimestamp = sensorTimestamp;
+		originHost = hostSeconds;
+	}
+
+	const Sample sample = { (sensorTimestamp - originTimestamp) * SecondsPerTick, hostSeconds - originHost };
+
+	// A sensor clock that jumps backwards (device reset) invalidates the fit
+	if ((samples.Num() > 0) && (sample.sensorSeconds < samples[(nextSample + samples.Num() - 1) % samples.Num()].sensorSeconds)) {
+		Reset();
+		AddSample(sensorTimestamp, hostSeconds);
+		return;
+	}
+
+	if (samples.Num() < WindowSize) {
+		samples.Add(sample);
+		nextSample = samples.Num() % WindowSize;
+	}
+	else {
+		samples[nextSample] = sample;
+		nextSample = (nextSample + 1) % WindowSize;
+	}
+
+	if (samples.Num() >= MinSamples) {
+		Fit();
+	}
+	else {
+		// Until the fit is available, follow the latest arrival
+		offset = sample.hostSeconds - sample.sensorSeconds;
+		rate = 1.0;
+	}
+}
+
+double ClockSynchronizer::SensorToHost(int64 sensorTimestamp) const
+{
+	return originHost + offset + rate * (sensorTimestamp - originTimestamp) * SecondsPerTick;
+}
+
+void ClockSynchronizer::Fit()
+{
+	const int32 n = samples.Num();
+	residuals.SetNumUninitialized(n);
+
+	// Start from the mean of all samples, then keep the samples whose residual
+	// is at most the median of the previous fit.
+	double threshold = MAX_dbl;
+	double fitOffset = 0.0;
+	double fitRate = 0.0;
+	double fitUncertainty = -1.0;
+	for (int32 iteration = 0; iteration <= NumRefinements; ++iteration) {
+		double meanSensor = 0.0;
+		double meanHost = 0.0;
+		int32 count = 0;
+		for (int32 i = 0; i < n; ++i) {
+			if ((iteration == 0) || (residuals[i] <= threshold)) {
+				meanSensor += samples[i].sensorSeconds;
+				meanHost += samples[i].hostSeconds;
+				count++;
+			}
+		}
+		if (count < 2) {
+			break;
+		}
+		meanSensor /= count;
+		meanHost /= count;
+
+		double covariance = 0.0;
+		double variance = 0.0;
+		for (int32 i = 0; i < n; ++i) {
+			if ((iteration == 0) || (residuals[i] <= threshold)) {
+				const double ds = samples[i].sensorSeconds - meanSensor;
+				covariance += ds * (samples[i].hostSeconds - meanHost);
+				variance += ds * ds;
+			}
+		}
+		if (variance <= 0.0) {
+			break;
+		}
+
+		fitRate = covariance / variance;
+		fitOffset = meanHost - fitRate * meanSensor;
+
+		for (int32 i = 0; i < n; ++i) {
+			residuals[i] = samples[i].hostSeconds - (fitOffset + fitRate * samples[i].sensorSeconds);
+		}
+		sortedResiduals = residuals;
+		std::nth_element(sortedResiduals.GetData(), sortedResiduals.GetData() + n / 2, sortedResiduals.GetData() + n);
+		threshold = sortedResiduals[n / 2];
+
+		double squaredResidualSum = 0.0;
+		int32 inliers = 0;
+		for (int32 i = 0; i < n; ++i) {
+			if (residuals[i] <= threshold) {
+				squaredResidualSum += residuals[i] * residuals[i];
+				inliers++;
+			}
+		}
+		fitUncertainty = std::sqrt(squaredResidualSum / inliers);
+	}
+
+	// Drift of real clocks is far below 1%, anything else is a bad fit
+	if ((fitUncertainty >= 0.0) && (FMath::Abs(fitRate - 1.0) < 0.01)) {
+		offset = fitOffset;
+		rate = fitRate;
+		uncertainty = fitUncertainty;
+		bFitted = true;
+	}
+}
@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+// Maps sensor timestamps to host time (FPlatformTime::Seconds()).
+//
+// Every frame contributes its sensor timestamp and the host time at which it 
+// arrived. Arrival is delayed by a transport latency that is never negative 
+// and occasionally large, so the clock offset and drift are fitted with an 
+// iterated ordinary least squares fit over a sliding window: after the first 
+// fit over all samples, the fit is repeated on the samples whose residuals 
+// are at or below the median, which discards the late half of the arrivals. 
+// Mapped times are therefore biased towards the early arrivals of a frame 
+// rather than its average arrival. The root mean square of the residuals at 
+// or below the median is reported as the uncertainty of the mapping.
+class ClockSynchronizer {
+public:
+	ClockSynchronizer();
+
+	// Discards all samples, for example after the camera has been restarted.
+	void Reset();
+
+	// Adds a frame with the given sensor timestamp (in 100 ns units) that 
+	// arrived at hostSeconds, and updates the fit.
+	void AddSample(int64 sensorTimestamp, double hostSeconds);
+
+	// Returns the host time (in seconds) of a sensor timestamp. Before 
+	// enough samples have been collected this is the latest arrival time 
+	// shifted by the sensor time elapsed since.
+	double SensorToHost(int64 sensorTimestamp) const;
+
+	// Returns the standard deviation (in seconds) of the arrival times 
+	// around the fit, or a negative value while there is no fit.
+	inline double GetUncertainty() const { return uncertainty; }
+
+	// Returns the rate of the sensor clock relative to the host clock, minus 
+	// one, in parts per million.
+	inline double GetDriftPPM() const { return (1.0 / rate - 1.0) * 1e6; }
+
+	// Number of frames in the sliding window
+	static const int32 WindowSize = 300;
+
+	// Number of frames needed before the fit is used
+	static const int32 MinSamples = 30;
+
+private:
+	struct Sample {
+		double sensorSeconds;  // Relative to originTimestamp
+		double hostSeconds;  // Relative to originHost
+	};
+
+	TArray<Sample> samples;  // Ring buffer of WindowSize samples
+	int32 nextSample;
+
+	bool bHasOrigin;
+	int64 originTimestamp;
+	double originHost;
+
+	// Host seconds = offset + rate * sensor seconds, both relative to the origins
+	double offset;
+	double rate;
+	double uncertainty;
+	bool bFitted;
+
+	TArray<double> residuals;
+	TArray<double> sortedResiduals;
+
+	void Fit();
+};
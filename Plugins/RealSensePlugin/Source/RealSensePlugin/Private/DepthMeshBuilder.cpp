@@ -0,0 +1,300 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "DepthMeshBuilder.h"
+#include "RealSenseUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Depth Mesh"), STAT_RealSenseDepthMesh, STATGROUP_RealSense);
+
+// The smallest triangles span a depth discontinuity if their depths differ 
+// by more than the larger of MinDepthStep millimeters and DepthStepRatio 
+// times the nearest depth
+static const float MinDepthStep = 30.0f;
+static const float DepthStepRatio = 0.05f;
+
+DepthMeshBuilder::DepthMeshBuilder()
+{
+	gridTileSize = 0;
+	numTriangles = 0;
+	numParentTriangles = 0;
+	uScale = 1.0f;
+	vScale = 1.0f;
+	focalX = 1.0f;
+	focalY = 1.0f;
+	centerX = 0.0f;
+	centerY = 0.0f;
+	maxError = 0.0f;
+}
+
+DepthMeshBuilder::~DepthMeshBuilder()
+{
+	if (pendingBuild.valid()) {
+		pendingBuild.wait();
+	}
+}
+
+// Precomputes the hypotenuse of every triangle of the RTIN hierarchy. 
+// Triangle i has the id i + 2, whose lowest bit selects one of the two root 
+// triangles and whose further bits, from the highest, select the left or 
+// right half at every split. Children therefore always have higher indices 
+// than their parents.
+void DepthMeshBuilder::SetTileSize(int32 tileSize)
+{
+	tileSize = FMath::RoundUpToPowerOfTwo(FMath::Clamp(tileSize, MinTileSize, MaxTileSize));
+	if (tileSize == gridTileSize) {
+		return;
+	}
+
+	gridTileSize = tileSize;
+	numTriangles = tileSize * tileSize * 2 - 2;
+	numParentTriangles = numTriangles - tileSize * tileSize;
+	coords.SetNumUninitialized(numTriangles * 4);
+
+	for (int32 i = 0; i < numTriangles; ++i) {
+		uint32 id = i + 2;
+		int32 ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+		if (id & 1) {
+			bx = by = cx = tileSize;
+		}
+		else {
+			ax = ay = cy = tileSize;
+		}
+		while ((id >>= 1) > 1) {
+			const int32 mx = (ax + bx) >> 1;
+			const int32 my = (ay + by) >> 1;
+			if (id & 1) {
+				bx = ax;
+				by = ay;
+				ax = cx;
+				ay = cy;
+			}
+			else {
+				ax = bx;
+				ay = by;
+				bx = cx;
+				by = cy;
+			}
+			cx = mx;
+			cy = my;
+		}
+		uint16* c = &coords[i * 4];
+		c[0] = ax;
+		c[1] = ay;
+		c[2] = bx;
+		c[3] = by;
+	}
+
+	const int32 size = tileSize + 1;
+	grid.SetNumUninitialized(size * size);
+	errors.SetNumUninitialized(size * size);
+	vertexIndex.SetNumUninitialized(size * size);
+}
+
+void DepthMeshBuilder::Build(const TArray<uint16>& depth, const uint32 width, const uint32 height,
+							 float horizontalFOV, float verticalFOV, int32 tileSize, float errorThreshold, DepthMesh& mesh)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseDepthMesh);
+
+	mesh.vertices.Reset();
+	mesh.triangles.Reset();
+	mesh.normals.Reset();
+	mesh.uvs.Reset();
+
+	if ((depth.Num() < (int32)(width * height)) || (width < 2) || (height < 2)) {
+		return;
+	}
+
+	SetTileSize(tileSize);
+	maxError = errorThreshold;
+
+	const int32 size = gridTileSize + 1;
+	uScale = (width - 1) / (float)gridTileSize;
+	vScale = (height - 1) / (float)gridTileSize;
+	focalX = 0.5f * width / FMath::Tan(FMath::DegreesToRadians(horizontalFOV * 0.5f));
+	focalY = 0.5f * height / FMath::Tan(FMath::DegreesToRadians(verticalFOV * 0.5f));
+	centerX = 0.5f * width;
+	centerY = 0.5f * height;
+
+	// Samples the grid from the nearest depth pixels
+	for (int32 y = 0; y < size; ++y) {
+		const uint16* line = depth.GetData() + FMath::RoundToInt(y * vScale) * width;
+		uint16* row = grid.GetData() + y * size;
+		for (int32 x = 0; x < size; ++x) {
+			row[x] = line[FMath::RoundToInt(x * uScale)];
+		}
+	}
+
+	ComputeErrors();
+
+	for (int32 i = 0; i < vertexIndex.Num(); ++i) {
+		vertexIndex[i] = INDEX_NONE;
+	}
+	AddTriangles(0, 0, gridTileSize, gridTileSize, gridTileSize, 0, mesh);
+	AddTriangles(gridTileSize, gridTileSize, 0, 0, 0, gridTileSize, mesh);
+
+	for (FVector& normal : mesh.normals) {
+		normal = normal.GetSafeNormal();
+	}
+}
+
+// Visits the triangles from the smallest to the largest, so that the error 
+// of every grid point includes the errors of all grid points below the 
+// triangles it splits.
+void DepthMeshBuilder::ComputeErrors()
+{
+	const int32 size = gridTileSize + 1;
+	for (int32 i = 0; i < errors.Num(); ++i) {
+		errors[i] = 0.0f;
+	}
+
+	for (int32 i = numTriangles - 1; i >= 0; --i) {
+		const uint16* c = &coords[i * 4];
+		const int32 ax = c[0], ay = c[1], bx = c[2], by = c[3];
+		const int32 mx = (ax + bx) >> 1;
+		const int32 my = (ay + by) >> 1;
+
+		const float za = grid[ay * size + ax];
+		const float zb = grid[by * size + bx];
+		const float zm = grid[my * size + mx];
+
+		// The harmonic mean interpolates linearly in inverse depth
+		float error = MAX_flt;
+		if ((za > 0.0f) && (zb > 0.0f) && (zm > 0.0f)) {
+			error = FMath::Abs(zm - 2.0f * za * zb / (za + zb));
+		}
+
+		float& middleError = errors[my * size + mx];
+		middleError = FMath::Max(middleError, error);
+
+		if (i < numParentTriangles) {
+			const int32 cx = mx + my - ay;
+			const int32 cy = my + ax - mx;
+			const float leftError = errors[((ay + cy) >> 1) * size + ((ax + cx) >> 1)];
+			const float rightError = errors[((by + cy) >> 1) * size + ((bx + cx) >> 1)];
+			middleError = FMath::Max3(middleError, leftError, rightError);
+		}
+	}
+}
+
+// Splits the triangle with the hypotenuse (a, b) and the right angle at c 
+// until its error is below maxError or it spans a single grid step.
+void DepthMeshBuilder::AddTriangles(int32 ax, int32 ay, int32 bx, int32 by, int32 cx, int32 cy, DepthMesh& mesh)
+{
+	const int32 mx = (ax + bx) >> 1;
+	const int32 my = (ay + by) >> 1;
+	const bool bSmallest = (FMath::Abs(ax - cx) + FMath::Abs(ay - cy)) <= 1;
+
+	if ((bSmallest == false) && (errors[my * (gridTileSize + 1) + mx] > maxError)) {
+		AddTriangles(cx, cy, ax, ay, mx, my, mesh);
+		AddTriangles(bx, by, cx, cy, mx, my, mesh);
+	}
+	else {
+		EmitTriangle(ax, ay, bx, by, cx, cy, mesh);
+	}
+}
+
+void DepthMeshBuilder::EmitTriangle(int32 ax, int32 ay, int32 bx, int32 by, int32 cx, int32 cy, DepthMesh& mesh)
+{
+	const int32 size = gridTileSize + 1;
+	const float za = grid[ay * size + ax];
+	const float zb = grid[by * size + bx];
+	const float zc = grid[cy * size + cx];
+	if ((za == 0.0f) || (zb == 0.0f) || (zc == 0.0f)) {
+		return;
+	}
+
+	// Larger triangles only remain if they fit the depth, so only the 
+	// smallest ones can bridge a discontinuity
+	const float nearest = FMath::Min3(za, zb, zc);
+	if (FMath::Max3(za, zb, zc) - nearest > FMath::Max(MinDepthStep, DepthStepRatio * nearest)) {
+		return;
+	}
+
+	int32 a = GetVertex(ax, ay, mesh);
+	int32 b = GetVertex(bx, by, mesh);
+	int32 c = GetVertex(cx, cy, mesh);
+
+	// Orders the triangle so that its front faces the camera. The engine 
+	// takes (P1 - P2) x (P0 - P2) as the front, which is the negated cross 
+	// product below.
+	FVector cross = FVector::CrossProduct(mesh.vertices[b] - mesh.vertices[a], mesh.vertices[c] - mesh.vertices[a]);
+	if (FVector::DotProduct(cross, mesh.vertices[a]) < 0.0f) {
+		Swap(b, c);
+		cross = -cross;
+	}
+
+	mesh.triangles.Add(a);
+	mesh.triangles.Add(b);
+	mesh.triangles.Add(c);
+
+	// Area weighted vertex normals
+	mesh.normals[a] -= cross;
+	mesh.normals[b] -= cross;
+	mesh.normals[c] -= cross;
+}
+
+int32 DepthMeshBuilder::GetVertex(int32 x, int32 y, DepthMesh& mesh)
+{
+	int32& index = vertexIndex[y * (gridTileSize + 1) + x];
+	if (index == INDEX_NONE) {
+		const float u = x * uScale;
+		const float v = y * vScale;
+		const float z = grid[y * (gridTileSize + 1) + x];
+
+		// Camera space in millimeters to centimeters
+		const FVector point((u - centerX) / focalX * z, (v - centerY) / focalY * z, z);
+		index = mesh.vertices.Add(ConvertRSVectorToUnreal(point) * 0.1f);
+		mesh.normals.Add(FVector::ZeroVector);
+		mesh.uvs.Add(FVector2D(x / (float)gridTileSize, y / (float)gridTileSize));
+	}
+	return index;
+}
+
+bool DepthMeshBuilder::BuildAsync(const FRealSenseFrameSnapshot& snapshot, float horizontalFOV, float verticalFOV, 
+								  int32 tileSize, float errorThreshold)
+{
+	if (pendingBuild.valid()) {
+		return false;
+	}
+
+	FRealSenseFrameSnapshot frame = snapshot;
+	pendingBuild = std::async(std::launch::async, [this, frame, horizontalFOV, verticalFOV, tileSize, errorThreshold]() mutable {
+		const FStreamResolution& resolution = frame.GetDepthResolution();
+		Build(frame.GetDepthImage(), resolution.width, resolution.height, 
+			  horizontalFOV, verticalFOV, tileSize, errorThreshold, result);
+
+		// Lets the camera thread reuse the frame
+		frame.Reset();
+	});
+	return true;
+}
+
+// The arrays of the previous mesh are swapped into the result, so that the 
+// next build reuses their memory.
+bool DepthMeshBuilder::FetchMesh(DepthMesh& mesh)
+{
+	if ((pendingBuild.valid() == false) || 
+		(pendingBuild.wait_for(std::chrono::seconds(0)) != std::future_status::ready)) {
+		return false;
+	}
+	pendingBuild.get();
+
+	Swap(mesh.vertices, result.vertices);
+	Swap(mesh.triangles, result.triangles);
+	Swap(mesh.normals, result.normals);
+	Swap(mesh.uvs, result.uvs);
+	return true;
+}
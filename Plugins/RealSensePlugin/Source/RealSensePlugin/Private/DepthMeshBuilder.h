@@ -0,0 +1,101 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <future>
+
+#include "RealSenseFrameSnapshot.h"
+
+// Triangle mesh in the layout taken by UProceduralMeshComponent::CreateMeshSection()
+struct DepthMesh {
+	TArray<FVector> vertices;  // Camera space, in UE4 axes and centimeters
+	TArray<int32> triangles;
+	TArray<FVector> normals;
+	TArray<FVector2D> uvs;  // Normalized depth image coordinates
+};
+
+// Builds an adaptive triangle mesh of the surfaces seen in a depth image.
+//
+// The depth image is sampled on a grid of (tileSize + 1) x (tileSize + 1) 
+// points, which is triangulated as a right-angled triangulated irregular 
+// network (RTIN): starting from two triangles covering the grid, a triangle 
+// is split at the middle of its hypotenuse until the mesh approximates all 
+// grid points under it within the error threshold. The error of a grid 
+// point is the distance along its ray between its depth and the depth 
+// interpolated from the ends of the hypotenuse. Depths are interpolated 
+// linearly in inverse depth, which is exact for planes, so flat walls and 
+// tables stay a few large triangles while curved surfaces are refined. 
+// Errors of the smaller triangles are propagated to the larger ones, which 
+// keeps the mesh free of cracks.
+//
+// Triangles are split down to the grid spacing around invalid depth, and 
+// the smallest triangles that touch invalid depth or span a depth 
+// discontinuity are left out of the mesh.
+class DepthMeshBuilder {
+public:
+	DepthMeshBuilder();
+
+	// Waits for a build in progress.
+	~DepthMeshBuilder();
+
+	// Builds the mesh of a depth image (in millimeters). tileSize is rounded
+	// to a power of two and errorThreshold is in millimeters.
+	void Build(const TArray<uint16>& depth, const uint32 width, const uint32 height,
+			   float horizontalFOV, float verticalFOV, int32 tileSize, float errorThreshold, DepthMesh& mesh);
+
+	// Runs Build() on the depth image of the snapshot on a worker thread. 
+	// Returns false if the previous build has not been fetched yet.
+	bool BuildAsync(const FRealSenseFrameSnapshot& snapshot, float horizontalFOV, float verticalFOV, 
+					int32 tileSize, float errorThreshold);
+
+	// Swaps the mesh of a finished BuildAsync() into mesh and returns true, 
+	// or returns false if no build has finished since the last call.
+	bool FetchMesh(DepthMesh& mesh);
+
+	inline bool IsBuilding() const { return pendingBuild.valid(); }
+
+	// Limits of tileSize
+	static const int32 MinTileSize = 16;
+	static const int32 MaxTileSize = 512;
+
+private:
+	int32 gridTileSize;
+	int32 numTriangles;
+	int32 numParentTriangles;
+	TArray<uint16> coords;  // Hypotenuse ends (ax, ay, bx, by) of every triangle
+	TArray<uint16> grid;  // Sampled depths
+	TArray<float> errors;  // Approximation error of every grid point
+	TArray<int32> vertexIndex;  // Mesh vertex of every grid point, or INDEX_NONE
+
+	float uScale;  // Depth pixels per grid step
+	float vScale;
+	float focalX, focalY;  // Depth camera intrinsics derived from the field of view
+	float centerX, centerY;
+	float maxError;
+
+	DepthMesh result;
+	std::future<void> pendingBuild;
+
+	void SetTileSize(int32 tileSize);
+
+	void ComputeErrors();
+
+	void AddTriangles(int32 ax, int32 ay, int32 bx, int32 by, int32 cx, int32 cy, DepthMesh& mesh);
+
+	void EmitTriangle(int32 ax, int32 ay, int32 bx, int32 by, int32 cx, int32 cy, DepthMesh& mesh);
+
+	int32 GetVertex(int32 x, int32 y, DepthMesh& mesh);
+};
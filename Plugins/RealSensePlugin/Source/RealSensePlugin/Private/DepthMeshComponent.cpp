@@ -0,0 +1,88 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "DepthMeshComponent.h"
+#include "DepthMeshBuilder.h"
+
+UDepthMeshComponent::UDepthMeshComponent(const class FObjectInitializer& ObjInit) 
+	: Super(ObjInit) 
+{ 
+	m_feature = RealSenseFeature::CAMERA_STREAMING;
+
+	UpdatesPerSecond = 10.0f;
+	GridResolution = 128;
+	MaxError = 10.0f;
+
+	LastBuildTime = 0.0;
+	LastBuildFrame = 0;
+}
+
+void UDepthMeshComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Builder = std::make_shared<DepthMeshBuilder>();
+}
+
+// Releasing the builder waits for a build in progress.
+void UDepthMeshComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Builder.reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Collects the mesh of a finished build, and then starts building the 
+// latest depth image if the update interval has passed.
+void UDepthMeshComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, 
+										FActorComponentTickFunction *ThisTickFunction) 
+{
+	if ((Builder == nullptr) || (globalRealSenseSession->IsCameraRunning() == false)) {
+		return;
+	}
+
+	// The arrays of the current mesh are handed back to the builder for reuse
+	DepthMesh Mesh;
+	Swap(Mesh.vertices, Vertices);
+	Swap(Mesh.triangles, Triangles);
+	Swap(Mesh.normals, Normals);
+	Swap(Mesh.uvs, UV0);
+	const bool bUpdated = Builder->FetchMesh(Mesh);
+	Swap(Mesh.vertices, Vertices);
+	Swap(Mesh.triangles, Triangles);
+	Swap(Mesh.normals, Normals);
+	Swap(Mesh.uvs, UV0);
+
+	if (bUpdated) {
+		OnDepthMeshUpdated.Broadcast();
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if ((UpdatesPerSecond <= 0.0f) || (Now - LastBuildTime < 1.0 / UpdatesPerSecond) || Builder->IsBuilding()) {
+		return;
+	}
+
+	// The mesh is built from the depth stream, so building counts as access
+	globalRealSenseSession->NotifyDataAccess();
+
+	const FRealSenseFrameSnapshot Snapshot = globalRealSenseSession->GetFrameSnapshot();
+	if (Snapshot.IsValid() && (Snapshot.GetFrameNumber() != LastBuildFrame) && (Snapshot.GetDepthImage().Num() > 0)) {
+		Builder->BuildAsync(Snapshot, globalRealSenseSession->GetDepthHorizontalFOV(), 
+							globalRealSenseSession->GetDepthVerticalFOV(), GridResolution, MaxError);
+		LastBuildTime = Now;
+		LastBuildFrame = Snapshot.GetFrameNumber();
+	}
+}
@@ -0,0 +1,221 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "DepthQualityEstimator.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+#include <emmintrin.h>
+#endif
+
+// The histogram used for the median has 8 mm wide bins covering the whole
+// 16-bit depth range.
+static const uint32 HistogramShift = 3;
+static const uint32 HistogramSize = 65536 >> HistogramShift;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+// Adds up the eight 16-bit lanes of v.
+static inline uint32 HorizontalSum16(__m128i v)
+{
+	__m128i sum = _mm_madd_epi16(v, _mm_set1_epi16(1));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return static_cast<uint32>(_mm_cvtsi128_si32(sum));
+}
+
+// Adds up the four 32-bit lanes of v.
+static inline uint32 HorizontalSum32(__m128i v)
+{
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return static_cast<uint32>(_mm_cvtsi128_si32(v));
+}
+#endif
+
+DepthQualityEstimator::DepthQualityEstimator()
+{
+	histogram.SetNumZeroed(HistogramSize);
+}
+
+FDepthQualityMetrics DepthQualityEstimator::Analyze(const TArray<uint16>& depth, const uint32 width, const uint32 height)
+{
+	FDepthQualityMetrics metrics;
+
+	const uint32 numPixels = width * height;
+	if ((numPixels == 0) || (depth.Num() < (int32)numPixels)) {
+		return metrics;
+	}
+
+	const bool bHasPrevious = (previousDepth.Num() == (int32)numPixels);
+
+	FMemory::Memzero(histogram.GetData(), HistogramSize * sizeof(uint32));
+	runs.Reset();
+	parents.Reset();
+	areas.Reset();
+	touchesBorder.Reset();
+
+	uint64 invalidCount = 0;
+	uint64 noiseSum = 0;
+	uint64 noiseCount = 0;
+
+	int32 previousRowBegin = 0;
+	int32 previousRowEnd = 0;
+
+	for (uint32 y = 0; y < height; ++y) {
+		const uint16* row = depth.GetData() + y * width;
+		const uint16* previousRow = bHasPrevious ? previousDepth.GetData() + y * width : nullptr;
+
+		uint32 x = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+		// Invalid lanes compare to 0xFFFF, so subtracting the masks counts them.
+		// The 16-bit counters cannot overflow within a single row.
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i threshold = _mm_set1_epi16(MotionThreshold);
+		__m128i rowInvalid = zero;
+		__m128i rowNoiseCount = zero;
+		__m128i rowNoiseSum = zero;
+
+		for (; x + 8 <= width; x += 8) {
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+			const __m128i invalid = _mm_cmpeq_epi16(d, zero);
+			rowInvalid = _mm_sub_epi16(rowInvalid, invalid);
+
+			if (bHasPrevious) {
+				const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previousRow + x));
+				const __m128i eitherInvalid = _mm_or_si128(invalid, _mm_cmpeq_epi16(p, zero));
+				const __m128i diff = _mm_or_si128(_mm_subs_epu16(d, p), _mm_subs_epu16(p, d));
+				const __m128i isStatic = _mm_cmpeq_epi16(_mm_subs_epu16(diff, threshold), zero);
+				const __m128i mask = _mm_andnot_si128(eitherInvalid, isStatic);
+				rowNoiseCount = _mm_sub_epi16(rowNoiseCount, mask);
+				// diff is at most MotionThreshold in the selected lanes, so the 
+				// signed multiply-add is exact.
+				rowNoiseSum = _mm_add_epi32(rowNoiseSum, _mm_madd_epi16(_mm_and_si128(diff, mask), _mm_set1_epi16(1)));
+			}
+
+			for (uint32 i = 0; i < 8; ++i) {
+				histogram[row[x + i] >> HistogramShift]++;
+			}
+		}
+
+		invalidCount += HorizontalSum16(rowInvalid);
+		noiseCount += HorizontalSum16(rowNoiseCount);
+		noiseSum += HorizontalSum32(rowNoiseSum);
+#endif
+
+		for (; x < width; ++x) {
+			const uint16 d = row[x];
+			histogram[d >> HistogramShift]++;
+			if (d == 0) {
+				invalidCount++;
+			}
+			else if (bHasPrevious && (previousRow[x] != 0)) {
+				const uint16 diff = (d > previousRow[x]) ? (d - previousRow[x]) : (previousRow[x] - d);
+				if (diff <= MotionThreshold) {
+					noiseSum += diff;
+					noiseCount++;
+				}
+			}
+		}
+
+		// Label the runs of invalid pixels in this row and merge them with the
+		// overlapping runs of the previous row (4-connectivity).
+		const int32 rowBegin = runs.Num();
+		int32 overlap = previousRowBegin;
+		for (x = 0; x < width; ) {
+			if (row[x] != 0) {
+				++x;
+				continue;
+			}
+
+			InvalidRun run;
+			run.start = x;
+			while ((x < width) && (row[x] == 0)) {
+				++x;
+			}
+			run.end = x;
+			run.label = parents.Num();
+
+			parents.Add(run.label);
+			areas.Add(run.end - run.start);
+			touchesBorder.Add((y == 0) || (y == height - 1) || (run.start == 0) || (run.end == width));
+
+			while ((overlap < previousRowEnd) && (runs[overlap].end <= run.start)) {
+				++overlap;
+			}
+			for (int32 i = overlap; (i < previousRowEnd) && (runs[i].start < run.end); ++i) {
+				Union(runs[i].label, run.label);
+			}
+
+			runs.Add(run);
+		}
+		previousRowBegin = rowBegin;
+		previousRowEnd = runs.Num();
+	}
+
+	// Union() keeps the area and border flags up to date on the roots
+	for (int32 label = 0; label < parents.Num(); ++label) {
+		if ((parents[label] == label) && (touchesBorder[label] == false)) {
+			metrics.HoleCount++;
+			metrics.HoleArea += areas[label];
+		}
+	}
+
+	// Bin 0 also holds the invalid pixels, which are not part of the median
+	const uint64 validCount = numPixels - invalidCount;
+	histogram[0] -= static_cast<uint32>(invalidCount);
+	if (validCount > 0) {
+		uint64 cumulative = 0;
+		for (uint32 bin = 0; bin < HistogramSize; ++bin) {
+			cumulative += histogram[bin];
+			if (cumulative * 2 >= validCount) {
+				metrics.MedianDepth = (bin << HistogramShift) + (1 << (HistogramShift - 1));
+				break;
+			}
+		}
+	}
+
+	metrics.ValidRatio = static_cast<float>(validCount) / numPixels;
+	metrics.TemporalNoise = (noiseCount > 0) ? static_cast<float>(noiseSum) / noiseCount : 0.0f;
+
+	previousDepth.SetNumUninitialized(numPixels);
+	FMemory::Memcpy(previousDepth.GetData(), depth.GetData(), numPixels * sizeof(uint16));
+
+	return metrics;
+}
+
+int32 DepthQualityEstimator::FindRoot(int32 label)
+{
+	while (parents[label] != label) {
+		parents[label] = parents[parents[label]];
+		label = parents[label];
+	}
+	return label;
+}
+
+void DepthQualityEstimator::Union(int32 a, int32 b)
+{
+	a = FindRoot(a);
+	b = FindRoot(b);
+	if (a == b) {
+		return;
+	}
+	if (a > b) {
+		Swap(a, b);
+	}
+	parents[b] = a;
+	areas[a] += areas[b];
+	touchesBorder[a] = touchesBorder[a] || touchesBorder[b];
+}
@@ -0,0 +1,58 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+// Computes FDepthQualityMetrics for a stream of depth images.
+//
+// Valid pixels, temporal noise and the depth histogram are gathered in a single 
+// SSE2 pass over each row, and the runs of invalid pixels in that row are 
+// labeled with a union-find to count the holes. The estimator keeps a copy of 
+// the previous image for the temporal noise estimate, so one instance should be 
+// used per depth stream.
+class DepthQualityEstimator {
+public:
+	DepthQualityEstimator();
+
+	// Analyzes one depth image (in millimeters) of the given size. Temporal noise
+	// is reported as 0 for the first image and after a resolution change.
+	FDepthQualityMetrics Analyze(const TArray<uint16>& depth, const uint32 width, const uint32 height);
+
+	// Depth changes larger than this many millimeters are treated as motion
+	// rather than noise.
+	static const uint16 MotionThreshold = 50;
+
+private:
+	// A horizontal run of invalid pixels [start, end) in one row
+	struct InvalidRun {
+		uint32 start;
+		uint32 end;
+		int32 label;
+	};
+
+	TArray<uint16> previousDepth;
+	TArray<uint32> histogram;
+
+	TArray<InvalidRun> runs;
+	TArray<int32> parents;
+	TArray<uint32> areas;
+	TArray<bool> touchesBorder;
+
+	int32 FindRoot(int32 label);
+
+	void Union(int32 a, int32 b);
+};
@@ -0,0 +1,152 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "DepthUpsampler.h"
+#include "ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Depth Upsampling"), STAT_RealSenseDepthUpsampling, STATGROUP_RealSense);
+
+DepthUpsampler::DepthUpsampler()
+{
+	lastAverageMilliseconds = 0.0f;
+	SetColorSigma(12.0f);
+}
+
+void DepthUpsampler::SetColorSigma(float sigma)
+{
+	const float denominator = 2.0f * sigma * sigma;
+	for (int32 i = 0; i < 256; ++i) {
+		rangeWeights[i] = FMath::Exp(-(i * i) / denominator);
+	}
+}
+
+void DepthUpsampler::Upsample(const TArray<uint16>& depth, const TArray<PXCPointF32>& uvMap,
+							  const uint32 depthWidth, const uint32 depthHeight,
+							  const TArray<uint8>& color, const uint32 colorWidth, const uint32 colorHeight,
+							  TArray<uint16>& out, const uint32 outWidth, const uint32 outHeight)
+{
+	const uint32 numDepthPixels = depthWidth * depthHeight;
+	const uint32 numOutPixels = outWidth * outHeight;
+	if ((numDepthPixels == 0) || (numOutPixels == 0) ||
+		(depth.Num() < (int32)numDepthPixels) || (uvMap.Num() < (int32)numDepthPixels) ||
+		(color.Num() < (int32)(colorWidth * colorHeight * 4)) || (out.Num() < (int32)numOutPixels)) {
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseDepthUpsampling);
+	const double startTime = FPlatformTime::Seconds();
+
+	guide.SetNumUninitialized(numOutPixels);
+	sparseDepth.SetNumUninitialized(numOutPixels);
+	FMemory::Memzero(sparseDepth.GetData(), numOutPixels * sizeof(uint16));
+	weightedDepth.SetNumUninitialized(numOutPixels);
+	weights.SetNumUninitialized(numOutPixels);
+
+	// Luminance of the color image at the output resolution
+	ParallelFor(outHeight, [&](int32 y) {
+		const uint32 colorY = (y * colorHeight) / outHeight;
+		const uint8* colorRow = color.GetData() + colorY * colorWidth * 4;
+		uint8* guideRow = guide.GetData() + y * outWidth;
+		for (uint32 x = 0; x < outWidth; ++x) {
+			const uint8* bgra = colorRow + ((x * colorWidth) / outWidth) * 4;
+			guideRow[x] = static_cast<uint8>((bgra[0] * 29 + bgra[1] * 150 + bgra[2] * 77) >> 8);
+		}
+	});
+
+	// Splat the depth samples into the output image, keeping the nearest 
+	// sample where several land on the same pixel.
+	for (uint32 i = 0; i < numDepthPixels; ++i) {
+		const uint16 d = depth[i];
+		const PXCPointF32 uv = uvMap[i];
+		if ((d == 0) || (uv.x < 0.0f) || (uv.y < 0.0f) || (uv.x >= 1.0f) || (uv.y >= 1.0f)) {
+			continue;
+		}
+		uint16& target = sparseDepth[static_cast<uint32>(uv.y * outHeight) * outWidth + static_cast<uint32>(uv.x * outWidth)];
+		if ((target == 0) || (d < target)) {
+			target = d;
+		}
+	}
+
+	// The kernel has to bridge the gaps between splatted samples, which grow
+	// with the upsampling factor.
+	const float scale = FMath::Max(static_cast<float>(outWidth) / depthWidth, 1.0f);
+	const int32 radius = FMath::CeilToInt(2.0f * scale);
+	TArray<float> spatialWeights;
+	spatialWeights.SetNumUninitialized(2 * radius + 1);
+	for (int32 k = -radius; k <= radius; ++k) {
+		spatialWeights[k + radius] = FMath::Exp(-(k * k) / (2.0f * scale * scale));
+	}
+
+	// Horizontal pass: weighted sums of the valid samples along each row
+	ParallelFor(outHeight, [&](int32 y) {
+		const uint32 rowOffset = y * outWidth;
+		const uint16* depthRow = sparseDepth.GetData() + rowOffset;
+		const uint8* guideRow = guide.GetData() + rowOffset;
+		for (int32 x = 0; x < (int32)outWidth; ++x) {
+			const int32 begin = FMath::Max(x - radius, 0);
+			const int32 end = FMath::Min(x + radius, (int32)outWidth - 1);
+			float sum = 0.0f;
+			float weightSum = 0.0f;
+			for (int32 q = begin; q <= end; ++q) {
+				if (depthRow[q] == 0) {
+					continue;
+				}
+				const float w = spatialWeights[q - x + radius] * rangeWeights[FMath::Abs(guideRow[x] - guideRow[q])];
+				sum += w * depthRow[q];
+				weightSum += w;
+			}
+			weightedDepth[rowOffset + x] = sum;
+			weights[rowOffset + x] = weightSum;
+		}
+	});
+
+	// Vertical pass: combine the row sums and normalize
+	uint16* output = out.GetData();
+	ParallelFor(outHeight, [&](int32 y) {
+		const int32 begin = FMath::Max(y - radius, 0);
+		const int32 end = FMath::Min(y + radius, (int32)outHeight - 1);
+		for (uint32 x = 0; x < outWidth; ++x) {
+			const uint8 center = guide[y * outWidth + x];
+			float sum = 0.0f;
+			float weightSum = 0.0f;
+			for (int32 q = begin; q <= end; ++q) {
+				const uint32 index = q * outWidth + x;
+				if (weights[index] <= 0.0f) {
+					continue;
+				}
+				const float w = spatialWeights[q - y + radius] * rangeWeights[FMath::Abs(center - guide[index])];
+				sum += w * weightedDepth[index];
+				weightSum += w * weights[index];
+			}
+			output[y * outWidth + x] = (weightSum > KINDA_SMALL_NUMBER) ? static_cast<uint16>(sum / weightSum + 0.5f) : 0;
+		}
+	});
+
+	const double elapsed = FPlatformTime::Seconds() - startTime;
+	const FString pair = FString::Printf(TEXT("%dx%d -> %dx%d"), depthWidth, depthHeight, outWidth, outHeight);
+	Timing& timing = timings.FindOrAdd(pair);
+	timing.totalSeconds += elapsed;
+	timing.count++;
+	lastAverageMilliseconds = static_cast<float>(1000.0 * timing.totalSeconds / timing.count);
+}
+
+void DepthUpsampler::LogTimings() const
+{
+	for (const auto& entry : timings) {
+		RS_LOG(Log, "Depth upsampling %s : %.2f ms average over %u frames", *entry.Key,
+			   1000.0 * entry.Value.totalSeconds / entry.Value.count, entry.Value.count)
+	}
+}
@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+#include "pxcdefs.h"
+
+// Upsamples depth images to (a fraction of) the color image resolution using a
+// separable approximation of the joint bilateral filter.
+//
+// Depth samples are first splatted into the color image through the UV map
+// provided by PXCProjection, which also takes care of the alignment between 
+// the two cameras. The sparse depth image is then filled by a horizontal and a
+// vertical pass whose weights combine spatial distance with the difference in
+// luminance of the color image, so that depth edges snap to color edges. Both
+// passes are spread over rows with ParallelFor.
+//
+// Runtime is accumulated separately for every pair of depth and output 
+// resolutions used and can be written to the log with LogTimings().
+class DepthUpsampler {
+public:
+	DepthUpsampler();
+
+	// depth: depthWidth x depthHeight image in millimeters
+	// uvMap: normalized color coordinates of every depth pixel (negative if unmapped)
+	// color: colorWidth x colorHeight BGRA image used as the guide
+	// out: receives the outWidth x outHeight upsampled depth image
+	void Upsample(const TArray<uint16>& depth, const TArray<PXCPointF32>& uvMap, 
+				  const uint32 depthWidth, const uint32 depthHeight,
+				  const TArray<uint8>& color, const uint32 colorWidth, const uint32 colorHeight,
+				  TArray<uint16>& out, const uint32 outWidth, const uint32 outHeight);
+
+	// Sets the standard deviation of the range (luminance) weight.
+	void SetColorSigma(float sigma);
+
+	// Returns the average runtime (in milliseconds) of the most recently used
+	// resolution pair.
+	inline float GetAverageMilliseconds() const { return lastAverageMilliseconds; }
+
+	// Writes the average runtime of every resolution pair to the log.
+	void LogTimings() const;
+
+private:
+	struct Timing {
+		double totalSeconds = 0.0;
+		uint32 count = 0;
+	};
+
+	TMap<FString, Timing> timings;
+	float lastAverageMilliseconds;
+
+	float rangeWeights[256];
+
+	TArray<uint8> guide;
+	TArray<uint16> sparseDepth;
+	TArray<float> weightedDepth;
+	TArray<float> weights;
+};
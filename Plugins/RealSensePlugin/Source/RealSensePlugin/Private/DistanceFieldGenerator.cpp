@@ -0,0 +1,198 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "DistanceFieldGenerator.h"
+#include "ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Distance Field"), STAT_RealSenseDistanceField, STATGROUP_RealSense);
+
+// Stands in for the distance of lines without any feature pixel
+static const float Infinity = 1e20f;
+
+// 1D squared distance transform of a sampled function (Felzenszwalb and 
+// Huttenlocher, "Distance Transforms of Sampled Functions"). The input f and
+// output d are read and written with the given stride so that columns can be 
+// transformed in place. Sites with an infinite value are skipped, so the 
+// lower envelope only ever contains finite parabolas.
+static void DistanceTransform1D(const float* f, float* d, const int32 n, const int32 stride, 
+								float* values, int32* v, float* z)
+{
+	for (int32 q = 0; q < n; ++q) {
+		values[q] = f[q * stride];
+	}
+
+	int32 k = -1;
+	for (int32 q = 0; q < n; ++q) {
+		if (values[q] >= Infinity) {
+			continue;
+		}
+		if (k < 0) {
+			k = 0;
+			v[0] = q;
+			z[0] = -Infinity;
+			z[1] = Infinity;
+			continue;
+		}
+
+		float s = ((values[q] + q * q) - (values[v[k]] + v[k] * v[k])) / (2.0f * (q - v[k]));
+		while (s <= z[k]) {
+			--k;
+			s = ((values[q] + q * q) - (values[v[k]] + v[k] * v[k])) / (2.0f * (q - v[k]));
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = Infinity;
+	}
+
+	if (k < 0) {
+		for (int32 q = 0; q < n; ++q) {
+			d[q * stride] = Infinity;
+		}
+		return;
+	}
+
+	k = 0;
+	for (int32 q = 0; q < n; ++q) {
+		while (z[k + 1] < q) {
+			++k;
+		}
+		const float offset = static_cast<float>(q - v[k]);
+		d[q * stride] = offset * offset + values[v[k]];
+	}
+}
+
+DistanceFieldGenerator::DistanceFieldGenerator()
+{
+	width = 0;
+	height = 0;
+	format = EDistanceFieldFormat::G8;
+	maxDistance = 32.0f;
+	numLineChunks = 1;
+}
+
+void DistanceFieldGenerator::Configure(const uint32 w, const uint32 h, EDistanceFieldFormat f, float maxDist)
+{
+	width = w;
+	height = h;
+	format = f;
+	maxDistance = FMath::Max(maxDist, 1.0f);
+
+	const uint32 numPixels = width * height;
+	mask.SetNumZeroed(numPixels);
+	distanceToForeground.SetNumUninitialized(numPixels);
+	distanceToBackground.SetNumUninitialized(numPixels);
+
+	// The lines are transformed in parallel in one chunk of consecutive lines
+	// per core, and every chunk gets its own line of scratch space.
+	const uint32 longest = FMath::Max(width, height);
+	numLineChunks = FMath::Clamp<uint32>(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1, FMath::Max(longest, 1u));
+	values.SetNumUninitialized(numLineChunks * longest);
+	envelopeSites.SetNumUninitialized(numLineChunks * longest);
+	envelopeBounds.SetNumUninitialized(numLineChunks * (longest + 1));
+}
+
+void DistanceFieldGenerator::BuildMaskFromAlpha(const TArray<uint8>& image, const uint32 imageWidth, const uint32 imageHeight)
+{
+	if ((width == 0) || (image.Num() < (int32)(imageWidth * imageHeight * 4))) {
+		return;
+	}
+
+	ParallelFor(height, [&](int32 y) {
+		const uint8* imageRow = image.GetData() + ((y * imageHeight) / height) * imageWidth * 4;
+		uint8* maskRow = mask.GetData() + y * width;
+		for (uint32 x = 0; x < width; ++x) {
+			maskRow[x] = (imageRow[((x * imageWidth) / width) * 4 + 3] != 0) ? 1 : 0;
+		}
+	});
+}
+
+void DistanceFieldGenerator::BuildMaskFromDepth(const TArray<uint16>& depth, const uint32 depthWidth, const uint32 depthHeight,
+												uint16 nearDepth, uint16 farDepth)
+{
+	if ((width == 0) || (depth.Num() < (int32)(depthWidth * depthHeight))) {
+		return;
+	}
+
+	nearDepth = FMath::Max<uint16>(nearDepth, 1);
+
+	ParallelFor(height, [&](int32 y) {
+		const uint16* depthRow = depth.GetData() + ((y * depthHeight) / height) * depthWidth;
+		uint8* maskRow = mask.GetData() + y * width;
+		for (uint32 x = 0; x < width; ++x) {
+			const uint16 d = depthRow[(x * depthWidth) / width];
+			maskRow[x] = ((d >= nearDepth) && (d <= farDepth)) ? 1 : 0;
+		}
+	});
+}
+
+// Computes the squared distance of every pixel to the nearest pixel whose 
+// mask value equals featureValue.
+void DistanceFieldGenerator::ComputeSquaredDistances(uint8 featureValue, TArray<float>& distances)
+{
+	const uint32 longest = FMath::Max(width, height);
+
+	for (uint32 i = 0, n = width * height; i < n; ++i) {
+		distances[i] = (mask[i] == featureValue) ? 0.0f : Infinity;
+	}
+
+	ParallelFor(numLineChunks, [&](int32 c) {
+		for (uint32 x = (c * width) / numLineChunks, end = ((c + 1) * width) / numLineChunks; x < end; ++x) {
+			DistanceTransform1D(distances.GetData() + x, distances.GetData() + x, height, width,
+								values.GetData() + c * longest, envelopeSites.GetData() + c * longest, 
+								envelopeBounds.GetData() + c * (longest + 1));
+		}
+	});
+
+	ParallelFor(numLineChunks, [&](int32 c) {
+		for (uint32 y = (c * height) / numLineChunks, end = ((c + 1) * height) / numLineChunks; y < end; ++y) {
+			DistanceTransform1D(distances.GetData() + y * width, distances.GetData() + y * width, width, 1,
+								values.GetData() + c * longest, envelopeSites.GetData() + c * longest, 
+								envelopeBounds.GetData() + c * (longest + 1));
+		}
+	});
+}
+
+void DistanceFieldGenerator::Compute(TArray<uint8>& out)
+{
+	const uint32 numPixels = width * height;
+	if ((numPixels == 0) || (out.Num() < (int32)(numPixels * GetBytesPerPixel()))) {
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseDistanceField);
+
+	ComputeSquaredDistances(1, distanceToForeground);
+	ComputeSquaredDistances(0, distanceToBackground);
+
+	const float invMaxDistance = 1.0f / maxDistance;
+	const bool b16Bit = (format == EDistanceFieldFormat::G16);
+
+	ParallelFor(height, [&](int32 y) {
+		for (uint32 x = 0; x < width; ++x) {
+			const uint32 i = y * width + x;
+			const float distance = FMath::Sqrt(FMath::Min(distanceToForeground[i], maxDistance * maxDistance)) -
+								   FMath::Sqrt(FMath::Min(distanceToBackground[i], maxDistance * maxDistance));
+			const float normalized = FMath::Clamp(distance * invMaxDistance, -1.0f, 1.0f);
+			if (b16Bit) {
+				reinterpret_cast<uint16*>(out.GetData())[i] = static_cast<uint16>(32767.5f + 32767.5f * normalized);
+			}
+			else {
+				out[i] = static_cast<uint8>(127.5f + 127.5f * normalized);
+			}
+		}
+	});
+}
@@ -0,0 +1,71 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+// Computes a signed distance field of a binary foreground mask.
+//
+// The mask is sampled at the configured resolution either from the alpha 
+// channel of the 3D segmentation image or by thresholding a depth image. 
+// Squared Euclidean distances to the nearest foreground and background pixel
+// are then computed with the linear-time separable algorithm of Felzenszwalb 
+// and Huttenlocher: a 1D lower-envelope pass over every column followed by one
+// over every row, each spread over chunks of lines with ParallelFor.
+//
+// The signed distance (positive outside the silhouette, negative inside) is 
+// divided by the maximum distance and stored as an unsigned 8- or 16-bit 
+// value centered at half range.
+class DistanceFieldGenerator {
+public:
+	DistanceFieldGenerator();
+
+	// Sets the size and encoding of the output image. Distances beyond 
+	// maxDistance (in output pixels) saturate.
+	void Configure(const uint32 width, const uint32 height, EDistanceFieldFormat format, float maxDistance);
+
+	// Marks pixels with a non-zero alpha in the BGRA image as foreground.
+	void BuildMaskFromAlpha(const TArray<uint8>& image, const uint32 imageWidth, const uint32 imageHeight);
+
+	// Marks pixels with a depth within [nearDepth, farDepth] as foreground.
+	void BuildMaskFromDepth(const TArray<uint16>& depth, const uint32 depthWidth, const uint32 depthHeight,
+							uint16 nearDepth, uint16 farDepth);
+
+	// Computes the distance field of the current mask into out, which must
+	// hold width * height * GetBytesPerPixel() bytes.
+	void Compute(TArray<uint8>& out);
+
+	inline uint32 GetBytesPerPixel() const { return (format == EDistanceFieldFormat::G16) ? 2 : 1; }
+
+private:
+	uint32 width;
+	uint32 height;
+	EDistanceFieldFormat format;
+	float maxDistance;
+
+	TArray<uint8> mask;
+	TArray<float> distanceToForeground;
+	TArray<float> distanceToBackground;
+
+	// Scratch space of the 1D transforms, one line for each of the 
+	// numLineChunks chunks of lines transformed in parallel
+	uint32 numLineChunks;
+	TArray<float> values;
+	TArray<int32> envelopeSites;
+	TArray<float> envelopeBounds;
+
+	void ComputeSquaredDistances(uint8 featureValue, TArray<float>& distances);
+};
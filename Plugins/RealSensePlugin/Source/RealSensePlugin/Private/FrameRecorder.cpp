@@ -0,0 +1,363 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "FrameRecorder.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+
+DECLARE_CYCLE_STAT(TEXT("Frame Recording Encode"), STAT_RealSenseFrameEncode, STATGROUP_RealSense);
+DECLARE_CYCLE_STAT(TEXT("Frame Recording Decode"), STAT_RealSenseFrameDecode, STATGROUP_RealSense);
+
+static const ECompressionFlags RecordingCompression = static_cast<ECompressionFlags>(COMPRESS_ZLIB | COMPRESS_BiasSpeed);
+
+// Returns the first row of a band
+static inline int32 BandStart(int32 band, int32 height)
+{
+	return band * height / FrameRecorder::NumBands;
+}
+
+// Compresses data into out. Data that does not compress is stored as is, 
+// which Uncompress() recognizes by its size.
+static void Compress(const TArray<uint8>& data, TArray<uint8>& out)
+{
+	int32 size = FCompression::CompressMemoryBound(RecordingCompression, data.Num());
+	out.SetNumUninitialized(size);
+	if ((data.Num() == 0) ||
+		(FCompression::CompressMemory(RecordingCompression, out.GetData(), size, data.GetData(), data.Num()) == false) || 
+		(size >= data.Num())) {
+		out = data;
+		return;
+	}
+	out.SetNum(size, false);
+}
+
+static bool Uncompress(const TArray<uint8>& data, TArray<uint8>& out, int32 size)
+{
+	out.SetNumUninitialized(size);
+	if (data.Num() == size) {
+		FMemory::Memcpy(out.GetData(), data.GetData(), size);
+		return true;
+	}
+	return FCompression::UncompressMemory(RecordingCompression, out.GetData(), size, data.GetData(), data.Num());
+}
+
+FrameRecorder::FrameRecorder()
+{
+	bRunning = false;
+	bFramePending = false;
+	requestedTimestamp = 0.0;
+	bFrameRequested = false;
+	bFrameDecoded = false;
+	duration = 0.0f;
+	memoryLimit = 0;
+	memoryUsage = 0;
+	droppedFrames = 0;
+	oldestTimestamp = 0.0;
+	newestTimestamp = 0.0;
+	numEntries = 0;
+	lastDecodedNumber = 0;
+}
+
+FrameRecorder::~FrameRecorder()
+{
+	Stop();
+}
+
+void FrameRecorder::Start(float durationSeconds, uint64 memoryLimitBytes)
+{
+	duration = durationSeconds;
+	memoryLimit = memoryLimitBytes;
+	if (bRunning == false) {
+		droppedFrames = 0;
+		bRunning = true;
+		worker = std::thread([this]() { WorkerThread(); });
+	}
+}
+
+void FrameRecorder::Stop()
+{
+	if (bRunning) {
+		{
+			std::unique_lock<std::mutex> lock(workerMutex);
+			bRunning = false;
+		}
+		workerCondition.notify_all();
+		worker.join();
+	}
+
+	std::unique_lock<std::mutex> lock(workerMutex);
+	bFramePending = false;
+	bFrameRequested = false;
+	bFrameDecoded = false;
+	entries.clear();
+	numEntries = 0;
+	memoryUsage = 0;
+	lastDecodedNumber = 0;
+}
+
+bool FrameRecorder::Record(uint64 number, double timestamp, 
+						   const TArray<uint8>& colorImage, int32 colorWidth, int32 colorHeight,
+						   const TArray<uint16>& depthImage, int32 depthWidth, int32 depthHeight)
+{
+	std::unique_lock<std::mutex> lock(workerMutex);
+	if (bRunning == false) {
+		return false;
+	}
+	if (bFramePending) {
+		droppedFrames++;
+		return false;
+	}
+
+	pendingFrame.number = number;
+	pendingFrame.timestamp = timestamp;
+	pendingFrame.colorWidth = colorWidth;
+	pendingFrame.colorHeight = colorHeight;
+	pendingFrame.depthWidth = depthWidth;
+	pendingFrame.depthHeight = depthHeight;
+	pendingFrame.colorImage = colorImage;
+	pendingFrame.depthImage = depthImage;
+	bFramePending = true;
+
+	lock.unlock();
+	workerCondition.notify_one();
+	return true;
+}
+
+void FrameRecorder::RequestFrame(double timestamp)
+{
+	{
+		std::unique_lock<std::mutex> lock(workerMutex);
+		requestedTimestamp = timestamp;
+		bFrameRequested = true;
+	}
+	workerCondition.notify_one();
+}
+
+bool FrameRecorder::FetchFrame(RecordedFrame& frame)
+{
+	std::unique_lock<std::mutex> lock(workerMutex);
+	if (bFrameDecoded == false) {
+		return false;
+	}
+	Swap(frame, decodedFrame);
+	bFrameDecoded = false;
+	return true;
+}
+
+bool FrameRecorder::GetRecordedRange(double& oldest, double& newest) const
+{
+	if (numEntries == 0) {
+		return false;
+	}
+	oldest = oldestTimestamp;
+	newest = newestTimestamp;
+	return true;
+}
+
+// Requests are served before new frames are encoded, so that scrubbing stays
+// responsive while recording continues. Buffers are swapped rather than 
+// copied between the worker and the other threads.
+void FrameRecorder::WorkerThread()
+{
+	std::unique_lock<std::mutex> lock(workerMutex);
+	while (bRunning) {
+		workerCondition.wait(lock, [this]() { return bFramePending || bFrameRequested || (bRunning == false); });
+		if (bRunning == false) {
+			break;
+		}
+
+		if (bFrameRequested) {
+			const double timestamp = requestedTimestamp;
+			bFrameRequested = false;
+			lock.unlock();
+
+			const Entry* entry = FindEntry(timestamp);
+			const bool bDecode = (entry != nullptr) && (entry->number != lastDecodedNumber);
+			if (bDecode) {
+				Decode(*entry, decodeFrame);
+				lastDecodedNumber = entry->number;
+			}
+
+			lock.lock();
+			if (bDecode) {
+				Swap(decodeFrame, decodedFrame);
+				bFrameDecoded = true;
+			}
+		}
+
+		if (bFramePending) {
+			Swap(pendingFrame, encodeFrame);
+			bFramePending = false;
+			lock.unlock();
+
+			Encode(encodeFrame);
+
+			lock.lock();
+		}
+	}
+}
+
+// Color rows are coded as differences to the previous pixel of the same 
+// channel. Depth rows are coded as differences to the previous pixel and 
+// split into a plane of low bytes and a plane of high bytes, because the 
+// high bytes of small differences are all 0 or 255.
+void FrameRecorder::Encode(const RecordedFrame& frame)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseFrameEncode);
+
+	entries.emplace_back();
+	Entry& entry = entries.back();
+	entry.number = frame.number;
+	entry.timestamp = frame.timestamp;
+	entry.colorWidth = (frame.colorImage.Num() == frame.colorWidth * frame.colorHeight * 4) ? frame.colorWidth : 0;
+	entry.colorHeight = (entry.colorWidth > 0) ? frame.colorHeight : 0;
+	entry.depthWidth = (frame.depthImage.Num() == frame.depthWidth * frame.depthHeight) ? frame.depthWidth : 0;
+	entry.depthHeight = (entry.depthWidth > 0) ? frame.depthHeight : 0;
+
+	ParallelFor(2 * NumBands, [&](int32 task) {
+		TArray<uint8>& data = filtered[task];
+		if (task < NumBands) {
+			const int32 width = entry.colorWidth * 4;
+			const int32 y0 = BandStart(task, entry.colorHeight);
+			const int32 y1 = BandStart(task + 1, entry.colorHeight);
+			data.SetNumUninitialized((y1 - y0) * width);
+			for (int32 y = y0; y < y1; y++) {
+				const uint8* in = frame.colorImage.GetData() + y * width;
+				uint8* out = data.GetData() + (y - y0) * width;
+				for (int32 x = 0; x < FMath::Min(width, 4); x++) {
+					out[x] = in[x];
+				}
+				for (int32 x = 4; x < width; x++) {
+					out[x] = in[x] - in[x - 4];
+				}
+			}
+		}
+		else {
+			const int32 width = entry.depthWidth;
+			const int32 y0 = BandStart(task - NumBands, entry.depthHeight);
+			const int32 y1 = BandStart(task - NumBands + 1, entry.depthHeight);
+			const int32 count = (y1 - y0) * width;
+			data.SetNumUninitialized(2 * count);
+			uint8* low = data.GetData();
+			uint8* high = low + count;
+			for (int32 y = y0; y < y1; y++) {
+				const uint16* in = frame.depthImage.GetData() + y * width;
+				uint16 previous = 0;
+				for (int32 x = 0; x < width; x++) {
+					const uint16 delta = in[x] - previous;
+					previous = in[x];
+					*low++ = delta & 0xFF;
+					*high++ = delta >> 8;
+				}
+			}
+		}
+		Compress(data, entry.bands[task]);
+	});
+
+	entry.size = sizeof(Entry);
+	for (const TArray<uint8>& band : entry.bands) {
+		entry.size += band.Num();
+	}
+	memoryUsage += entry.size;
+
+	while ((entries.empty() == false) && 
+		   ((entry.timestamp - entries.front().timestamp > duration) || (memoryUsage > memoryLimit))) {
+		memoryUsage -= entries.front().size;
+		entries.pop_front();
+	}
+
+	numEntries = static_cast<int32>(entries.size());
+	if (entries.empty() == false) {
+		oldestTimestamp = entries.front().timestamp;
+		newestTimestamp = entries.back().timestamp;
+	}
+}
+
+void FrameRecorder::Decode(const Entry& entry, RecordedFrame& frame)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseFrameDecode);
+
+	frame.number = entry.number;
+	frame.timestamp = entry.timestamp;
+	frame.colorWidth = entry.colorWidth;
+	frame.colorHeight = entry.colorHeight;
+	frame.depthWidth = entry.depthWidth;
+	frame.depthHeight = entry.depthHeight;
+	frame.colorImage.SetNumUninitialized(entry.colorWidth * entry.colorHeight * 4);
+	frame.depthImage.SetNumUninitialized(entry.depthWidth * entry.depthHeight);
+
+	ParallelFor(2 * NumBands, [&](int32 task) {
+		TArray<uint8>& data = filtered[task];
+		if (task < NumBands) {
+			const int32 width = entry.colorWidth * 4;
+			const int32 y0 = BandStart(task, entry.colorHeight);
+			const int32 y1 = BandStart(task + 1, entry.colorHeight);
+			if (Uncompress(entry.bands[task], data, (y1 - y0) * width) == false) {
+				FMemory::Memzero(frame.colorImage.GetData() + y0 * width, (y1 - y0) * width);
+				return;
+			}
+			for (int32 y = y0; y < y1; y++) {
+				const uint8* in = data.GetData() + (y - y0) * width;
+				uint8* out = frame.colorImage.GetData() + y * width;
+				for (int32 x = 0; x < FMath::Min(width, 4); x++) {
+					out[x] = in[x];
+				}
+				for (int32 x = 4; x < width; x++) {
+					out[x] = in[x] + out[x - 4];
+				}
+			}
+		}
+		else {
+			const int32 width = entry.depthWidth;
+			const int32 y0 = BandStart(task - NumBands, entry.depthHeight);
+			const int32 y1 = BandStart(task - NumBands + 1, entry.depthHeight);
+			const int32 count = (y1 - y0) * width;
+			if (Uncompress(entry.bands[task], data, 2 * count) == false) {
+				FMemory::Memzero(frame.depthImage.GetData() + y0 * width, count * sizeof(uint16));
+				return;
+			}
+			const uint8* low = data.GetData();
+			const uint8* high = low + count;
+			for (int32 y = y0; y < y1; y++) {
+				uint16* out = frame.depthImage.GetData() + y * width;
+				uint16 previous = 0;
+				for (int32 x = 0; x < width; x++) {
+					previous += *low++ | (*high++ << 8);
+					out[x] = previous;
+				}
+			}
+		}
+	});
+}
+
+// Returns the entry with the timestamp closest to the given one
+const FrameRecorder::Entry* FrameRecorder::FindEntry(double timestamp) const
+{
+	if (entries.empty()) {
+		return nullptr;
+	}
+
+	auto next = std::lower_bound(entries.begin(), entries.end(), timestamp, 
+								 [](const Entry& entry, double t) { return entry.timestamp < t; });
+	if (next == entries.end()) {
+		return &entries.back();
+	}
+	if ((next != entries.begin()) && (timestamp - (next - 1)->timestamp < next->timestamp - timestamp)) {
+		return &*(next - 1);
+	}
+	return &*next;
+}
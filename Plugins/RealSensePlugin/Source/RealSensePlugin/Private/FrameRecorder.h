@@ -0,0 +1,141 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+
+#include "RealSenseTypes.h"
+
+// Color and depth images of one camera frame
+struct RecordedFrame {
+	uint64 number;
+	double timestamp;  // Host time (FPlatformTime::Seconds()) of the frame
+	int32 colorWidth;
+	int32 colorHeight;
+	int32 depthWidth;
+	int32 depthHeight;
+	TArray<uint8> colorImage;  // BGRA
+	TArray<uint16> depthImage;
+
+	RecordedFrame() : number(0), timestamp(0.0), colorWidth(0), colorHeight(0), depthWidth(0), depthHeight(0) {}
+};
+
+// Keeps the camera frames of the last few seconds in memory and decodes 
+// them again for replays.
+//
+// Frames are handed over by the camera thread and compressed on a worker 
+// thread, so recording costs the camera thread a single copy. Each image is 
+// delta coded along its rows, which turns smooth regions into runs of small 
+// values, and then compressed with zlib in horizontal bands spread over 
+// ParallelFor. Frames that arrive while the worker is still busy are 
+// dropped. The oldest frames are discarded when the recording exceeds the 
+// duration or the memory limit.
+//
+// Replayed frames are decoded by the same worker. The game thread requests
+// a time with RequestFrame() and later collects the decoded frame with 
+// FetchFrame().
+class FrameRecorder {
+public:
+	FrameRecorder();
+
+	// Stops the worker thread.
+	~FrameRecorder();
+
+	// Starts recording, or changes the limits of a running recording.
+	void Start(float durationSeconds, uint64 memoryLimitBytes);
+
+	// Stops recording and discards all recorded frames.
+	void Stop();
+
+	inline bool IsRecording() const { return bRunning; }
+
+	// Called by the camera thread to record a frame. Returns false if the 
+	// frame was dropped because the worker is still busy.
+	bool Record(uint64 number, double timestamp, 
+				const TArray<uint8>& colorImage, int32 colorWidth, int32 colorHeight,
+				const TArray<uint16>& depthImage, int32 depthWidth, int32 depthHeight);
+
+	// Requests the decoding of the recorded frame closest to the given time.
+	void RequestFrame(double timestamp);
+
+	// Moves the latest decoded frame into frame and returns true, or returns
+	// false if no frame has been decoded since the last call.
+	bool FetchFrame(RecordedFrame& frame);
+
+	// Returns the timestamps of the oldest and the newest recorded frame, or 
+	// false if nothing has been recorded yet.
+	bool GetRecordedRange(double& oldest, double& newest) const;
+
+	inline uint64 GetMemoryUsage() const { return memoryUsage; }
+
+	inline uint32 GetDroppedFrames() const { return droppedFrames; }
+
+	// Number of horizontal bands that are compressed independently
+	static const int32 NumBands = 8;
+
+private:
+	struct Entry {
+		uint64 number;
+		double timestamp;
+		int32 colorWidth;
+		int32 colorHeight;
+		int32 depthWidth;
+		int32 depthHeight;
+		TArray<uint8> bands[2 * NumBands];  // Color bands followed by depth bands
+		uint64 size;
+	};
+
+	std::thread worker;
+	std::atomic_bool bRunning;
+
+	// Mutex and condition variable for handing frames and requests to the worker
+	std::mutex workerMutex;
+	std::condition_variable workerCondition;
+	RecordedFrame pendingFrame;
+	bool bFramePending;
+	double requestedTimestamp;
+	bool bFrameRequested;
+	RecordedFrame decodedFrame;
+	bool bFrameDecoded;
+
+	std::atomic<float> duration;
+	std::atomic<uint64> memoryLimit;
+
+	// Only accessed by the worker thread
+	std::deque<Entry> entries;
+	RecordedFrame encodeFrame;
+	RecordedFrame decodeFrame;
+	TArray<uint8> filtered[2 * NumBands];
+
+	std::atomic<uint64> memoryUsage;
+	std::atomic<uint32> droppedFrames;
+	std::atomic<double> oldestTimestamp;
+	std::atomic<double> newestTimestamp;
+	std::atomic<int32> numEntries;
+	uint64 lastDecodedNumber;
+
+	void WorkerThread();
+
+	void Encode(const RecordedFrame& frame);
+
+	void Decode(const Entry& entry, RecordedFrame& frame);
+
+	const Entry* FindEntry(double timestamp) const;
+};
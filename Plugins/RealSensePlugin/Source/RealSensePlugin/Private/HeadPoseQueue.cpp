@@ -0,0 +1,56 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "HeadPoseQueue.h"
+
+HeadPoseQueue::HeadPoseQueue(uint32 capacity) 
+	: writeIndex(0), pushedCount(0), droppedCount(0), readIndex(0)
+{
+	const uint32 size = FMath::RoundUpToPowerOfTwo(FMath::Max(capacity, 2u));
+	buffer.SetNum(size);
+	mask = size - 1;
+}
+
+bool HeadPoseQueue::Push(const FHeadPoseSample& sample)
+{
+	const uint32 write = writeIndex.load(std::memory_order_relaxed);
+	const uint32 read = readIndex.load(std::memory_order_acquire);
+
+	pushedCount.fetch_add(1, std::memory_order_relaxed);
+	if (write - read > mask) {
+		droppedCount.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	buffer[write & mask] = sample;
+	writeIndex.store(write + 1, std::memory_order_release);
+	return true;
+}
+
+uint32 HeadPoseQueue::Drain(TArray<FHeadPoseSample>& samples)
+{
+	const uint32 read = readIndex.load(std::memory_order_relaxed);
+	const uint32 write = writeIndex.load(std::memory_order_acquire);
+	const uint32 count = write - read;
+
+	samples.Reserve(samples.Num() + count);
+	for (uint32 i = read; i != write; i++) {
+		samples.Add(buffer[i & mask]);
+	}
+
+	readIndex.store(write, std::memory_order_release);
+	return count;
+}
@@ -0,0 +1,66 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+#include <atomic>
+
+// Bounded ring of head pose samples passed from the camera processing thread
+// to the game thread without locking.
+//
+// Exactly one thread may call Push() and one thread may call Drain(). Both 
+// threads only ever advance their own index: the producer publishes a sample
+// by releasing writeIndex after storing it, and the consumer frees slots by 
+// releasing readIndex after copying them out. The indices run freely and are 
+// masked into the buffer, whose capacity is a power of two. A sample pushed 
+// into a full ring is dropped and counted, so the consumer can tell how many
+// samples it missed.
+class HeadPoseQueue {
+public:
+	// Creates a ring holding at least the given number of samples.
+	explicit HeadPoseQueue(uint32 capacity);
+
+	// Appends a sample, or drops it if the ring is full. Returns whether the
+	// sample was queued. Called by the producer thread only.
+	bool Push(const FHeadPoseSample& sample);
+
+	// Moves all queued samples, oldest first, to the end of the given array. 
+	// Returns the number of samples moved. Called by the consumer thread only.
+	uint32 Drain(TArray<FHeadPoseSample>& samples);
+
+	inline uint32 GetCapacity() const { return mask + 1; }
+
+	// Returns the number of samples pushed since the ring was created
+	inline uint32 GetPushedCount() const { return pushedCount.load(std::memory_order_relaxed); }
+
+	// Returns the number of samples dropped because the ring was full
+	inline uint32 GetDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+	// Keeps the indices of the two threads on separate cache lines
+	static const uint32 CacheLineSize = 64;
+
+	TArray<FHeadPoseSample> buffer;
+	uint32 mask;
+
+	std::atomic<uint32> writeIndex;
+	std::atomic<uint32> pushedCount;
+	std::atomic<uint32> droppedCount;
+	uint8 producerPadding[CacheLineSize];
+
+	std::atomic<uint32> readIndex;
+	uint8 consumerPadding[CacheLineSize];
+};
@@ -29,6 +29,10 @@ void UHeadTrackingComponent::InitializeComponent()
 	HeadCount = 0;
 	HeadPosition = FVector(0.0f, 0.0f, 0.0f);
 	HeadRotation = FRotator(0.0f, 0.0f, 0.0f);
+	DroppedHeadPoseSamples = 0;
+	TotalDroppedHeadPoseSamples = 0;
+
+	HeadCropTexture = UTexture2D::CreateTransient(1, 1, EPixelFormat::PF_B8G8R8A8);
 }
 
 void UHeadTrackingComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, 
@@ -38,7 +42,68 @@ void UHeadTrackingComponent::TickComponent(float DeltaTime, enum ELevelTick Tick
 		return;
 	}
 
+	// Head tracking drives gameplay, so it reads the data on every tick
+	globalRealSenseSession->NotifyDataAccess();
+
 	HeadCount = globalRealSenseSession->GetHeadCount();
 	HeadPosition = globalRealSenseSession->GetHeadPosition();
 	HeadRotation = globalRealSenseSession->GetHeadRotation();
+
+	if (bHeadCropEnabled) {
+		HeadCropBuffer = globalRealSenseSession->GetHeadCropBuffer();
+	}
+
+	// The array keeps its allocation, so draining does not allocate once it 
+	// has grown to the number of frames per tick.
+	if (bHeadPoseQueueEnabled) {
+		HeadPoseSamples.Reset();
+		globalRealSenseSession->DrainHeadPoseSamples(HeadPoseSamples);
+
+		const int32 Dropped = globalRealSenseSession->GetDroppedHeadPoseSamples();
+		DroppedHeadPoseSamples = Dropped - TotalDroppedHeadPoseSamples;
+		TotalDroppedHeadPoseSamples = Dropped;
+	}
+}
+
+// If the supplied size is valid, this function passes it along to the 
+// RealSenseSessionManager and recreates the HeadCropTexture to match.
+void UHeadTrackingComponent::EnableHeadCrop(int32 Width, int32 Height, float Smoothing)
+{
+	if ((Width <= 0) || (Height <= 0)) {
+		return;
+	}
+
+	globalRealSenseSession->EnableHeadCrop(Width, Height, Smoothing);
+	bHeadCropEnabled = true;
+
+	HeadCropTexture = UTexture2D::CreateTransient(Width, Height, PF_B8G8R8A8);
+	HeadCropTexture->UpdateResource();
+}
+
+void UHeadTrackingComponent::DisableHeadCrop()
+{
+	globalRealSenseSession->DisableHeadCrop();
+	bHeadCropEnabled = false;
+}
+
+void UHeadTrackingComponent::EnableHeadPoseQueue(int32 Capacity)
+{
+	if (Capacity <= 0) {
+		return;
+	}
+
+	globalRealSenseSession->EnableHeadPoseQueue(Capacity);
+	bHeadPoseQueueEnabled = true;
+
+	HeadPoseSamples.Empty(Capacity);
+	DroppedHeadPoseSamples = 0;
+	TotalDroppedHeadPoseSamples = 0;
+}
+
+void UHeadTrackingComponent::DisableHeadPoseQueue()
+{
+	globalRealSenseSession->DisableHeadPoseQueue();
+	bHeadPoseQueueEnabled = false;
+
+	HeadPoseSamples.Reset();
 }
@@ -0,0 +1,306 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "LatencyProbe.h"
+#include "BlockCompression.h"
+
+// The stamp holds a magic number, the frame number, the timestamp in 
+// microseconds and a checksum, in this order
+static const uint16 StampMagic = 0x5253;
+static const int32 StampBits = 16 + 64 + 64 + 16;
+
+static uint16 GetStampChecksum(uint64 frameNumber, uint64 microseconds)
+{
+	uint16 checksum = StampMagic;
+	for (int32 shift = 0; shift < 64; shift += 16) {
+		checksum ^= static_cast<uint16>(frameNumber >> shift);
+		checksum = (checksum << 5) | (checksum >> 11);
+		checksum ^= static_cast<uint16>(microseconds >> shift);
+	}
+	return ~checksum;
+}
+
+int32 GetLatencyStampHeight(int32 width, int32 height)
+{
+	const int32 cellsPerRow = width / LatencyStampCellSize;
+	if (cellsPerRow < 16) {
+		return 0;
+	}
+	const int32 stampHeight = ((StampBits + cellsPerRow - 1) / cellsPerRow) * LatencyStampCellSize;
+	return (stampHeight <= height) ? stampHeight : 0;
+}
+
+void FillLatencyTestImage(uint8* bgra, int32 width, int32 height, uint64 frameNumber, double timestamp)
+{
+	const int32 stampHeight = GetLatencyStampHeight(width, height);
+	if (stampHeight == 0) {
+		return;
+	}
+
+	const uint32 offset = static_cast<uint32>(frameNumber);
+	for (int32 y = stampHeight; y < height; ++y) {
+		uint8* pixel = bgra + y * width * 4;
+		for (int32 x = 0; x < width; ++x) {
+			*pixel++ = static_cast<uint8>(x + offset * 4);
+			*pixel++ = static_cast<uint8>(y + offset * 2);
+			*pixel++ = static_cast<uint8>((x ^ y) + offset);
+			*pixel++ = 255;
+		}
+	}
+
+	const uint64 microseconds = static_cast<uint64>(FMath::Max(timestamp, 0.0) * 1e6 + 0.5);
+	const uint16 checksum = GetStampChecksum(frameNumber, microseconds);
+	auto GetBit = [&](int32 bit) -> bool {
+		if (bit < 16) {
+			return ((StampMagic >> bit) & 1) != 0;
+		}
+		if (bit < 80) {
+			return ((frameNumber >> (bit - 16)) & 1) != 0;
+		}
+		if (bit < 144) {
+			return ((microseconds >> (bit - 80)) & 1) != 0;
+		}
+		if (bit < StampBits) {
+			return ((checksum >> (bit - 144)) & 1) != 0;
+		}
+		return false;
+	};
+
+	const int32 cellsPerRow = width / LatencyStampCellSize;
+	for (int32 y = 0; y < stampHeight; ++y) {
+		uint8* pixel = bgra + y * width * 4;
+		const int32 firstBit = (y / LatencyStampCellSize) * cellsPerRow;
+		for (int32 x = 0; x < width; ++x) {
+			const int32 cell = x / LatencyStampCellSize;
+			const uint8 value = ((cell < cellsPerRow) && GetBit(firstBit + cell)) ? 255 : 0;
+			*pixel++ = value;
+			*pixel++ = value;
+			*pixel++ = value;
+			*pixel++ = 255;
+		}
+	}
+}
+
+// Every bit is read from the center pixel of its cell.
+bool DecodeLatencyStamp(const uint8* bgra, int32 width, int32 height, uint64& frameNumber, double& timestamp)
+{
+	const int32 stampHeight = GetLatencyStampHeight(width, height);
+	if (stampHeight == 0) {
+		return false;
+	}
+
+	const int32 cellsPerRow = width / LatencyStampCellSize;
+	const int32 center = LatencyStampCellSize / 2;
+	auto GetBit = [&](int32 bit) -> uint64 {
+		const int32 x = (bit % cellsPerRow) * LatencyStampCellSize + center;
+		const int32 y = (bit / cellsPerRow) * LatencyStampCellSize + center;
+		const uint8* pixel = bgra + (y * width + x) * 4;
+		return (pixel[0] + pixel[1] + pixel[2] > 3 * 127) ? 1 : 0;
+	};
+
+	uint16 magic = 0;
+	uint64 number = 0;
+	uint64 microseconds = 0;
+	uint16 checksum = 0;
+	for (int32 bit = 0; bit < StampBits; ++bit) {
+		if (bit < 16) {
+			magic |= static_cast<uint16>(GetBit(bit) << bit);
+		}
+		else if (bit < 80) {
+			number |= GetBit(bit) << (bit - 16);
+		}
+		else if (bit < 144) {
+			microseconds |= GetBit(bit) << (bit - 80);
+		}
+		else {
+			checksum |= static_cast<uint16>(GetBit(bit) << (bit - 144));
+		}
+	}
+
+	if ((magic != StampMagic) || (checksum != GetStampChecksum(number, microseconds))) {
+		return false;
+	}
+	frameNumber = number;
+	timestamp = microseconds * 1e-6;
+	return true;
+}
+
+FString LatencyDistribution::ToString() const
+{
+	return FString::Printf(TEXT("%5d frames  min %6.1f  mean %6.1f  p50 %6.1f  p90 %6.1f  p99 %6.1f  max %6.1f ms"), 
+						   count, min, mean, p50, p90, p99, max);
+}
+
+LatencyProbe::LatencyProbe()
+{
+	verifiedUploads = 0;
+	lastPickupFrame = 0;
+	lastUploadFrame = 0;
+}
+
+void LatencyProbe::Reset()
+{
+	std::unique_lock<std::mutex> lockSamples(sampleMutex);
+	pickupSamples.Reset();
+	uploadSamples.Reset();
+	verifiedUploads = 0;
+	lastPickupFrame = 0;
+	lastUploadFrame = 0;
+}
+
+bool LatencyProbe::RecordPickup(const uint8* bgra, int32 width, int32 height)
+{
+	const double now = FPlatformTime::Seconds();
+	uint64 frameNumber;
+	double timestamp;
+	if ((DecodeLatencyStamp(bgra, width, height, frameNumber, timestamp) == false) || (frameNumber == lastPickupFrame)) {
+		return false;
+	}
+	lastPickupFrame = frameNumber;
+
+	std::unique_lock<std::mutex> lockSamples(sampleMutex);
+	pickupSamples.Add(static_cast<float>(1000.0 * (now - timestamp)));
+	return true;
+}
+
+// The probe is kept alive by the render command until it has run.
+bool LatencyProbe::RecordUpload(UTexture2D* texture, const uint8* bgra, int32 width, int32 height)
+{
+	Upload upload;
+	if ((texture == nullptr) || (texture->Resource == nullptr) || 
+		(DecodeLatencyStamp(bgra, width, height, upload.frameNumber, upload.timestamp) == false) ||
+		(upload.frameNumber == lastUploadFrame)) {
+		return false;
+	}
+	lastUploadFrame = upload.frameNumber;
+	upload.resource = static_cast<FTexture2DResource*>(texture->Resource);
+	upload.format = texture->GetPixelFormat();
+	upload.width = texture->GetSizeX();
+	upload.height = texture->GetSizeY();
+
+	std::shared_ptr<LatencyProbe> probe = shared_from_this();
+	ENQUEUE_UNIQUE_RENDER_COMMAND_TWOPARAMETER(
+		MeasureLatencyStamp,
+		std::shared_ptr<LatencyProbe>, Probe, probe,
+		Upload, Stamp, upload,
+		{
+			Probe->MeasureUpload(Stamp);
+		});
+	return true;
+}
+
+void LatencyProbe::MeasureUpload(const Upload& upload)
+{
+	const double now = FPlatformTime::Seconds();
+	uint64 frameNumber;
+	double timestamp;
+	const bool bVerified = ReadBack(upload, frameNumber, timestamp) && (frameNumber == upload.frameNumber);
+
+	std::unique_lock<std::mutex> lockSamples(sampleMutex);
+	uploadSamples.Add(static_cast<float>(1000.0 * (now - upload.timestamp)));
+	if (bVerified) {
+		verifiedUploads++;
+	}
+}
+
+// Locking the texture for reading copies it back from the GPU. Only the rows
+// of the stamp are decoded.
+bool LatencyProbe::ReadBack(const Upload& upload, uint64& frameNumber, double& timestamp)
+{
+	FTexture2DRHIRef texture = upload.resource->GetTexture2DRHI();
+	const int32 stampHeight = GetLatencyStampHeight(upload.width, upload.height);
+	if ((texture.IsValid() == false) || (stampHeight == 0) || 
+		((upload.format != PF_B8G8R8A8) && (upload.format != PF_DXT1))) {
+		return false;
+	}
+
+	uint32 stride = 0;
+	const uint8* data = static_cast<const uint8*>(RHILockTexture2D(texture, 0, RLM_ReadOnly, stride, false));
+	if (data == nullptr) {
+		return false;
+	}
+
+	readbackPixels.SetNumUninitialized(upload.width * stampHeight * 4);
+	if (upload.format == PF_DXT1) {
+		const uint32 blockRowSize = GetBlockCompressedSize(upload.width, 4);
+		const int32 blockRows = stampHeight / 4;
+		readbackBlocks.SetNumUninitialized(blockRowSize * blockRows);
+		for (int32 row = 0; row < blockRows; ++row) {
+			FMemory::Memcpy(readbackBlocks.GetData() + row * blockRowSize, data + row * stride, blockRowSize);
+		}
+		DecodeBC1(readbackBlocks.GetData(), upload.width, stampHeight, readbackPixels.GetData());
+	}
+	else {
+		const uint32 rowSize = upload.width * 4;
+		for (int32 row = 0; row < stampHeight; ++row) {
+			FMemory::Memcpy(readbackPixels.GetData() + row * rowSize, data + row * stride, rowSize);
+		}
+	}
+	RHIUnlockTexture2D(texture, 0, false);
+
+	return DecodeLatencyStamp(readbackPixels.GetData(), upload.width, stampHeight, frameNumber, timestamp);
+}
+
+LatencyDistribution LatencyProbe::GetPickupDistribution() const
+{
+	std::unique_lock<std::mutex> lockSamples(sampleMutex);
+	return Summarize(pickupSamples);
+}
+
+LatencyDistribution LatencyProbe::GetUploadDistribution() const
+{
+	std::unique_lock<std::mutex> lockSamples(sampleMutex);
+	return Summarize(uploadSamples);
+}
+
+int32 LatencyProbe::GetVerifiedUploads() const
+{
+	std::unique_lock<std::mutex> lockSamples(sampleMutex);
+	return verifiedUploads;
+}
+
+void LatencyProbe::GetSamples(TArray<float>& pickup, TArray<float>& upload) const
+{
+	std::unique_lock<std::mutex> lockSamples(sampleMutex);
+	pickup = pickupSamples;
+	upload = uploadSamples;
+}
+
+LatencyDistribution LatencyProbe::Summarize(TArray<float> samples)
+{
+	LatencyDistribution distribution;
+	distribution.count = samples.Num();
+	if (samples.Num() == 0) {
+		return distribution;
+	}
+
+	samples.Sort();
+	auto GetPercentile = [&samples](float fraction) {
+		return samples[FMath::Min(FMath::RoundToInt(fraction * (samples.Num() - 1)), samples.Num() - 1)];
+	};
+
+	double sum = 0.0;
+	for (float sample : samples) {
+		sum += sample;
+	}
+	distribution.min = samples[0];
+	distribution.mean = static_cast<float>(sum / samples.Num());
+	distribution.p50 = GetPercentile(0.5f);
+	distribution.p90 = GetPercentile(0.9f);
+	distribution.p99 = GetPercentile(0.99f);
+	distribution.max = samples.Last();
+	return distribution;
+}
@@ -0,0 +1,132 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <memory>
+#include <mutex>
+
+#include "RealSenseTypes.h"
+
+// End-to-end latency measurement with frames that carry their own identity.
+//
+// A stand-in camera source writes a stamp with the frame number and the host
+// time (FPlatformTime::Seconds()) of its capture into the top rows of every 
+// color image. The stamp is read again at later points of the pipeline, so 
+// the latency of every frame is measured against its own capture time even if
+// frames are dropped or repeated on the way. Every bit of the stamp fills a 
+// black or white cell of LatencyStampCellSize pixels, which is a multiple of
+// the 4x4 blocks of BC1 compression, so the stamp survives compressed 
+// texture uploads exactly. A magic number and a checksum reject images that
+// do not hold a stamp.
+
+// Width and height (in pixels) of the cell holding one bit of the stamp
+static const int32 LatencyStampCellSize = 8;
+
+// Returns the number of rows at the top of an image that hold the stamp, or 
+// 0 if the image is too small to hold it.
+int32 GetLatencyStampHeight(int32 width, int32 height);
+
+// Fills a BGRA image with a test pattern that moves with the frame number 
+// and writes the stamp over its top rows.
+void FillLatencyTestImage(uint8* bgra, int32 width, int32 height, uint64 frameNumber, double timestamp);
+
+// Reads the stamp from the top rows of a BGRA image. Returns false if the 
+// rows do not hold a valid stamp.
+bool DecodeLatencyStamp(const uint8* bgra, int32 width, int32 height, uint64& frameNumber, double& timestamp);
+
+// Percentiles of a set of latencies (in milliseconds)
+struct LatencyDistribution {
+	int32 count;
+	float min;
+	float mean;
+	float p50;
+	float p90;
+	float p99;
+	float max;
+
+	LatencyDistribution() : count(0), min(0.0f), mean(0.0f), p50(0.0f), p90(0.0f), p99(0.0f), max(0.0f) {}
+
+	// Formats the distribution for the log
+	FString ToString() const;
+};
+
+// Collects the latencies of stamped frames at two points of the pipeline: 
+// when the game thread copies a newly swapped frame, and when the render 
+// thread has uploaded the frame to a texture. The upload is measured by 
+// reading the stamp back from the texture, which shows that the texture 
+// really holds the frame. Where that is not possible, as with the null RHI,
+// the upload latency is taken from the stamp of the uploaded image instead,
+// and the sample is counted as unverified.
+class LatencyProbe : public std::enable_shared_from_this<LatencyProbe> {
+public:
+	LatencyProbe();
+
+	// Discards all samples.
+	void Reset();
+
+	// Called on the game thread with the color image of the current frame. 
+	// Returns false if the image holds no stamp or the frame was already 
+	// recorded.
+	bool RecordPickup(const uint8* bgra, int32 width, int32 height);
+
+	// Called on the game thread after the image has been written to the 
+	// texture. Enqueues a render command, behind the upload, that reads the 
+	// stamp back from the texture. Returns false if the image holds no stamp 
+	// or the frame was already recorded.
+	bool RecordUpload(UTexture2D* texture, const uint8* bgra, int32 width, int32 height);
+
+	LatencyDistribution GetPickupDistribution() const;
+
+	LatencyDistribution GetUploadDistribution() const;
+
+	// Returns the number of uploads whose stamp was read back from the texture
+	int32 GetVerifiedUploads() const;
+
+	// Returns all samples (in milliseconds), for writing them to a file
+	void GetSamples(TArray<float>& pickup, TArray<float>& upload) const;
+
+private:
+	mutable std::mutex sampleMutex;
+	TArray<float> pickupSamples;
+	TArray<float> uploadSamples;
+	int32 verifiedUploads;
+
+	// Latest frames recorded on the game thread, so that frames shown for 
+	// several ticks are counted once
+	uint64 lastPickupFrame;
+	uint64 lastUploadFrame;
+
+	// Buffers used by the render thread
+	TArray<uint8> readbackBlocks;
+	TArray<uint8> readbackPixels;
+
+	// Frame written to a texture, passed to the render thread
+	struct Upload {
+		FTexture2DResource* resource;
+		EPixelFormat format;
+		int32 width;
+		int32 height;
+		uint64 frameNumber;
+		double timestamp;
+	};
+
+	// Runs on the render thread
+	void MeasureUpload(const Upload& upload);
+
+	bool ReadBack(const Upload& upload, uint64& frameNumber, double& timestamp);
+
+	static LatencyDistribution Summarize(TArray<float> samples);
+};
@@ -16,6 +16,11 @@
 
 #include "RealSensePluginPrivatePCH.h"
 #include "RealSenseBlueprintLibrary.h"
+#include "RealSenseMeshUtils.h"
+#include "RealSenseScanAsset.h"
+#include "BlockCompression.h"
+
+DECLARE_CYCLE_STAT(TEXT("Texture Encoding"), STAT_RealSenseTextureEncoding, STATGROUP_RealSense);
 
 URealSenseBlueprintLibrary::URealSenseBlueprintLibrary(const class FObjectInitializer& ObjInit) 
 	: Super(ObjInit) 
@@ -88,10 +93,12 @@ FString URealSenseBlueprintLibrary::ECameraModelToString(ECameraModel value)
 	}
 }
 
-// Copies the data from the input Buffer into the PlatformData of the Texture object.
+// Copies the data from the input Buffer into the PlatformData of the Texture object,
+// encoding it into BC1 blocks if the Texture uses the DXT1 pixel format.
 // For convenience, this function returns a pointer to the input Texture that was 
 // modified.
-UTexture2D* URealSenseBlueprintLibrary::ColorBufferToTexture(const TArray<FSimpleColor>& Buffer, UTexture2D* Texture) 
+UTexture2D* URealSenseBlueprintLibrary::ColorBufferToTexture(const TArray<FSimpleColor>& Buffer, UTexture2D* Texture, 
+															 bool bHighQuality) 
 {
 	if (Texture == nullptr) {
 		return nullptr;
@@ -105,10 +112,17 @@ UTexture2D* URealSenseBlueprintLibrary::ColorBufferToTexture(const TArray<FSimpl
 	// The Texture's PlatformData needs to be locked before it can be modified.
 	auto out = reinterpret_cast<uint8*>(Texture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE));
 
-	// There are four bytes per pixel, one each for Red, Green, Blue, and Alpha.
-	uint8 bytesPerPixel = 4;
-	uint32 size = Texture->GetSizeX() * Texture->GetSizeY() * bytesPerPixel;
-	memcpy_s(out, size, Buffer.GetData(), size);
+	if (Texture->GetPixelFormat() == PF_DXT1) {
+		SCOPE_CYCLE_COUNTER(STAT_RealSenseTextureEncoding);
+		EncodeBC1(reinterpret_cast<const uint8*>(Buffer.GetData()), Texture->GetSizeX(), Texture->GetSizeY(), 
+				  bHighQuality, out);
+	}
+	else {
+		// There are four bytes per pixel, one each for Red, Green, Blue, and Alpha.
+		uint8 bytesPerPixel = 4;
+		uint32 size = Texture->GetSizeX() * Texture->GetSizeY() * bytesPerPixel;
+		memcpy_s(out, size, Buffer.GetData(), size);
+	}
 
 	Texture->PlatformData->Mips[0].BulkData.Unlock();
 	Texture->UpdateResource();
@@ -116,7 +130,8 @@ UTexture2D* URealSenseBlueprintLibrary::ColorBufferToTexture(const TArray<FSimpl
 	return Texture;
 }
 
-// Copies the data from the input Buffer into the PlatformData of the Texture object.
+// Copies the data from the input Buffer into the PlatformData of the Texture object,
+// encoding it into BC4 blocks if the Texture uses the BC4 pixel format.
 // For convenience, this function returns a pointer to the input Texture that was modified.
 UTexture2D* URealSenseBlueprintLibrary::DepthBufferToTexture(const TArray<int32>& Buffer, UTexture2D* Texture)
 {
@@ -132,21 +147,72 @@ UTexture2D* URealSenseBlueprintLibrary::DepthBufferToTexture(const TArray<int32>
 	// The Texture's PlatformData needs to be locked before it can be modified.
 	auto out = reinterpret_cast<uint8*>(Texture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE));
 
-	for (int32 x : Buffer) {
-		// Convert the depth value (in millimeters) into a value between 0 - 255. 
-		uint8 d = ConvertDepthValueTo8Bit(x, Texture->GetSizeX());
-		*out++ = d;
-		*out++ = d;
-		*out++ = d;
-		*out++ = 255;
+	if (Texture->GetPixelFormat() == PF_BC4) {
+		SCOPE_CYCLE_COUNTER(STAT_RealSenseTextureEncoding);
+		TArray<uint8> Values;
+		Values.SetNumUninitialized(Buffer.Num());
+		for (int32 i = 0; i < Buffer.Num(); ++i) {
+			Values[i] = ConvertDepthValueTo8Bit(Buffer[i], Texture->GetSizeX());
+		}
+		EncodeBC4(Values.GetData(), Texture->GetSizeX(), Texture->GetSizeY(), out);
+	}
+	else {
+		for (int32 x : Buffer) {
+			// Convert the depth value (in millimeters) into a value between 0 - 255. 
+			uint8 d = ConvertDepthValueTo8Bit(x, Texture->GetSizeX());
+			*out++ = d;
+			*out++ = d;
+			*out++ = d;
+			*out++ = 255;
+		}
+	}
+
+	Texture->PlatformData->Mips[0].BulkData.Unlock();
+	Texture->UpdateResource();
+
+	return Texture;
+}
+
+// Copies the raw pixels from the input Buffer into the PlatformData of the 
+// single-channel Texture object. For convenience, this function returns a 
+// pointer to the input Texture that was modified.
+UTexture2D* URealSenseBlueprintLibrary::DistanceFieldBufferToTexture(const TArray<uint8>& Buffer, UTexture2D* Texture)
+{
+	if (Texture == nullptr) {
+		return nullptr;
+	}
+
+	// Test that the Buffer and Texture have the same capacity
+	const int32 bytesPerPixel = (Texture->GetPixelFormat() == PF_G16) ? 2 : 1;
+	const int32 size = Texture->GetSizeX() * Texture->GetSizeY() * bytesPerPixel;
+	if (Buffer.Num() != size) {
+		return nullptr;
 	}
 
+	// The Texture's PlatformData needs to be locked before it can be modified.
+	auto out = reinterpret_cast<uint8*>(Texture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE));
+	memcpy_s(out, size, Buffer.GetData(), size);
+
 	Texture->PlatformData->Mips[0].BulkData.Unlock();
 	Texture->UpdateResource();
 
 	return Texture;
 }
 
+void URealSenseBlueprintLibrary::SmoothMesh(TArray<FVector>& Vertices, const TArray<int32>& Triangles, int32 Iterations)
+{
+	SmoothMeshTaubin(Vertices, Triangles, Iterations);
+}
+
+void URealSenseBlueprintLibrary::ConvertScanToStaticMesh(FString Filename, FString AssetPath, const FScanAssetOptions& Options,
+														 const FScanAssetCreatedDelegate& OnCreated)
+{
+	Filename = FPaths::GameContentDir().Append(Filename);
+	ConvertScanToStaticMeshAsync(Filename, AssetPath, Options, [OnCreated](UStaticMesh* StaticMesh) {
+		OnCreated.ExecuteIfBound(StaticMesh);
+	});
+}
+
 // Finds all .OBJ files in the specified Directory, relative to the Content 
 // path of the game.
 TArray<FString> URealSenseBlueprintLibrary::GetMeshFiles(FString Directory)
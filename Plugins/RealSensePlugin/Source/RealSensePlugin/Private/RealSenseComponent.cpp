@@ -95,6 +95,16 @@ bool URealSenseComponent::IsCameraRunning()
 	return globalRealSenseSession->IsCameraRunning();
 }
 
+void URealSenseComponent::PrewarmCamera()
+{
+	globalRealSenseSession->PrewarmCamera();
+}
+
+bool URealSenseComponent::IsCameraPrewarmed()
+{
+	return globalRealSenseSession->IsCameraPrewarmed();
+}
+
 FStreamResolution URealSenseComponent::GetColorCameraResolution() 
 {
 	return globalRealSenseSession->GetColorCameraResolution();
@@ -124,3 +134,43 @@ bool URealSenseComponent::IsStreamSetValid(EColorResolution ColorResolution,
 {
 	return globalRealSenseSession->IsStreamSetValid(ColorResolution, DepthResolution);
 }
+
+float URealSenseComponent::GetFrameAge()
+{
+	return static_cast<float>(FPlatformTime::Seconds() - globalRealSenseSession->GetFrameTimestamp());
+}
+
+float URealSenseComponent::GetFrameTimestampUncertainty()
+{
+	return static_cast<float>(globalRealSenseSession->GetFrameTimestampUncertainty());
+}
+
+float URealSenseComponent::GetClockDrift()
+{
+	return static_cast<float>(globalRealSenseSession->GetClockDriftPPM());
+}
+
+void URealSenseComponent::SetCaptureThrottling(float IdleSeconds, float KeepAliveFPS)
+{
+	globalRealSenseSession->SetCaptureThrottling(IdleSeconds, KeepAliveFPS);
+}
+
+void URealSenseComponent::NotifyDataAccess()
+{
+	globalRealSenseSession->NotifyDataAccess();
+}
+
+bool URealSenseComponent::IsCaptureThrottled()
+{
+	return globalRealSenseSession->IsCaptureThrottled();
+}
+
+// The render thread stamps textures with the application time whenever a 
+// material samples them, which also happens while the game is paused.
+void URealSenseComponent::NotifyDataAccessIfRendered(const UTexture* Texture)
+{
+	const double RecentlyRenderedSeconds = 0.5;
+	if (Texture && Texture->Resource && (FApp::GetCurrentTime() - Texture->Resource->LastRenderTime < RecentlyRenderedSeconds)) {
+		globalRealSenseSession->NotifyDataAccess();
+	}
+}
@@ -0,0 +1,641 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "RealSenseMeshUtils.h"
+#include "ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Convex Decomposition"), STAT_RealSenseConvexDecomposition, STATGROUP_RealSense);
+
+// Identifies convex hull cache files written by SaveConvexHullCache
+static const int32 ConvexHullCacheMagic = 0x48435352; // "RSCH"
+static const int32 ConvexHullCacheVersion = 1;
+
+// Number of candidate split planes tested along each axis
+static const int32 SplitCandidatesPerAxis = 7;
+
+// Clusters whose concavity is below this fraction of the volume of the whole
+// mesh are not split any further.
+static const float ConcavityThreshold = 0.01f;
+
+namespace {
+
+struct HullFace {
+	int32 V[3];
+	FVector Normal;
+	float Offset;
+	TArray<int32> Outside;
+	bool bAlive;
+
+	inline float Distance(const FVector& P) const { return FVector::DotProduct(Normal, P) - Offset; }
+};
+
+inline uint64 EdgeKey(int32 a, int32 b) 
+{ 
+	return (static_cast<uint64>(static_cast<uint32>(a)) << 32) | static_cast<uint32>(b); 
+}
+
+// Quickhull in 3D. Faces are kept counter-clockwise around their outward 
+// normal, and neighbors are found through a map of directed edges: the face 
+// across edge a->b is the one that owns edge b->a.
+class ConvexHullBuilder {
+public:
+	// Returns false if the points do not span a volume.
+	bool Build(const TArray<FVector>& InPoints)
+	{
+		Points = &InPoints;
+		Faces.Reset();
+		Edges.Reset();
+
+		const int32 NumPoints = InPoints.Num();
+		if (NumPoints < 4) {
+			return false;
+		}
+
+		FBox Bounds(InPoints.GetData(), NumPoints);
+		const FVector Extent = Bounds.GetSize();
+		Epsilon = FMath::Max(Extent.GetMax() * 1e-5f, SMALL_NUMBER);
+
+		// Initial tetrahedron: the extremes along the widest axis, the point 
+		// farthest from their line, and the point farthest from that plane.
+		const int32 Axis = (Extent.X >= Extent.Y && Extent.X >= Extent.Z) ? 0 : ((Extent.Y >= Extent.Z) ? 1 : 2);
+		int32 I0 = 0;
+		int32 I1 = 0;
+		for (int32 i = 1; i < NumPoints; ++i) {
+			if (InPoints[i][Axis] < InPoints[I0][Axis]) I0 = i;
+			if (InPoints[i][Axis] > InPoints[I1][Axis]) I1 = i;
+		}
+
+		const FVector Line = (InPoints[I1] - InPoints[I0]).GetSafeNormal();
+		int32 I2 = -1;
+		float Best = Epsilon;
+		for (int32 i = 0; i < NumPoints; ++i) {
+			const FVector Offset = InPoints[i] - InPoints[I0];
+			const float Distance = (Offset - Line * FVector::DotProduct(Offset, Line)).Size();
+			if (Distance > Best) {
+				Best = Distance;
+				I2 = i;
+			}
+		}
+		if (I2 < 0) {
+			return false;
+		}
+
+		const FVector PlaneNormal = FVector::CrossProduct(InPoints[I1] - InPoints[I0], InPoints[I2] - InPoints[I0]).GetSafeNormal();
+		int32 I3 = -1;
+		Best = Epsilon;
+		for (int32 i = 0; i < NumPoints; ++i) {
+			const float Distance = FMath::Abs(FVector::DotProduct(InPoints[i] - InPoints[I0], PlaneNormal));
+			if (Distance > Best) {
+				Best = Distance;
+				I3 = i;
+			}
+		}
+		if (I3 < 0) {
+			return false;
+		}
+
+		Interior = (InPoints[I0] + InPoints[I1] + InPoints[I2] + InPoints[I3]) * 0.25f;
+		AddFace(I0, I1, I2);
+		AddFace(I0, I1, I3);
+		AddFace(I0, I2, I3);
+		AddFace(I1, I2, I3);
+
+		TArray<int32> Candidates;
+		Candidates.Reserve(NumPoints);
+		for (int32 i = 0; i < NumPoints; ++i) {
+			if ((i != I0) && (i != I1) && (i != I2) && (i != I3)) {
+				Candidates.Add(i);
+			}
+		}
+		AssignOutside(Candidates, 0, -1);
+
+		TArray<int32> Visible;
+		TArray<int32> Stack;
+		TArray<FIntPoint> Horizon;
+		TArray<int32> Orphans;
+
+		for (int32 FaceIndex = 0; FaceIndex < Faces.Num(); ++FaceIndex) {
+			while (Faces[FaceIndex].bAlive && Faces[FaceIndex].Outside.Num() > 0) {
+				// The farthest outside point is guaranteed to be a hull vertex
+				const HullFace& Face = Faces[FaceIndex];
+				int32 Eye = Face.Outside[0];
+				float EyeDistance = Face.Distance(InPoints[Eye]);
+				for (int32 p : Face.Outside) {
+					const float Distance = Face.Distance(InPoints[p]);
+					if (Distance > EyeDistance) {
+						EyeDistance = Distance;
+						Eye = p;
+					}
+				}
+				const FVector& EyePoint = InPoints[Eye];
+
+				// Flood the faces that can see the eye point
+				Visible.Reset();
+				Stack.Reset();
+				Stack.Add(FaceIndex);
+				Faces[FaceIndex].bAlive = false;
+				while (Stack.Num() > 0) {
+					const int32 Current = Stack.Pop(false);
+					Visible.Add(Current);
+					for (int32 e = 0; e < 3; ++e) {
+						const int32* Neighbor = Edges.Find(EdgeKey(Faces[Current].V[(e + 1) % 3], Faces[Current].V[e]));
+						if (Neighbor && Faces[*Neighbor].bAlive && (Faces[*Neighbor].Distance(EyePoint) > Epsilon)) {
+							Faces[*Neighbor].bAlive = false;
+							Stack.Add(*Neighbor);
+						}
+					}
+				}
+
+				// The horizon consists of the edges of visible faces whose 
+				// neighbor stays on the hull.
+				Horizon.Reset();
+				Orphans.Reset();
+				for (int32 Current : Visible) {
+					for (int32 e = 0; e < 3; ++e) {
+						const int32 A = Faces[Current].V[e];
+						const int32 B = Faces[Current].V[(e + 1) % 3];
+						const int32* Neighbor = Edges.Find(EdgeKey(B, A));
+						if ((Neighbor == nullptr) || Faces[*Neighbor].bAlive) {
+							Horizon.Add(FIntPoint(A, B));
+						}
+					}
+					Orphans.Append(Faces[Current].Outside);
+					Faces[Current].Outside.Empty();
+				}
+				for (int32 Current : Visible) {
+					for (int32 e = 0; e < 3; ++e) {
+						Edges.Remove(EdgeKey(Faces[Current].V[e], Faces[Current].V[(e + 1) % 3]));
+					}
+				}
+
+				const int32 FirstNewFace = Faces.Num();
+				for (const FIntPoint& Edge : Horizon) {
+					AddFace(Edge.X, Edge.Y, Eye, false);
+				}
+				Orphans.Remove(Eye);
+				AssignOutside(Orphans, FirstNewFace, Faces.Num());
+			}
+		}
+
+		return true;
+	}
+
+	// Returns the volume enclosed by the hull.
+	float GetVolume() const
+	{
+		float Volume = 0.0f;
+		for (const HullFace& Face : Faces) {
+			if (Face.bAlive) {
+				const FVector A = (*Points)[Face.V[0]] - Interior;
+				const FVector B = (*Points)[Face.V[1]] - Interior;
+				const FVector C = (*Points)[Face.V[2]] - Interior;
+				Volume += FVector::DotProduct(A, FVector::CrossProduct(B, C)) / 6.0f;
+			}
+		}
+		return FMath::Abs(Volume);
+	}
+
+	// Returns the points that are vertices of the hull.
+	void GetVertices(TArray<FVector>& Vertices) const
+	{
+		TSet<int32> Used;
+		for (const HullFace& Face : Faces) {
+			if (Face.bAlive) {
+				Used.Add(Face.V[0]);
+				Used.Add(Face.V[1]);
+				Used.Add(Face.V[2]);
+			}
+		}
+		Vertices.Reset(Used.Num());
+		for (int32 i : Used) {
+			Vertices.Add((*Points)[i]);
+		}
+	}
+
+private:
+	const TArray<FVector>* Points;
+	TArray<HullFace> Faces;
+	TMap<uint64, int32> Edges;
+	FVector Interior;
+	float Epsilon;
+
+	// Adds the face (a, b, c). Faces of the initial tetrahedron are flipped 
+	// as needed to face away from the interior point; faces built from the 
+	// horizon inherit the orientation of the edge they close.
+	void AddFace(int32 a, int32 b, int32 c, bool bOrientToInterior = true)
+	{
+		const TArray<FVector>& P = *Points;
+		FVector Normal = FVector::CrossProduct(P[b] - P[a], P[c] - P[a]).GetSafeNormal();
+		if (bOrientToInterior && (FVector::DotProduct(Normal, P[a] - Interior) < 0.0f)) {
+			Swap(b, c);
+			Normal = -Normal;
+		}
+
+		HullFace Face;
+		Face.V[0] = a;
+		Face.V[1] = b;
+		Face.V[2] = c;
+		Face.Normal = Normal;
+		Face.Offset = FVector::DotProduct(Normal, P[a]);
+		Face.bAlive = true;
+
+		const int32 Index = Faces.Add(Face);
+		Edges.Add(EdgeKey(a, b), Index);
+		Edges.Add(EdgeKey(b, c), Index);
+		Edges.Add(EdgeKey(c, a), Index);
+	}
+
+	// Assigns every candidate point to the face in [FirstFace, EndFace) it is
+	// farthest in front of. Points behind all of them are inside the hull 
+	// and are dropped. An EndFace of -1 stands for all faces.
+	void AssignOutside(const TArray<int32>& Candidates, int32 FirstFace, int32 EndFace)
+	{
+		if (EndFace < 0) {
+			EndFace = Faces.Num();
+		}
+		for (int32 p : Candidates) {
+			int32 BestFace = -1;
+			float BestDistance = Epsilon;
+			for (int32 f = FirstFace; f < EndFace; ++f) {
+				const float Distance = Faces[f].Distance((*Points)[p]);
+				if (Distance > BestDistance) {
+					BestDistance = Distance;
+					BestFace = f;
+				}
+			}
+			if (BestFace >= 0) {
+				Faces[BestFace].Outside.Add(p);
+			}
+		}
+	}
+};
+
+// Solid voxelization of a mesh with a one voxel border of empty space
+struct VoxelGrid {
+	FIntVector Dims;
+	FVector Origin;
+	float VoxelSize;
+	TArray<uint8> Solid;
+
+	inline int32 Index(int32 x, int32 y, int32 z) const { return (z * Dims.Y + y) * Dims.X + x; }
+
+	inline FIntVector Coordinates(int32 Index) const 
+	{ 
+		return FIntVector(Index % Dims.X, (Index / Dims.X) % Dims.Y, Index / (Dims.X * Dims.Y)); 
+	}
+
+	inline FVector Corner(int32 x, int32 y, int32 z) const { return Origin + FVector(x, y, z) * VoxelSize; }
+};
+
+// Marks the voxels touched by the triangles by sampling every triangle at
+// half the voxel size, then flood-fills the empty space from the border. 
+// Everything that the flood does not reach is solid, so closed meshes become
+// filled volumes while open scans keep a thin shell.
+void Voxelize(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, int32 Resolution, VoxelGrid& Grid)
+{
+	const FBox Bounds(Vertices.GetData(), Vertices.Num());
+	const FVector Size = Bounds.GetSize();
+	Grid.VoxelSize = FMath::Max(Size.GetMax() / Resolution, KINDA_SMALL_NUMBER);
+	Grid.Dims = FIntVector(FMath::CeilToInt(Size.X / Grid.VoxelSize) + 3,
+						   FMath::CeilToInt(Size.Y / Grid.VoxelSize) + 3,
+						   FMath::CeilToInt(Size.Z / Grid.VoxelSize) + 3);
+	Grid.Origin = Bounds.Min - FVector(Grid.VoxelSize);
+
+	const int32 NumVoxels = Grid.Dims.X * Grid.Dims.Y * Grid.Dims.Z;
+	TArray<uint8> State;  // 0 = unknown, 1 = surface, 2 = outside
+	State.SetNumZeroed(NumVoxels);
+
+	const float InvVoxelSize = 1.0f / Grid.VoxelSize;
+	auto Mark = [&](const FVector& P) {
+		const FVector Local = (P - Grid.Origin) * InvVoxelSize;
+		const int32 x = FMath::Clamp(FMath::FloorToInt(Local.X), 0, Grid.Dims.X - 1);
+		const int32 y = FMath::Clamp(FMath::FloorToInt(Local.Y), 0, Grid.Dims.Y - 1);
+		const int32 z = FMath::Clamp(FMath::FloorToInt(Local.Z), 0, Grid.Dims.Z - 1);
+		State[Grid.Index(x, y, z)] = 1;
+	};
+
+	const int32 NumVertices = Vertices.Num();
+	for (int32 t = 0; t + 2 < Triangles.Num(); t += 3) {
+		const int32 I0 = Triangles[t];
+		const int32 I1 = Triangles[t + 1];
+		const int32 I2 = Triangles[t + 2];
+		if ((I0 < 0) || (I0 >= NumVertices) || (I1 < 0) || (I1 >= NumVertices) || (I2 < 0) || (I2 >= NumVertices)) {
+			continue;
+		}
+		const FVector& A = Vertices[I0];
+		const FVector& B = Vertices[I1];
+		const FVector& C = Vertices[I2];
+		const float LongestEdge = FMath::Max3((B - A).Size(), (C - B).Size(), (A - C).Size());
+		const int32 Steps = FMath::Max(1, FMath::CeilToInt(2.0f * LongestEdge * InvVoxelSize));
+		for (int32 i = 0; i <= Steps; ++i) {
+			for (int32 j = 0; i + j <= Steps; ++j) {
+				const float U = static_cast<float>(i) / Steps;
+				const float V = static_cast<float>(j) / Steps;
+				Mark(A + (B - A) * U + (C - A) * V);
+			}
+		}
+	}
+
+	TArray<int32> Stack;
+	Stack.Add(0);
+	State[0] = 2;
+	while (Stack.Num() > 0) {
+		const FIntVector P = Grid.Coordinates(Stack.Pop(false));
+		const FIntVector Neighbors[6] = { 
+			FIntVector(P.X - 1, P.Y, P.Z), FIntVector(P.X + 1, P.Y, P.Z),
+			FIntVector(P.X, P.Y - 1, P.Z), FIntVector(P.X, P.Y + 1, P.Z),
+			FIntVector(P.X, P.Y, P.Z - 1), FIntVector(P.X, P.Y, P.Z + 1) 
+		};
+		for (const FIntVector& N : Neighbors) {
+			if ((N.X < 0) || (N.Y < 0) || (N.Z < 0) || (N.X >= Grid.Dims.X) || (N.Y >= Grid.Dims.Y) || (N.Z >= Grid.Dims.Z)) {
+				continue;
+			}
+			const int32 Index = Grid.Index(N.X, N.Y, N.Z);
+			if (State[Index] == 0) {
+				State[Index] = 2;
+				Stack.Add(Index);
+			}
+		}
+	}
+
+	Grid.Solid.SetNumUninitialized(NumVoxels);
+	for (int32 i = 0; i < NumVoxels; ++i) {
+		Grid.Solid[i] = (State[i] != 2) ? 1 : 0;
+	}
+}
+
+// A set of solid voxels that will become one convex hull
+struct VoxelCluster {
+	TArray<int32> Voxels;
+	float HullVolume;
+	float Concavity;
+};
+
+// The hull of a voxel set is spanned by the outer faces of the first and last
+// voxel of every row along X, since all other voxels of a row lie between them.
+void GetClusterHullPoints(const VoxelGrid& Grid, const TArray<int32>& Voxels, TArray<FVector>& Points)
+{
+	const int32 NumRows = Grid.Dims.Y * Grid.Dims.Z;
+	TArray<int32> MinX;
+	TArray<int32> MaxX;
+	MinX.Init(MAX_int32, NumRows);
+	MaxX.Init(-1, NumRows);
+
+	for (int32 Voxel : Voxels) {
+		const FIntVector P = Grid.Coordinates(Voxel);
+		const int32 Row = P.Z * Grid.Dims.Y + P.Y;
+		MinX[Row] = FMath::Min(MinX[Row], P.X);
+		MaxX[Row] = FMath::Max(MaxX[Row], P.X);
+	}
+
+	Points.Reset();
+	for (int32 Row = 0; Row < NumRows; ++Row) {
+		if (MaxX[Row] < 0) {
+			continue;
+		}
+		const int32 y = Row % Grid.Dims.Y;
+		const int32 z = Row / Grid.Dims.Y;
+		for (int32 Corner = 0; Corner < 4; ++Corner) {
+			const int32 dy = Corner & 1;
+			const int32 dz = Corner >> 1;
+			Points.Add(Grid.Corner(MinX[Row], y + dy, z + dz));
+			Points.Add(Grid.Corner(MaxX[Row] + 1, y + dy, z + dz));
+		}
+	}
+}
+
+// Computes the hull volume of the cluster and its concavity, the volume the
+// hull adds on top of the voxels themselves.
+void EvaluateCluster(const VoxelGrid& Grid, VoxelCluster& Cluster)
+{
+	TArray<FVector> Points;
+	GetClusterHullPoints(Grid, Cluster.Voxels, Points);
+
+	const float VoxelVolume = Grid.VoxelSize * Grid.VoxelSize * Grid.VoxelSize;
+	ConvexHullBuilder Hull;
+	Cluster.HullVolume = Hull.Build(Points) ? Hull.GetVolume() : 0.0f;
+	Cluster.Concavity = FMath::Max(Cluster.HullVolume - Cluster.Voxels.Num() * VoxelVolume, 0.0f);
+}
+
+// Tests evenly spaced axis-aligned planes through the cluster in parallel and
+// splits it along the one that leaves the least concavity in both halves.
+// Returns false if the cluster cannot be split.
+bool SplitCluster(const VoxelGrid& Grid, const VoxelCluster& Cluster, VoxelCluster& Left, VoxelCluster& Right)
+{
+	FIntVector Min(MAX_int32, MAX_int32, MAX_int32);
+	FIntVector Max(-1, -1, -1);
+	for (int32 Voxel : Cluster.Voxels) {
+		const FIntVector P = Grid.Coordinates(Voxel);
+		Min = FIntVector(FMath::Min(Min.X, P.X), FMath::Min(Min.Y, P.Y), FMath::Min(Min.Z, P.Z));
+		Max = FIntVector(FMath::Max(Max.X, P.X), FMath::Max(Max.Y, P.Y), FMath::Max(Max.Z, P.Z));
+	}
+
+	// Candidate planes as (axis, first coordinate of the right half)
+	TArray<FIntPoint> Planes;
+	for (int32 Axis = 0; Axis < 3; ++Axis) {
+		const int32 Lo = Min[Axis];
+		const int32 Hi = Max[Axis];
+		for (int32 k = 1; k <= SplitCandidatesPerAxis; ++k) {
+			const int32 Position = Lo + FMath::Max(1, ((Hi - Lo + 1) * k) / (SplitCandidatesPerAxis + 1));
+			if ((Position > Lo) && (Position <= Hi)) {
+				Planes.AddUnique(FIntPoint(Axis, Position));
+			}
+		}
+	}
+	if (Planes.Num() == 0) {
+		return false;
+	}
+
+	TArray<VoxelCluster> Lefts;
+	TArray<VoxelCluster> Rights;
+	Lefts.SetNum(Planes.Num());
+	Rights.SetNum(Planes.Num());
+
+	ParallelFor(Planes.Num(), [&](int32 i) {
+		const int32 Axis = Planes[i].X;
+		const int32 Position = Planes[i].Y;
+		for (int32 Voxel : Cluster.Voxels) {
+			if (Grid.Coordinates(Voxel)[Axis] < Position) {
+				Lefts[i].Voxels.Add(Voxel);
+			}
+			else {
+				Rights[i].Voxels.Add(Voxel);
+			}
+		}
+		EvaluateCluster(Grid, Lefts[i]);
+		EvaluateCluster(Grid, Rights[i]);
+	});
+
+	int32 BestPlane = -1;
+	float BestCost = MAX_flt;
+	for (int32 i = 0; i < Planes.Num(); ++i) {
+		if ((Lefts[i].Voxels.Num() == 0) || (Rights[i].Voxels.Num() == 0)) {
+			continue;
+		}
+		const float Cost = Lefts[i].Concavity + Rights[i].Concavity;
+		if (Cost < BestCost) {
+			BestCost = Cost;
+			BestPlane = i;
+		}
+	}
+	if (BestPlane < 0) {
+		return false;
+	}
+
+	Left = MoveTemp(Lefts[BestPlane]);
+	Right = MoveTemp(Rights[BestPlane]);
+	return true;
+}
+
+}
+
+// Hierarchical approximate convex decomposition on a solid voxelization of 
+// the mesh: starting from a single cluster, the cluster with the largest 
+// concavity is split until MaxHulls clusters exist or every cluster is nearly
+// convex. The hull vertices of the final clusters are returned.
+void ComputeConvexDecomposition(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, 
+								int32 MaxHulls, int32 Resolution, TArray<FScanConvexHull>& Hulls)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseConvexDecomposition);
+
+	Hulls.Reset();
+	if ((Vertices.Num() < 4) || (Triangles.Num() < 3) || (MaxHulls <= 0)) {
+		return;
+	}
+
+	VoxelGrid Grid;
+	Voxelize(Vertices, Triangles, FMath::Clamp(Resolution, 8, 256), Grid);
+
+	TArray<VoxelCluster> Clusters;
+	Clusters.AddDefaulted();
+	for (int32 i = 0; i < Grid.Solid.Num(); ++i) {
+		if (Grid.Solid[i]) {
+			Clusters[0].Voxels.Add(i);
+		}
+	}
+	EvaluateCluster(Grid, Clusters[0]);
+
+	const float StopConcavity = ConcavityThreshold * Clusters[0].HullVolume;
+	TArray<bool> Splittable;
+	Splittable.Init(true, 1);
+
+	while (Clusters.Num() < MaxHulls) {
+		int32 Worst = -1;
+		for (int32 i = 0; i < Clusters.Num(); ++i) {
+			if (Splittable[i] && (Clusters[i].Concavity > StopConcavity) && 
+				((Worst < 0) || (Clusters[i].Concavity > Clusters[Worst].Concavity))) {
+				Worst = i;
+			}
+		}
+		if (Worst < 0) {
+			break;
+		}
+
+		VoxelCluster Left;
+		VoxelCluster Right;
+		if (SplitCluster(Grid, Clusters[Worst], Left, Right) == false) {
+			Splittable[Worst] = false;
+			continue;
+		}
+
+		Clusters[Worst] = MoveTemp(Left);
+		Clusters.Add(MoveTemp(Right));
+		Splittable.Add(true);
+	}
+
+	TArray<FVector> Points;
+	ConvexHullBuilder Hull;
+	for (const VoxelCluster& Cluster : Clusters) {
+		GetClusterHullPoints(Grid, Cluster.Voxels, Points);
+		if (Hull.Build(Points)) {
+			FScanConvexHull& Result = Hulls[Hulls.AddDefaulted()];
+			Hull.GetVertices(Result.Vertices);
+		}
+	}
+}
+
+// The cache stores a checksum of the mesh and the decomposition parameters,
+// so it is invalidated both by edits to the scan file and by processing such
+// as smoothing that happens after loading.
+static uint32 GetConvexHullCacheKey(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, 
+									int32 MaxHulls, int32 Resolution)
+{
+	uint32 Crc = FCrc::MemCrc32(Vertices.GetData(), Vertices.Num() * sizeof(FVector));
+	Crc = FCrc::MemCrc32(Triangles.GetData(), Triangles.Num() * sizeof(int32), Crc);
+	Crc = FCrc::MemCrc32(&MaxHulls, sizeof(int32), Crc);
+	return FCrc::MemCrc32(&Resolution, sizeof(int32), Crc);
+}
+
+FString GetConvexHullCacheFilename(const FString& ScanFilename)
+{
+	return ScanFilename + TEXT(".hulls");
+}
+
+bool LoadConvexHullCache(const FString& ScanFilename, const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+						 int32 MaxHulls, int32 Resolution, TArray<FScanConvexHull>& Hulls)
+{
+	TArray<uint8> Data;
+	if (FFileHelper::LoadFileToArray(Data, *GetConvexHullCacheFilename(ScanFilename), FILEREAD_Silent) == false) {
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+	int32 Magic = 0;
+	int32 Version = 0;
+	uint32 Key = 0;
+	Reader << Magic << Version << Key;
+	if ((Magic != ConvexHullCacheMagic) || (Version != ConvexHullCacheVersion) || 
+		(Key != GetConvexHullCacheKey(Vertices, Triangles, MaxHulls, Resolution))) {
+		return false;
+	}
+
+	// Counts read from a truncated or corrupt file are checked before 
+	// anything is allocated for them
+	int32 NumHulls = 0;
+	Reader << NumHulls;
+	if ((NumHulls < 0) || (NumHulls > MaxHulls)) {
+		return false;
+	}
+	Hulls.SetNum(NumHulls);
+	for (FScanConvexHull& Hull : Hulls) {
+		const int64 HullStart = Reader.Tell();
+		int32 NumVertices = 0;
+		Reader << NumVertices;
+		if ((NumVertices < 0) || (NumVertices * static_cast<int64>(sizeof(FVector)) > Reader.TotalSize() - Reader.Tell())) {
+			Hulls.Empty();
+			return false;
+		}
+		Reader.Seek(HullStart);
+		Reader << Hull.Vertices;
+	}
+	return (Reader.IsError() == false);
+}
+
+bool SaveConvexHullCache(const FString& ScanFilename, const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+						 int32 MaxHulls, int32 Resolution, const TArray<FScanConvexHull>& Hulls)
+{
+	FBufferArchive Writer;
+	int32 Magic = ConvexHullCacheMagic;
+	int32 Version = ConvexHullCacheVersion;
+	uint32 Key = GetConvexHullCacheKey(Vertices, Triangles, MaxHulls, Resolution);
+	int32 NumHulls = Hulls.Num();
+	Writer << Magic << Version << Key << NumHulls;
+	for (const FScanConvexHull& Hull : Hulls) {
+		TArray<FVector> HullVertices = Hull.Vertices;
+		Writer << HullVertices;
+	}
+	return FFileHelper::SaveArrayToFile(Writer, *GetConvexHullCacheFilename(ScanFilename));
+}
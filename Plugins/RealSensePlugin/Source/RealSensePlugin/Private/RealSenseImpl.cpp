@@ -15,6 +15,9 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 #include "RealSensePluginPrivatePCH.h"
 #include "RealSenseImpl.h"
+#include "LatencyProbe.h"
+
+DECLARE_CYCLE_STAT(TEXT("Depth Quality"), STAT_RealSenseDepthQuality, STATGROUP_RealSense);
 
 // Creates handles to the RealSense Session and SenseManager and iterates over 
 // all video capture devices to find a RealSense camera.
@@ -72,10 +75,18 @@ RealSenseImpl::RealSenseImpl()
 	bFaceEnabled = false;
 
 	bCameraThreadRunning = false;
+	prewarmFeatureSet = 0;
+	cameraFeatureSet = 0;
+	bSyntheticSource = false;
+	syntheticFPS = 30.0f;
+	bCaptureThrottled = false;
+	keepAliveFPS = 0.0f;
+
+	bReplaying = false;
 
-	fgFrame = std::unique_ptr<RealSenseDataFrame>(new RealSenseDataFrame());
-	midFrame = std::unique_ptr<RealSenseDataFrame>(new RealSenseDataFrame());
-	bgFrame = std::unique_ptr<RealSenseDataFrame>(new RealSenseDataFrame());
+	fgFrame = std::make_shared<RealSenseDataFrame>();
+	midFrame = std::make_shared<RealSenseDataFrame>();
+	bgFrame = std::make_shared<RealSenseDataFrame>();
 
 	colorResolution = {};
 	depthResolution = {};
@@ -104,6 +115,43 @@ RealSenseImpl::RealSenseImpl()
 	bReconstructEnabled = false;
 	bScanCompleted = false;
 	bScan3DImageSizeChanged = false;
+
+	headCropResolution = {};
+	bHeadCropEnabled = false;
+	headCropSmoothing = 0.0f;
+	headCropCenter = FVector2D::ZeroVector;
+	headCropHeight = 0.0f;
+	bHeadCropTracking = false;
+
+	upsampledDepthResolution = {};
+	bDepthUpsampleEnabled = false;
+	depthUpsampleMilliseconds = 0.0f;
+
+	distanceFieldResolution = {};
+	distanceFieldSource = EDistanceFieldSource::SEGMENTATION_3D;
+	distanceFieldFormat = EDistanceFieldFormat::G8;
+	distanceFieldMaxDistance = 0.0f;
+	bDistanceFieldEnabled = false;
+	distanceFieldNearDepth = 1;
+	distanceFieldFarDepth = 1000;
+
+	clockDriftPPM = 0.0;
+
+	triggerVolumeStride = 2;
+	bTriggerVolumesChanged = false;
+	cameraTransform = FTransform::Identity;
+
+	bTouchDetectionEnabled = false;
+	bTouchCalibrated = false;
+	touchCalibrationFrames = 0;
+	touchMinHeight = 5;
+	touchMaxHeight = 30;
+	touchMinArea = 8;
+	touchMaxArea = 2000;
+
+	bBodyBoundsEnabled = false;
+	floorPlane = FPlane(0.0f, 0.0f, 1.0f, 0.0f);
+	bFloorPlaneSet = false;
 }
 
 // Terminate the camera thread and release the Core SDK handles.
@@ -111,9 +159,64 @@ RealSenseImpl::RealSenseImpl()
 RealSenseImpl::~RealSenseImpl() 
 {
 	if (bCameraThreadRunning) {
-		bCameraThreadRunning = false;
+		{
+			std::unique_lock<std::mutex> lockThrottle(throttleMutex);
+			bCameraThreadRunning = false;
+		}
+		throttleCondition.notify_all();
 		cameraThread.join();
 	}
+	if (prewarmStatus.valid()) {
+		prewarmStatus.get();
+	}
+}
+
+template<typename T>
+static void MatchImageSize(TArray<T>& image, const TArray<T>& sourceImage)
+{
+	if (image.Num() != sourceImage.Num()) {
+		image.SetNumZeroed(sourceImage.Num());
+	}
+}
+
+// Copies the fields of source that are not images into frame, and sizes 
+// each image of frame like the same image of source. Images that already 
+// have the right size keep their contents.
+static void CopyFrameLayout(const RealSenseDataFrame& source, RealSenseDataFrame& frame)
+{
+	frame.number = source.number;
+	frame.sensorTimestamp = source.sensorTimestamp;
+	frame.arrivalTime = source.arrivalTime;
+	frame.hostTimestamp = source.hostTimestamp;
+	frame.timestampUncertainty = source.timestampUncertainty;
+	frame.depthQuality = source.depthQuality;
+	frame.triggerOccupancy = source.triggerOccupancy;
+	frame.touchPoints = source.touchPoints;
+	frame.bodyBounds = source.bodyBounds;
+	frame.headCount = source.headCount;
+	frame.headPosition = source.headPosition;
+	frame.headRotation = source.headRotation;
+
+	MatchImageSize(frame.colorImage, source.colorImage);
+	MatchImageSize(frame.depthImage, source.depthImage);
+	MatchImageSize(frame.scanImage, source.scanImage);
+	MatchImageSize(frame.headCropImage, source.headCropImage);
+	MatchImageSize(frame.upsampledDepthImage, source.upsampledDepthImage);
+	MatchImageSize(frame.distanceFieldImage, source.distanceFieldImage);
+}
+
+// A snapshot may still hold the frame that came back from the game thread. 
+// Only snapshots of the foreground frame can be taken, so the reference count
+// of the background frame can only decrease here. The held frame is replaced
+// by a new one with the same buffer sizes, set up by the Enable functions, 
+// but without copying the images that the next frame overwrites.
+void RealSenseImpl::ReleaseHeldBackgroundFrame()
+{
+	if (bgFrame.use_count() > 1) {
+		std::shared_ptr<RealSenseDataFrame> frame = std::make_shared<RealSenseDataFrame>();
+		CopyFrameLayout(*bgFrame, *frame);
+		bgFrame = frame;
+	}
 }
 
 // Camera Processing Thread
@@ -131,21 +234,44 @@ void RealSenseImpl::CameraThread()
 	midFrame->number = 0;
 	bgFrame->number = 0;
 
-	pxcStatus status = senseManager->Init();
+	// A prewarmed pipeline has already been initialized in the background
+	pxcStatus status = prewarmStatus.valid() ? prewarmStatus.get() : senseManager->Init();
 	RS_LOG_STATUS(status, "SenseManager Initialized")
 
 	assert(status == PXC_STATUS_NO_ERROR);
 
+	// The projection must come from the device opened by the SenseManager so
+	// that it uses the calibration of the active stream configuration.
+	PXCCapture::Device* activeDevice = senseManager->QueryCaptureManager()->QueryDevice();
+	if (activeDevice) {
+		projection = std::unique_ptr<PXCProjection, RealSenseDeleter>(activeDevice->CreateProjection());
+	}
+
 	if (bFaceEnabled) {
 		faceData = pFace->CreateOutput();
 	}
 
+	// Sensor timestamps restart with the stream
+	clockSynchronizer.Reset();
+
+	double lastAcquireTime = 0.0;
 	while (bCameraThreadRunning == true) {
+		if (bCaptureThrottled) {
+			WaitWhileThrottled(lastAcquireTime);
+			if (bCameraThreadRunning == false) {
+				break;
+			}
+		}
+
 		// Acquires new camera frame
 		status = senseManager->AcquireFrame(true);
+		lastAcquireTime = FPlatformTime::Seconds();
 		assert(status == PXC_STATUS_NO_ERROR);
 
+		ReleaseHeldBackgroundFrame();
+
 		bgFrame->number = ++currentFrame;
+		UpdateFrameTimestamp();
 
 		// Performs Core SDK and middleware processing and store results 
 		// in background RealSenseDataFrame
@@ -165,6 +291,86 @@ void RealSenseImpl::CameraThread()
 
 			CopyColorImageToBuffer(sample->color, bgFrame->colorImage, colorResolution.width, colorResolution.height);
 			CopyDepthImageToBuffer(sample->depth, bgFrame->depthImage, depthResolution.width, depthResolution.height);
+
+			SCOPE_CYCLE_COUNTER(STAT_RealSenseDepthQuality);
+			bgFrame->depthQuality = depthQualityEstimator.Analyze(bgFrame->depthImage, depthResolution.width, depthResolution.height);
+
+			if (bDepthUpsampleEnabled && projection && sample->depth) {
+				depthUVMap.SetNumUninitialized(depthResolution.width * depthResolution.height);
+				if (projection->QueryUVMap(sample->depth, depthUVMap.GetData()) >= PXC_STATUS_NO_ERROR) {
+					depthUpsampler.Upsample(bgFrame->depthImage, depthUVMap, depthResolution.width, depthResolution.height,
+											bgFrame->colorImage, colorResolution.width, colorResolution.height,
+											bgFrame->upsampledDepthImage, upsampledDepthResolution.width, upsampledDepthResolution.height);
+					depthUpsampleMilliseconds = depthUpsampler.GetAverageMilliseconds();
+				}
+			}
+
+			FTransform depthCameraTransform;
+			{
+				std::unique_lock<std::mutex> lockTriggerVolumes(triggerVolumeMutex);
+				if (bTriggerVolumesChanged) {
+					triggerVolumeTester.SetVolumes(pendingTriggerVolumes);
+					bTriggerVolumesChanged = false;
+				}
+				depthCameraTransform = cameraTransform;
+			}
+			triggerVolumeTester.Test(bgFrame->depthImage, depthResolution.width, depthResolution.height,
+									 depthHorizontalFOV, depthVerticalFOV, depthCameraTransform, 
+									 triggerVolumeStride, bgFrame->triggerOccupancy);
+
+			if (bBodyBoundsEnabled) {
+				FPlane plane;
+				bool bHasPlane;
+				{
+					std::unique_lock<std::mutex> lockFloorPlane(floorPlaneMutex);
+					plane = floorPlane;
+					bHasPlane = bFloorPlaneSet;
+				}
+				bgFrame->bodyBounds = bodyBoundsEstimator.Estimate(bgFrame->depthImage, depthResolution.width, depthResolution.height,
+																   depthHorizontalFOV, depthVerticalFOV, depthCameraTransform,
+																   bHasPlane ? &plane : nullptr, bgFrame->hostTimestamp);
+			}
+			else {
+				bodyBoundsEstimator.Reset();
+				bgFrame->bodyBounds = FBodyBounds();
+			}
+
+			if (bTouchDetectionEnabled) {
+				const uint32 calibrationFrames = touchCalibrationFrames.exchange(0);
+				if (calibrationFrames > 0) {
+					touchDetector.StartCalibration(calibrationFrames);
+				}
+				touchDetector.Configure(touchMinHeight, touchMaxHeight, touchMinArea, touchMaxArea);
+				touchDetector.Process(bgFrame->depthImage, depthResolution.width, depthResolution.height, bgFrame->touchPoints);
+
+				// A calibration requested since the exchange keeps the flag cleared
+				std::unique_lock<std::mutex> lockCalibration(touchCalibrationMutex);
+				if (touchCalibrationFrames == 0) {
+					bTouchCalibrated = touchDetector.IsCalibrated();
+				}
+			}
+			else {
+				bgFrame->touchPoints.Reset();
+			}
+		}
+
+		else if (bHeadCropEnabled) {
+			// The head crop needs the color image even if nothing else streams it
+			PXCCapture::Sample* sample = senseManager->QuerySample();
+			if (sample->color) {
+				CopyColorImageToBuffer(sample->color, bgFrame->colorImage, colorResolution.width, colorResolution.height);
+			}
+		}
+
+		if (bDistanceFieldEnabled) {
+			if (distanceFieldSource == EDistanceFieldSource::SEGMENTATION_3D) {
+				distanceFieldGenerator.BuildMaskFromAlpha(bgFrame->colorImage, colorResolution.width, colorResolution.height);
+			}
+			else {
+				distanceFieldGenerator.BuildMaskFromDepth(bgFrame->depthImage, depthResolution.width, depthResolution.height,
+														  distanceFieldNearDepth, distanceFieldFarDepth);
+			}
+			distanceFieldGenerator.Compute(bgFrame->distanceFieldImage);
 		}
 
 		if (bScan3DEnabled) {
@@ -185,6 +391,7 @@ void RealSenseImpl::CameraThread()
 			PXCImage* scanImage = p3DScan->AcquirePreviewImage();
 			if (scanImage) {
 				UpdateScan3DImageSize(scanImage->QueryInfo());
+				bgFrame->scanImage.SetNumUninitialized(scan3DResolution.width * scan3DResolution.height * 4);
 				CopyColorImageToBuffer(scanImage, bgFrame->scanImage, scan3DResolution.width, scan3DResolution.height);
 				scanImage->Release();
 			}
@@ -213,47 +420,299 @@ void RealSenseImpl::CameraThread()
 					bgFrame->headRotation = FRotator(headRotation.pitch, headRotation.yaw, headRotation.roll);
 				}
 			}
+
+			std::shared_ptr<HeadPoseQueue> queue = std::atomic_load(&headPoseQueue);
+			if (queue) {
+				FHeadPoseSample sample;
+				sample.FrameNumber = static_cast<int32>(bgFrame->number);
+				sample.Timestamp = static_cast<float>(bgFrame->hostTimestamp - GStartTime);
+				sample.HeadCount = bgFrame->headCount;
+				sample.Position = bgFrame->headPosition;
+				sample.Rotation = bgFrame->headRotation;
+				queue->Push(sample);
+			}
+		}
+
+		if (bHeadCropEnabled) {
+			UpdateHeadCrop();
 		}
 		
 		senseManager->ReleaseFrame();
 
+		if (frameRecorder.IsRecording()) {
+			frameRecorder.Record(bgFrame->number, bgFrame->hostTimestamp, 
+								 bgFrame->colorImage, colorResolution.width, colorResolution.height,
+								 bgFrame->depthImage, depthResolution.width, depthResolution.height);
+		}
+
 		// Swaps background and mid RealSenseDataFrames
 		std::unique_lock<std::mutex> lockIntermediate(midFrameMutex);
 		bgFrame.swap(midFrame);
 	}
 }
 
-// If it is not already running, starts a new camera processing thread
+// If it is not already running, starts a new camera processing thread. A 
+// prewarmed pipeline is used if it was initialized with the same middleware, 
+// even if its initialization is still in progress. A running pipeline that 
+// lacks some of the enabled middleware is restarted, because middleware is 
+// only created when the pipeline is initialized.
 void RealSenseImpl::StartCamera() 
 {
-	if (bCameraThreadRunning == false) {
-		EnableMiddleware();
+	if (IsMiddlewareMissing()) {
+		RS_LOG(Log, "Restarting the camera to add middleware")
+		StopCamera();
+	}
+
+	if ((bCameraThreadRunning == false) && bSyntheticSource) {
+		bCameraThreadRunning = true;
+		cameraThread = std::thread([this]() { SyntheticCameraThread(); });
+	}
+	else if (bCameraThreadRunning == false) {
+		if (prewarmStatus.valid() && (prewarmFeatureSet != GetMiddlewareFeatureSet())) {
+			RS_LOG(Log, "Middleware changed since the camera was prewarmed")
+			DiscardPrewarm();
+		}
+		if (prewarmStatus.valid() == false) {
+			EnableMiddleware();
+		}
+		cameraFeatureSet = GetMiddlewareFeatureSet();
 		bCameraThreadRunning = true;
 		cameraThread = std::thread([this]() { CameraThread(); });
 	}
 }
 
+// Stand-in for the camera processing thread that produces stamped color 
+// images at syntheticFPS without any device. Only the color image and the 
+// timestamps of the frames are set.
+void RealSenseImpl::SyntheticCameraThread()
+{
+	uint64 currentFrame = 0;
+
+	fgFrame->number = 0;
+	midFrame->number = 0;
+	bgFrame->number = 0;
+
+	double nextFrameTime = FPlatformTime::Seconds();
+	while (bCameraThreadRunning == true) {
+		// Frames that are late are not made up for, like a camera that drops them
+		nextFrameTime += 1.0 / FMath::Max(syntheticFPS.load(), 1.0f);
+		const double waitSeconds = nextFrameTime - FPlatformTime::Seconds();
+		if (waitSeconds > 0.0) {
+			FPlatformProcess::Sleep(static_cast<float>(waitSeconds));
+		}
+		else {
+			nextFrameTime = FPlatformTime::Seconds();
+		}
+
+		ReleaseHeldBackgroundFrame();
+
+		bgFrame->number = ++currentFrame;
+		bgFrame->sensorTimestamp = 0;
+		bgFrame->arrivalTime = FPlatformTime::Seconds();
+		bgFrame->hostTimestamp = bgFrame->arrivalTime;
+		bgFrame->timestampUncertainty = 0.0;
+
+		const uint8 bytesPerPixel = 4;
+		if (bgFrame->colorImage.Num() == colorResolution.width * colorResolution.height * bytesPerPixel) {
+			FillLatencyTestImage(bgFrame->colorImage.GetData(), colorResolution.width, colorResolution.height, 
+								 bgFrame->number, bgFrame->hostTimestamp);
+		}
+
+		std::unique_lock<std::mutex> lockIntermediate(midFrameMutex);
+		bgFrame.swap(midFrame);
+	}
+}
+
 // If there is a camera processing thread running, this function terminates it. 
 // Then it resets the SenseManager pipeline (by closing it and re-enabling the 
 // previously specified feature set).
 void RealSenseImpl::StopCamera() 
 {
 	if (bCameraThreadRunning) {
-		bCameraThreadRunning = false;
+		{
+			std::unique_lock<std::mutex> lockThrottle(throttleMutex);
+			bCameraThreadRunning = false;
+		}
+		throttleCondition.notify_all();
 		cameraThread.join();
 	}
+	if (prewarmStatus.valid()) {
+		prewarmStatus.get();
+	}
+	projection.reset();
 	senseManager->Close();
+
+	depthUpsampler.LogTimings();
 }
 
-// Swaps the mid and foreground RealSenseDataFrames.
+void RealSenseImpl::SetSyntheticSource(bool bEnabled, float fps)
+{
+	const bool bRestartCamera = bCameraThreadRunning && (bEnabled != bSyntheticSource);
+	if (bRestartCamera) {
+		StopCamera();
+	}
+
+	bSyntheticSource = bEnabled;
+	syntheticFPS = fps;
+
+	if (bRestartCamera) {
+		StartCamera();
+	}
+}
+
+// The state is changed under the throttle mutex so that the camera thread 
+// cannot miss the notification between checking the state and waiting.
+void RealSenseImpl::SetCaptureThrottled(bool bThrottled, float fps)
+{
+	{
+		std::unique_lock<std::mutex> lockThrottle(throttleMutex);
+		bCaptureThrottled = bThrottled;
+		keepAliveFPS = FMath::Max(fps, 0.0f);
+	}
+	throttleCondition.notify_all();
+}
+
+// Blocks the camera thread until the next keep-alive frame is due, or until 
+// the throttling is lifted or the thread is stopped. Frames that arrive in 
+// the meantime are dropped by the SDK.
+void RealSenseImpl::WaitWhileThrottled(double lastAcquireTime)
+{
+	auto bWake = [this]() { return (bCaptureThrottled == false) || (bCameraThreadRunning == false); };
+
+	std::unique_lock<std::mutex> lockThrottle(throttleMutex);
+	if (keepAliveFPS > 0.0f) {
+		const double wait = lastAcquireTime + 1.0 / keepAliveFPS - FPlatformTime::Seconds();
+		if (wait > 0.0) {
+			throttleCondition.wait_for(lockThrottle, std::chrono::duration<double>(wait), bWake);
+		}
+	}
+	else {
+		throttleCondition.wait(lockThrottle, bWake);
+	}
+}
+
+// Swaps the mid and foreground RealSenseDataFrames. During replays, the 
+// liveFrame keeps cycling with the mid frame in place of the foreground frame.
 void RealSenseImpl::SwapFrames()
 {
 	std::unique_lock<std::mutex> lock(midFrameMutex);
-	if (fgFrame->number < midFrame->number) {
-		fgFrame.swap(midFrame);
+	std::shared_ptr<RealSenseDataFrame>& frame = bReplaying ? liveFrame : fgFrame;
+	if (frame->number < midFrame->number) {
+		frame.swap(midFrame);
+	}
+	lock.unlock();
+
+	if (bReplaying) {
+		LoadReplayFrame();
+	}
+}
+
+void RealSenseImpl::StartFrameRecording(float durationSeconds, uint64 memoryLimitBytes)
+{
+	frameRecorder.Start(durationSeconds, memoryLimitBytes);
+}
+
+void RealSenseImpl::StopFrameRecording()
+{
+	StopReplay();
+	frameRecorder.Stop();
+}
+
+void RealSenseImpl::StartReplay()
+{
+	if ((bReplaying == false) && frameRecorder.IsRecording()) {
+		liveFrame = fgFrame;
+		bReplaying = true;
+	}
+}
+
+void RealSenseImpl::StopReplay()
+{
+	if (bReplaying) {
+		fgFrame = liveFrame;
+		liveFrame.reset();
+		bReplaying = false;
+	}
+}
+
+// Only the camera images are recorded, so the other outputs of a replayed 
+// frame are the non-image fields and the middleware scan preview of the 
+// latest live frame. Images derived from the camera images (head crop, 
+// upsampled depth and distance field) are left blank rather than copied, 
+// since the live ones would not match the replayed images. The foreground 
+// frame is reused for the next replayed frame unless a snapshot still holds
+// it. Images recorded at another resolution are not loaded, because the 
+// buffers of the session manager have the size of the current resolution.
+void RealSenseImpl::LoadReplayFrame()
+{
+	if (frameRecorder.FetchFrame(replayImages) == false) {
+		return;
+	}
+
+	if ((fgFrame == liveFrame) || (fgFrame.use_count() > 1)) {
+		fgFrame = std::make_shared<RealSenseDataFrame>();
+	}
+	RealSenseDataFrame& frame = *fgFrame;
+	CopyFrameLayout(*liveFrame, frame);
+	frame.number = replayImages.number;
+	frame.arrivalTime = replayImages.timestamp;
+	frame.hostTimestamp = replayImages.timestamp;
+	frame.scanImage = liveFrame->scanImage;
+
+	// The buffers swapped out return to the recorder with the next FetchFrame()
+	if (replayImages.colorImage.Num() == frame.colorImage.Num()) {
+		Swap(frame.colorImage, replayImages.colorImage);
+	}
+	if (replayImages.depthImage.Num() == frame.depthImage.Num()) {
+		Swap(frame.depthImage, replayImages.depthImage);
 	}
 }
 
+// Enables the middleware and initializes the SenseManager on a background 
+// thread. Init() loads the middleware modules, which can take several seconds.
+void RealSenseImpl::PrewarmCamera()
+{
+	if (bCameraThreadRunning || prewarmStatus.valid()) {
+		return;
+	}
+
+	EnableMiddleware();
+	prewarmFeatureSet = GetMiddlewareFeatureSet();
+	prewarmStatus = std::async(std::launch::async, [this]() { return senseManager->Init(); });
+}
+
+// The camera thread takes over the prewarm result once it runs.
+bool RealSenseImpl::IsCameraPrewarmed() const
+{
+	return (bCameraThreadRunning == false) && prewarmStatus.valid() && 
+		   (prewarmStatus.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+}
+
+// Waits for a prewarm in progress and closes the pipeline it initialized, so 
+// that streams and middleware can be enabled again.
+void RealSenseImpl::DiscardPrewarm()
+{
+	if (prewarmStatus.valid()) {
+		prewarmStatus.get();
+		senseManager->Close();
+	}
+}
+
+uint32 RealSenseImpl::GetMiddlewareFeatureSet() const
+{
+	uint32 featureSet = 0;
+	if (bScan3DEnabled) {
+		featureSet |= RealSenseFeature::SCAN_3D;
+	}
+	if (bFaceEnabled) {
+		featureSet |= RealSenseFeature::HEAD_TRACKING;
+	}
+	if (bSeg3DEnabled) {
+		featureSet |= RealSenseFeature::SEGMENTATION_3D;
+	}
+	return featureSet;
+}
+
 void RealSenseImpl::EnableMiddleware()
 {
 	if (bScan3DEnabled) {
@@ -271,21 +730,42 @@ void RealSenseImpl::EnableMiddleware()
 	}
 }
 
+// Returns true if the camera thread runs a pipeline that was initialized 
+// without some of the currently enabled middleware.
+bool RealSenseImpl::IsMiddlewareMissing() const
+{
+	return bCameraThreadRunning && (bSyntheticSource == false) && 
+		   ((GetMiddlewareFeatureSet() & ~cameraFeatureSet) != 0);
+}
+
+// The camera thread uses the middleware handles as soon as the feature flag
+// is set, so a running pipeline that was initialized without the middleware
+// is stopped before the flag is set and started again afterwards.
 void RealSenseImpl::EnableFeature(RealSenseFeature feature)
 {
+	const bool bRestartCamera = bCameraThreadRunning && (bSyntheticSource == false) && 
+								(feature != RealSenseFeature::CAMERA_STREAMING) && ((cameraFeatureSet & feature) == 0);
+	if (bRestartCamera) {
+		StopCamera();
+	}
+
 	switch (feature) {
 	case RealSenseFeature::CAMERA_STREAMING:
 		bCameraStreamingEnabled = true;
-		return;
+		break;
 	case RealSenseFeature::SCAN_3D:
 		bScan3DEnabled = true;
-		return;
+		break;
 	case RealSenseFeature::HEAD_TRACKING:
 		bFaceEnabled = true;
-		return;
+		break;
 	case RealSenseFeature::SEGMENTATION_3D:
 		bSeg3DEnabled = true;
-		return;
+		break;
+	}
+
+	if (bRestartCamera) {
+		StartCamera();
 	}
 }
 
@@ -336,7 +816,21 @@ const FString RealSenseImpl::GetCameraFirmware() const
 // and resizes the colorImage buffer of the RealSenseDataFrames to match.
 void RealSenseImpl::SetColorCameraResolution(EColorResolution resolution) 
 {
-	colorResolution = GetEColorResolutionValue(resolution);
+	// A level attaching to the running pipeline usually requests the 
+	// resolution that is already streaming, which needs no restart.
+	const FStreamResolution requested = GetEColorResolutionValue(resolution);
+	if ((requested.width == colorResolution.width) && (requested.height == colorResolution.height) && 
+		(requested.fps == colorResolution.fps)) {
+		return;
+	}
+
+	const bool bRestartCamera = bCameraThreadRunning;
+	if (bRestartCamera) {
+		StopCamera();
+	}
+	DiscardPrewarm();
+
+	colorResolution = requested;
 
 	status = senseManager->EnableStream(PXCCapture::StreamType::STREAM_TYPE_COLOR, 
 										colorResolution.width, 
@@ -350,13 +844,29 @@ void RealSenseImpl::SetColorCameraResolution(EColorResolution resolution)
 	bgFrame->colorImage.SetNumZeroed(colorImageSize);
 	midFrame->colorImage.SetNumZeroed(colorImageSize);
 	fgFrame->colorImage.SetNumZeroed(colorImageSize);
+
+	if (bRestartCamera) {
+		StartCamera();
+	}
 }
 
 // Enables the depth camera stream of the SenseManager using the specified resolution
 // and resizes the depthImage buffer of the RealSenseDataFrames to match.
 void RealSenseImpl::SetDepthCameraResolution(EDepthResolution resolution)
 {
-	depthResolution = GetEDepthResolutionValue(resolution);
+	const FStreamResolution requested = GetEDepthResolutionValue(resolution);
+	if ((requested.width == depthResolution.width) && (requested.height == depthResolution.height) && 
+		(requested.fps == depthResolution.fps)) {
+		return;
+	}
+
+	const bool bRestartCamera = bCameraThreadRunning;
+	if (bRestartCamera) {
+		StopCamera();
+	}
+	DiscardPrewarm();
+
+	depthResolution = requested;
 	status = senseManager->EnableStream(PXCCapture::StreamType::STREAM_TYPE_DEPTH, 
 										depthResolution.width, 
 										depthResolution.height, 
@@ -370,6 +880,10 @@ void RealSenseImpl::SetDepthCameraResolution(EDepthResolution resolution)
 		midFrame->depthImage.SetNumZeroed(depthImageSize);
 		fgFrame->depthImage.SetNumZeroed(depthImageSize);
 	}
+
+	if (bRestartCamera) {
+		StartCamera();
+	}
 }
 
 // Creates a StreamProfile for the specified color and depth resolutions and
@@ -486,11 +1000,330 @@ void RealSenseImpl::UpdateScan3DImageSize(PXCImage::ImageInfo info)
 	scan3DResolution.width = info.width;
 	scan3DResolution.height = info.height;
 
+	// Only the background frame belongs to the camera thread. The other frames
+	// may be read by the game thread or held by snapshots, so they are resized
+	// when they come back as the background frame.
 	const uint8 bytesPerPixel = 4;
 	const uint32 scanImageSize = scan3DResolution.width * scan3DResolution.height * bytesPerPixel;
 	bgFrame->scanImage.SetNumZeroed(scanImageSize);
-	midFrame->scanImage.SetNumZeroed(scanImageSize);
-	fgFrame->scanImage.SetNumZeroed(scanImageSize);
 
 	bScan3DImageSizeChanged = true;
 }
+
+// Sets the size of the head-centered crop of the color image and resizes the
+// headCropImage buffer of the RealSenseDataFrames to match. The smoothing 
+// factor (0 - 1) controls how slowly the crop window follows the head. The 
+// buffers are used by the camera thread, so a running camera is restarted 
+// when they have to be resized.
+void RealSenseImpl::EnableHeadCrop(int32 width, int32 height, float smoothing)
+{
+	headCropSmoothing = FMath::Clamp(smoothing, 0.0f, 0.99f);
+
+	if ((width == headCropResolution.width) && (height == headCropResolution.height)) {
+		bHeadCropEnabled = true;
+		return;
+	}
+
+	const bool bRestartCamera = bCameraThreadRunning;
+	if (bRestartCamera) {
+		StopCamera();
+	}
+
+	headCropResolution = { width, height, colorResolution.fps, ERealSensePixelFormat::COLOR_RGB32 };
+	bHeadCropTracking = false;
+
+	const uint8 bytesPerPixel = 4;
+	const uint32 headCropImageSize = width * height * bytesPerPixel;
+	bgFrame->headCropImage.SetNumZeroed(headCropImageSize);
+	midFrame->headCropImage.SetNumZeroed(headCropImageSize);
+	fgFrame->headCropImage.SetNumZeroed(headCropImageSize);
+
+	bHeadCropEnabled = true;
+
+	if (bRestartCamera) {
+		StartCamera();
+	}
+}
+
+void RealSenseImpl::DisableHeadCrop()
+{
+	bHeadCropEnabled = false;
+}
+
+// Replaces the head pose ring with an empty one of the given capacity. The
+// camera processing thread picks up the new ring with its next frame.
+void RealSenseImpl::EnableHeadPoseQueue(uint32 capacity)
+{
+	std::atomic_store(&headPoseQueue, std::make_shared<HeadPoseQueue>(capacity));
+}
+
+void RealSenseImpl::DisableHeadPoseQueue()
+{
+	std::atomic_store(&headPoseQueue, std::shared_ptr<HeadPoseQueue>());
+}
+
+uint32 RealSenseImpl::DrainHeadPoseSamples(TArray<FHeadPoseSample>& samples)
+{
+	std::shared_ptr<HeadPoseQueue> queue = std::atomic_load(&headPoseQueue);
+	return queue ? queue->Drain(samples) : 0;
+}
+
+uint32 RealSenseImpl::GetDroppedHeadPoseSamples() const
+{
+	std::shared_ptr<HeadPoseQueue> queue = std::atomic_load(&headPoseQueue);
+	return queue ? queue->GetDroppedCount() : 0;
+}
+
+// Projects the tracked head center from camera space into color image space
+// and eases the crop window towards it. The height of the window is taken from
+// the projected size of the head, so the crop zooms in as the user moves away.
+// Until a head has been found, the crop covers the center of the color image.
+// The window is then resampled into the fixed-size headCropImage buffer.
+void RealSenseImpl::UpdateHeadCrop()
+{
+	const float colorWidth = static_cast<float>(colorResolution.width);
+	const float colorHeight = static_cast<float>(colorResolution.height);
+	if ((colorResolution.width == 0) || (headCropResolution.width == 0) || (headCropResolution.height == 0)) {
+		return;
+	}
+
+	if (bHeadCropTracking == false) {
+		headCropCenter = FVector2D(colorWidth * 0.5f, colorHeight * 0.5f);
+		headCropHeight = colorHeight;
+	}
+
+	if (bFaceEnabled && (bgFrame->headCount > 0) && projection) {
+		// Half of the window height in millimeters, which leaves some room
+		// for the shoulders below the head center.
+		const float headExtent = 200.0f;
+
+		const FVector& head = bgFrame->headPosition;
+		PXCPoint3DF32 points[2] = { { head.X, head.Y, head.Z }, { head.X, head.Y + headExtent, head.Z } };
+		PXCPointF32 pixels[2] = {};
+
+		if ((projection->ProjectCameraToColor(2, points, pixels) >= PXC_STATUS_NO_ERROR) && 
+			(pixels[0].x >= 0.0f) && (pixels[1].x >= 0.0f)) {
+			const FVector2D targetCenter(pixels[0].x, pixels[0].y);
+			const float targetHeight = 2.0f * FMath::Abs(pixels[1].y - pixels[0].y);
+
+			if (bHeadCropTracking) {
+				const float alpha = 1.0f - headCropSmoothing;
+				headCropCenter += (targetCenter - headCropCenter) * alpha;
+				headCropHeight += (targetHeight - headCropHeight) * alpha;
+			}
+			else {
+				headCropCenter = targetCenter;
+				headCropHeight = targetHeight;
+				bHeadCropTracking = true;
+			}
+		}
+	}
+
+	// Keep the window inside the color image while preserving the aspect
+	// ratio of the output.
+	const float aspect = static_cast<float>(headCropResolution.width) / headCropResolution.height;
+	float cropHeight = FMath::Clamp(headCropHeight, static_cast<float>(headCropResolution.height) * 0.25f, colorHeight);
+	float cropWidth = cropHeight * aspect;
+	if (cropWidth > colorWidth) {
+		cropWidth = colorWidth;
+		cropHeight = cropWidth / aspect;
+	}
+
+	const float x0 = FMath::Clamp(headCropCenter.X - cropWidth * 0.5f, 0.0f, colorWidth - cropWidth);
+	const float y0 = FMath::Clamp(headCropCenter.Y - cropHeight * 0.5f, 0.0f, colorHeight - cropHeight);
+
+	CropAndScaleImage(bgFrame->colorImage, colorResolution.width, colorResolution.height,
+					  x0, y0, cropWidth, cropHeight,
+					  bgFrame->headCropImage, headCropResolution.width, headCropResolution.height);
+}
+
+// Sets the output resolution of the depth upsampling as a fraction of the 
+// color camera resolution and resizes the upsampledDepthImage buffer of the 
+// RealSenseDataFrames to match. A running camera is restarted when the 
+// buffers have to be resized.
+void RealSenseImpl::EnableDepthUpsampling(EDepthUpsampleScale scale)
+{
+	const int32 divisor = (scale == EDepthUpsampleScale::HALF) ? 2 : 1;
+	const int32 width = colorResolution.width / divisor;
+	const int32 height = colorResolution.height / divisor;
+
+	if ((width == upsampledDepthResolution.width) && (height == upsampledDepthResolution.height)) {
+		bDepthUpsampleEnabled = (width * height > 0);
+		return;
+	}
+
+	const bool bRestartCamera = bCameraThreadRunning;
+	if (bRestartCamera) {
+		StopCamera();
+	}
+
+	upsampledDepthResolution = { width, height, depthResolution.fps, ERealSensePixelFormat::DEPTH_G16_MM };
+
+	const uint32 upsampledDepthImageSize = upsampledDepthResolution.width * upsampledDepthResolution.height;
+	bgFrame->upsampledDepthImage.SetNumZeroed(upsampledDepthImageSize);
+	midFrame->upsampledDepthImage.SetNumZeroed(upsampledDepthImageSize);
+	fgFrame->upsampledDepthImage.SetNumZeroed(upsampledDepthImageSize);
+
+	bDepthUpsampleEnabled = (upsampledDepthImageSize > 0);
+
+	if (bRestartCamera) {
+		StartCamera();
+	}
+}
+
+void RealSenseImpl::DisableDepthUpsampling()
+{
+	bDepthUpsampleEnabled = false;
+}
+
+// Configures the distance field generator and resizes the distanceFieldImage
+// buffer of the RealSenseDataFrames to match. The 3D segmentation source reads
+// the alpha channel of the segmented color image, the depth threshold source
+// reads the depth image, so the corresponding stream must be enabled. The 
+// generator and the buffers are used by the camera thread, so a running 
+// camera is restarted unless the configuration is unchanged.
+void RealSenseImpl::EnableDistanceField(EDistanceFieldSource source, int32 width, int32 height,
+										EDistanceFieldFormat format, float maxDistance)
+{
+	if ((source == distanceFieldSource) && (width == distanceFieldResolution.width) && 
+		(height == distanceFieldResolution.height) && (format == distanceFieldFormat) && 
+		(maxDistance == distanceFieldMaxDistance)) {
+		bDistanceFieldEnabled = (width * height > 0);
+		return;
+	}
+
+	const bool bRestartCamera = bCameraThreadRunning;
+	if (bRestartCamera) {
+		StopCamera();
+	}
+
+	distanceFieldSource = source;
+	distanceFieldFormat = format;
+	distanceFieldMaxDistance = maxDistance;
+	distanceFieldResolution = { width, height, 
+								(source == EDistanceFieldSource::SEGMENTATION_3D) ? colorResolution.fps : depthResolution.fps, 
+								ERealSensePixelFormat::PIXEL_FORMAT_ANY };
+
+	distanceFieldGenerator.Configure(width, height, format, maxDistance);
+
+	const uint32 distanceFieldImageSize = width * height * distanceFieldGenerator.GetBytesPerPixel();
+	bgFrame->distanceFieldImage.SetNumZeroed(distanceFieldImageSize);
+	midFrame->distanceFieldImage.SetNumZeroed(distanceFieldImageSize);
+	fgFrame->distanceFieldImage.SetNumZeroed(distanceFieldImageSize);
+
+	bDistanceFieldEnabled = (distanceFieldImageSize > 0);
+
+	if (bRestartCamera) {
+		StartCamera();
+	}
+}
+
+void RealSenseImpl::DisableDistanceField()
+{
+	bDistanceFieldEnabled = false;
+}
+
+// Sets the range of depth values (in millimeters) treated as foreground by
+// the depth threshold source.
+void RealSenseImpl::SetDistanceFieldDepthRange(int32 nearDepth, int32 farDepth)
+{
+	distanceFieldNearDepth = static_cast<uint16>(FMath::Clamp(nearDepth, 1, 65535));
+	distanceFieldFarDepth = static_cast<uint16>(FMath::Clamp(farDepth, 1, 65535));
+}
+
+// Replaces the trigger volumes tested against the depth stream. The camera
+// thread rebuilds its bounding volume hierarchy before the next frame.
+void RealSenseImpl::SetTriggerVolumes(const TArray<TriggerVolume>& volumes)
+{
+	std::unique_lock<std::mutex> lock(triggerVolumeMutex);
+	pendingTriggerVolumes = volumes;
+	bTriggerVolumesChanged = true;
+}
+
+// Sets the world transform of the depth camera used to place the depth 
+// points relative to the trigger volumes.
+void RealSenseImpl::SetCameraTransform(const FTransform& transform)
+{
+	std::unique_lock<std::mutex> lock(triggerVolumeMutex);
+	cameraTransform = transform;
+}
+
+// Sets the spacing (in pixels) of the depth points tested against the 
+// trigger volumes. A stride of 2 tests a quarter of the depth image.
+void RealSenseImpl::SetTriggerVolumeStride(int32 stride)
+{
+	triggerVolumeStride = static_cast<uint32>(FMath::Clamp(stride, 1, 16));
+}
+
+// Requests a new reference surface averaged from the next numFrames depth 
+// images, at most TouchDetector::MaxCalibrationFrames. The surface should be
+// empty while it is calibrated.
+void RealSenseImpl::StartTouchCalibration(int32 numFrames)
+{
+	std::unique_lock<std::mutex> lockCalibration(touchCalibrationMutex);
+	touchCalibrationFrames = static_cast<uint32>(FMath::Clamp(numFrames, 1, static_cast<int32>(TouchDetector::MaxCalibrationFrames)));
+	bTouchCalibrated = false;
+}
+
+// Sets the height band (in millimeters above the reference surface) of 
+// touching pixels and the range of blob areas (in pixels) reported as touches.
+void RealSenseImpl::EnableTouchDetection(int32 minHeight, int32 maxHeight, int32 minArea, int32 maxArea)
+{
+	touchMinHeight = static_cast<uint16>(FMath::Clamp(minHeight, 1, 65535));
+	touchMaxHeight = static_cast<uint16>(FMath::Clamp(maxHeight, minHeight, 65535));
+	touchMinArea = static_cast<uint32>(FMath::Max(minArea, 1));
+	touchMaxArea = static_cast<uint32>(FMath::Max(maxArea, minArea));
+	bTouchDetectionEnabled = true;
+}
+
+void RealSenseImpl::DisableTouchDetection()
+{
+	bTouchDetectionEnabled = false;
+}
+
+void RealSenseImpl::EnableBodyBounds()
+{
+	bBodyBoundsEnabled = true;
+}
+
+void RealSenseImpl::DisableBodyBounds()
+{
+	bBodyBoundsEnabled = false;
+}
+
+// Sets the world-space floor plane, with its normal pointing up, that body 
+// points must lie above and that head heights are measured from.
+void RealSenseImpl::SetFloorPlane(const FPlane& plane)
+{
+	std::unique_lock<std::mutex> lockFloorPlane(floorPlaneMutex);
+	floorPlane = plane;
+	bFloorPlaneSet = true;
+}
+
+void RealSenseImpl::ClearFloorPlane()
+{
+	std::unique_lock<std::mutex> lockFloorPlane(floorPlaneMutex);
+	bFloorPlaneSet = false;
+}
+
+// Records the sensor timestamp of the acquired frame together with the host
+// time of its arrival, and maps the timestamp to host time with the clock 
+// fit of the recent frames. Frames without a timestamp keep their arrival time.
+void RealSenseImpl::UpdateFrameTimestamp()
+{
+	bgFrame->arrivalTime = FPlatformTime::Seconds();
+	bgFrame->hostTimestamp = bgFrame->arrivalTime;
+	bgFrame->timestampUncertainty = -1.0;
+
+	PXCCapture::Sample* sample = senseManager->QuerySample();
+	PXCImage* image = sample ? (sample->depth ? sample->depth : sample->color) : nullptr;
+	if (image == nullptr) {
+		return;
+	}
+
+	bgFrame->sensorTimestamp = image->QueryTimeStamp();
+	clockSynchronizer.AddSample(bgFrame->sensorTimestamp, bgFrame->arrivalTime);
+	bgFrame->hostTimestamp = clockSynchronizer.SensorToHost(bgFrame->sensorTimestamp);
+	bgFrame->timestampUncertainty = clockSynchronizer.GetUncertainty();
+	clockDriftPPM = clockSynchronizer.GetDriftPPM();
+}
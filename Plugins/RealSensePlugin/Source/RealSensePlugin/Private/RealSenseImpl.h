@@ -17,6 +17,7 @@
 
 #include "AllowWindowsPlatformTypes.h"
 #include <future>
+#include <condition_variable>
 #include <assert.h>
 #include "HideWindowsPlatformTypes.h"
 
@@ -24,7 +25,17 @@
 #include "RealSenseTypes.h"
 #include "RealSenseUtils.h"
 #include "RealSenseBlueprintLibrary.h"
+#include "DepthQualityEstimator.h"
+#include "DepthUpsampler.h"
+#include "DistanceFieldGenerator.h"
+#include "TriggerVolumeTester.h"
+#include "TouchDetector.h"
+#include "BodyBoundsEstimator.h"
+#include "ClockSynchronizer.h"
+#include "FrameRecorder.h"
+#include "HeadPoseQueue.h"
 #include "PXCSenseManager.h"
+#include "pxcprojection.h"
 
 // Stores all relevant data computed from one frame of RealSense camera data.
 // Advice: Use this structure in a multiple-buffer configuration to share 
@@ -34,17 +45,32 @@
 //             Swap background_frame with mid_frame
 //   Thread 2: Swap mid_frame with foreground_frame
 //             Read data from foreground_frame
+// Frames are reference counted so that snapshots of the foreground frame can 
+// outlive the swap. Thread 1 replaces a background frame that is still 
+// referenced by a snapshot instead of overwriting it.
 struct RealSenseDataFrame {
 	uint64 number;  // Stores an ID for the frame based on its occurrence in time
+	int64 sensorTimestamp;  // Timestamp of the frame in the sensor clock (in 100 ns units)
+	double arrivalTime;  // Host time (FPlatformTime::Seconds()) at which the frame was acquired
+	double hostTimestamp;  // Sensor timestamp mapped to host time
+	double timestampUncertainty;  // Standard deviation (in seconds) of hostTimestamp, negative if unknown
 	TArray<uint8> colorImage;  // Container for the camera's raw color stream data
 	TArray<uint16> depthImage;  // Container for the camera's raw depth stream data
 	TArray<uint8> scanImage;  // Container for the scan preview image provided by the 3DScan middleware
+	TArray<uint8> headCropImage;  // Container for the head-centered crop of the color image
+	FDepthQualityMetrics depthQuality;  // Quality metrics computed from depthImage
+	TArray<uint16> upsampledDepthImage;  // Container for the depth image upsampled to color resolution
+	TArray<uint8> distanceFieldImage;  // Container for the signed distance field of the foreground mask
+	TArray<FIntPoint> triggerOccupancy;  // Id and point count of every occupied trigger volume
+	TArray<FTouchPoint> touchPoints;  // Fingertips touching the calibrated surface
+	FBodyBounds bodyBounds;  // Bounds of the person closest to the depth camera
 
 	int headCount;
 	FVector headPosition;
 	FRotator headRotation;
 
-	RealSenseDataFrame() : number(0), headCount(0) {}
+	RealSenseDataFrame() : number(0), sensorTimestamp(0), arrivalTime(0.0), hostTimestamp(0.0), 
+						   timestampUncertainty(-1.0), headCount(0) {}
 };
 
 // Implements the functionality of the Intel(R) RealSense(TM) SDK and associated
@@ -75,8 +101,56 @@ public:
 	// foreground frame.
 	void SwapFrames();
 
+	// Returns a reference to the foreground frame that stays valid and 
+	// unchanged after later calls to SwapFrames().
+	inline std::shared_ptr<const RealSenseDataFrame> GetFrameSnapshot() const { return fgFrame; }
+
+	inline uint64 GetFrameNumber() const { return fgFrame->number; }
+
 	inline bool IsCameraThreadRunning() const { return bCameraThreadRunning; }
 
+	// Initializes the pipeline with the enabled middleware on a background 
+	// thread, so that a later StartCamera() does not wait for it.
+	void PrewarmCamera();
+
+	bool IsCameraPrewarmed() const;
+
+	// While throttled, the camera processing loop acquires at most fps frames
+	// per second, or no frames at all if fps is 0.
+	void SetCaptureThrottled(bool bThrottled, float fps);
+
+	inline bool IsCaptureThrottled() const { return bCaptureThrottled; }
+
+	// Replaces the camera with a source that writes a latency stamp (see 
+	// LatencyProbe.h) into color images of the color camera resolution at 
+	// the given rate. A running camera is restarted with the new source.
+	void SetSyntheticSource(bool bEnabled, float fps);
+
+	inline bool IsSyntheticSource() const { return bSyntheticSource; }
+
+	// Frame Recording Support
+
+	void StartFrameRecording(float durationSeconds, uint64 memoryLimitBytes);
+
+	void StopFrameRecording();
+
+	inline bool IsFrameRecording() const { return frameRecorder.IsRecording(); }
+
+	inline bool GetRecordedRange(double& oldest, double& newest) const { return frameRecorder.GetRecordedRange(oldest, newest); }
+
+	// While replaying, SwapFrames() loads recorded frames into the foreground 
+	// frame instead of the latest processed frame. Capturing and recording 
+	// continue in the background.
+	void StartReplay();
+
+	void StopReplay();
+
+	inline bool IsReplaying() const { return bReplaying; }
+
+	// Selects the recorded frame that SwapFrames() loads next. The frame is 
+	// decoded asynchronously, so it may only be loaded by a later call.
+	inline void SetReplayTime(double timestamp) { frameRecorder.RequestFrame(timestamp); }
+
 	// Core SDK Support
 
 	void EnableMiddleware();
@@ -121,6 +195,91 @@ public:
 
 	inline const uint16* GetDepthBuffer() const { return fgFrame->depthImage.GetData(); }
 
+	inline FDepthQualityMetrics GetDepthQuality() const { return fgFrame->depthQuality; }
+
+	// Frame Timing Support
+
+	inline int64 GetFrameSensorTimestamp() const { return fgFrame->sensorTimestamp; }
+
+	inline double GetFrameArrivalTime() const { return fgFrame->arrivalTime; }
+
+	inline double GetFrameTimestamp() const { return fgFrame->hostTimestamp; }
+
+	inline double GetFrameTimestampUncertainty() const { return fgFrame->timestampUncertainty; }
+
+	inline double GetClockDriftPPM() const { return clockDriftPPM; }
+
+	void EnableDepthUpsampling(EDepthUpsampleScale scale);
+
+	void DisableDepthUpsampling();
+
+	inline bool IsDepthUpsamplingEnabled() const { return bDepthUpsampleEnabled; }
+
+	inline FStreamResolution GetUpsampledDepthResolution() const { return upsampledDepthResolution; }
+
+	inline int32 GetUpsampledDepthImageWidth() const { return upsampledDepthResolution.width; }
+
+	inline int32 GetUpsampledDepthImageHeight() const { return upsampledDepthResolution.height; }
+
+	inline const uint16* GetUpsampledDepthBuffer() const { return fgFrame->upsampledDepthImage.GetData(); }
+
+	inline float GetDepthUpsampleMilliseconds() const { return depthUpsampleMilliseconds; }
+
+	// Distance Field Support
+
+	void EnableDistanceField(EDistanceFieldSource source, int32 width, int32 height, 
+							 EDistanceFieldFormat format, float maxDistance);
+
+	void DisableDistanceField();
+
+	void SetDistanceFieldDepthRange(int32 nearDepth, int32 farDepth);
+
+	inline bool IsDistanceFieldEnabled() const { return bDistanceFieldEnabled; }
+
+	inline FStreamResolution GetDistanceFieldResolution() const { return distanceFieldResolution; }
+
+	inline uint32 GetDistanceFieldBytesPerPixel() const { return distanceFieldGenerator.GetBytesPerPixel(); }
+
+	inline const uint8* GetDistanceFieldBuffer() const { return fgFrame->distanceFieldImage.GetData(); }
+
+	// Trigger Volume Support
+
+	void SetTriggerVolumes(const TArray<TriggerVolume>& volumes);
+
+	void SetCameraTransform(const FTransform& transform);
+
+	void SetTriggerVolumeStride(int32 stride);
+
+	inline const TArray<FIntPoint>& GetTriggerOccupancy() const { return fgFrame->triggerOccupancy; }
+
+	// Touch Detection Support
+
+	void StartTouchCalibration(int32 numFrames);
+
+	void EnableTouchDetection(int32 minHeight, int32 maxHeight, int32 minArea, int32 maxArea);
+
+	void DisableTouchDetection();
+
+	inline bool IsTouchDetectionEnabled() const { return bTouchDetectionEnabled; }
+
+	inline bool IsTouchCalibrated() const { return bTouchCalibrated; }
+
+	inline const TArray<FTouchPoint>& GetTouchPoints() const { return fgFrame->touchPoints; }
+
+	// Body Bounds Support
+
+	void EnableBodyBounds();
+
+	void DisableBodyBounds();
+
+	inline bool IsBodyBoundsEnabled() const { return bBodyBoundsEnabled; }
+
+	void SetFloorPlane(const FPlane& plane);
+
+	void ClearFloorPlane();
+
+	inline const FBodyBounds& GetBodyBounds() const { return fgFrame->bodyBounds; }
+
 	// 3D Scanning Module Support 
 
 	void ConfigureScanning(EScan3DMode scanningMode, bool bSolidify, bool bTexture);
@@ -143,17 +302,43 @@ public:
 
 	inline const uint8* GetScanBuffer() const { return fgFrame->scanImage.GetData(); }
 
+	inline uint32 GetScanBufferSize() const { return fgFrame->scanImage.Num(); }
+
 	inline bool HasScan3DImageSizeChanged() const { return bScan3DImageSizeChanged; }
 
 	inline bool HasScanCompleted() const { return bScanCompleted; }
 
 	// Head Tracking Support
 
-	inline int GetHeadCount() const { return bgFrame->headCount; }
+	inline int GetHeadCount() const { return fgFrame->headCount; }
+
+	inline FVector GetHeadPosition() const { return fgFrame->headPosition; }
+
+	inline FRotator GetHeadRotation() const { return fgFrame->headRotation; }
+
+	void EnableHeadCrop(int32 width, int32 height, float smoothing);
+
+	void DisableHeadCrop();
+
+	inline bool IsHeadCropEnabled() const { return bHeadCropEnabled; }
+
+	inline FStreamResolution GetHeadCropResolution() const { return headCropResolution; }
+
+	inline int32 GetHeadCropImageWidth() const { return headCropResolution.width; }
 
-	inline FVector GetHeadPosition() const { return bgFrame->headPosition; }
+	inline int32 GetHeadCropImageHeight() const { return headCropResolution.height; }
 
-	inline FRotator GetHeadRotation() const { return bgFrame->headRotation; }
+	inline const uint8* GetHeadCropBuffer() const { return fgFrame->headCropImage.GetData(); }
+
+	void EnableHeadPoseQueue(uint32 capacity);
+
+	void DisableHeadPoseQueue();
+
+	inline bool IsHeadPoseQueueEnabled() const { return std::atomic_load(&headPoseQueue) != nullptr; }
+
+	uint32 DrainHeadPoseSamples(TArray<FHeadPoseSample>& samples);
+
+	uint32 GetDroppedHeadPoseSamples() const;
 
 private:
 	// Core SDK handles
@@ -166,12 +351,14 @@ private:
 		void operator()(PXC3DScan* sc) { ; }
 		void operator()(PXCFaceModule* sc) { ; }
 		void operator()(PXC3DSeg* s) { ; }
+		void operator()(PXCProjection* p) { p->Release(); }
 	};
 
 	std::unique_ptr<PXCSession, RealSenseDeleter> session;
 	std::unique_ptr<PXCSenseManager, RealSenseDeleter> senseManager;
 	std::unique_ptr<PXCCapture, RealSenseDeleter> capture;
 	std::unique_ptr<PXCCapture::Device, RealSenseDeleter> device;
+	std::unique_ptr<PXCProjection, RealSenseDeleter> projection;
 
 	PXCCapture::DeviceInfo deviceInfo;
 	pxcStatus status;  // Status ID used by RSSDK functions
@@ -195,13 +382,99 @@ private:
 	std::thread cameraThread;
 	std::atomic_bool bCameraThreadRunning;
 
-	std::unique_ptr<RealSenseDataFrame> fgFrame;
-	std::unique_ptr<RealSenseDataFrame> midFrame;
-	std::unique_ptr<RealSenseDataFrame> bgFrame;
+	// Result of a SenseManager Init() running in the background, valid until 
+	// it is used by the camera thread or discarded
+	std::future<pxcStatus> prewarmStatus;
+	uint32 prewarmFeatureSet;  // Middleware enabled when the prewarm started
+	uint32 cameraFeatureSet;  // Middleware the running pipeline was initialized with
+
+	// Stand-in camera source for latency measurements
+	std::atomic_bool bSyntheticSource;
+	std::atomic<float> syntheticFPS;
+
+	std::shared_ptr<RealSenseDataFrame> fgFrame;
+	std::shared_ptr<RealSenseDataFrame> midFrame;
+	std::shared_ptr<RealSenseDataFrame> bgFrame;
 
 	// Mutex for locking access to the midFrame
 	std::mutex midFrameMutex;
 
+	// Frame Recording members
+
+	FrameRecorder frameRecorder;
+	bool bReplaying;
+	std::shared_ptr<RealSenseDataFrame> liveFrame;  // Takes the place of the fgFrame during replays
+	RecordedFrame replayImages;
+
+	// Mutex and condition variable for waking the throttled camera thread
+	std::mutex throttleMutex;
+	std::condition_variable throttleCondition;
+	std::atomic_bool bCaptureThrottled;
+	std::atomic<float> keepAliveFPS;
+
+	DepthQualityEstimator depthQualityEstimator;
+
+	// Maps sensor timestamps to host time, only touched by the camera thread
+	ClockSynchronizer clockSynchronizer;
+	std::atomic<double> clockDriftPPM;
+
+	// Depth Upsampling members
+
+	DepthUpsampler depthUpsampler;
+	FStreamResolution upsampledDepthResolution;
+	std::atomic_bool bDepthUpsampleEnabled;
+	std::atomic<float> depthUpsampleMilliseconds;
+	TArray<PXCPointF32> depthUVMap;
+
+	// Distance Field members
+
+	DistanceFieldGenerator distanceFieldGenerator;
+	FStreamResolution distanceFieldResolution;
+	EDistanceFieldSource distanceFieldSource;
+	EDistanceFieldFormat distanceFieldFormat;
+	float distanceFieldMaxDistance;
+	std::atomic_bool bDistanceFieldEnabled;
+	std::atomic<uint16> distanceFieldNearDepth;
+	std::atomic<uint16> distanceFieldFarDepth;
+
+	// Trigger Volume members
+
+	TriggerVolumeTester triggerVolumeTester;
+	std::atomic<uint32> triggerVolumeStride;
+
+	// Mutex for locking access to the volumes and the camera transform, 
+	// which are set by the game thread and read by the camera thread
+	std::mutex triggerVolumeMutex;
+	TArray<TriggerVolume> pendingTriggerVolumes;
+	bool bTriggerVolumesChanged;
+	FTransform cameraTransform;
+
+	// Touch Detection members
+
+	TouchDetector touchDetector;
+	std::atomic_bool bTouchDetectionEnabled;
+	std::atomic_bool bTouchCalibrated;
+	std::atomic<uint32> touchCalibrationFrames;  // Frames of a requested calibration, or 0
+
+	// Orders a calibration request against the camera thread publishing the
+	// calibrated state, so that a stale calibration is never reported
+	std::mutex touchCalibrationMutex;
+	std::atomic<uint16> touchMinHeight;
+	std::atomic<uint16> touchMaxHeight;
+	std::atomic<uint32> touchMinArea;
+	std::atomic<uint32> touchMaxArea;
+
+	// Body Bounds members
+
+	BodyBoundsEstimator bodyBoundsEstimator;
+	std::atomic_bool bBodyBoundsEnabled;
+
+	// Mutex for locking access to the floor plane, which is set by the game 
+	// thread and read by the camera thread
+	std::mutex floorPlaneMutex;
+	FPlane floorPlane;
+	bool bFloorPlaneSet;
+
 	// Core SDK members
 
 	FStreamResolution colorResolution;
@@ -230,7 +503,45 @@ private:
 	PXCFaceConfiguration* faceConfig;
 	PXCFaceData* faceData;
 
+	// Head Crop members
+
+	FStreamResolution headCropResolution;
+	std::atomic_bool bHeadCropEnabled;
+	std::atomic<float> headCropSmoothing;
+
+	// Smoothed crop window in color image coordinates, only touched by the
+	// camera processing thread.
+	FVector2D headCropCenter;
+	float headCropHeight;
+	bool bHeadCropTracking;
+
+	// Head Pose Queue members
+
+	// Ring of the head poses of every processed frame, filled by the camera
+	// processing thread and drained by the game thread. The pointer itself is
+	// only accessed through std::atomic_load() and std::atomic_store(), so 
+	// the ring can be replaced while the camera is running.
+	std::shared_ptr<HeadPoseQueue> headPoseQueue;
+
 	// Helper Functions
 
 	void UpdateScan3DImageSize(PXCImage::ImageInfo info);
+
+	void UpdateHeadCrop();
+
+	void UpdateFrameTimestamp();
+
+	void WaitWhileThrottled(double lastAcquireTime);
+
+	void LoadReplayFrame();
+
+	void SyntheticCameraThread();
+
+	void ReleaseHeldBackgroundFrame();
+
+	void DiscardPrewarm();
+
+	uint32 GetMiddlewareFeatureSet() const;
+
+	bool IsMiddlewareMissing() const;
 };
@@ -0,0 +1,135 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "RealSenseLatencyCommandlet.h"
+#include "RealSenseImpl.h"
+#include "LatencyProbe.h"
+
+URealSenseLatencyCommandlet::URealSenseLatencyCommandlet(const class FObjectInitializer& ObjInit)
+	: Super(ObjInit)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+// Every configuration restarts the stand-in source, so that frames of the 
+// previous configuration cannot be picked up.
+int32 URealSenseLatencyCommandlet::Main(const FString& Params)
+{
+	int32 Frames = 300;
+	float FPS = 30.0f;
+	float TickRate = 60.0f;
+	FString OutputFilename;
+	FParse::Value(*Params, TEXT("Frames="), Frames);
+	FParse::Value(*Params, TEXT("FPS="), FPS);
+	FParse::Value(*Params, TEXT("TickRate="), TickRate);
+	if (FParse::Value(*Params, TEXT("Output="), OutputFilename) && FPaths::IsRelative(OutputFilename)) {
+		OutputFilename = FPaths::GameSavedDir() / OutputFilename;
+	}
+	Frames = FMath::Max(Frames, 1);
+	FPS = FMath::Max(FPS, 1.0f);
+	TickRate = FMath::Max(TickRate, 1.0f);
+
+	const EColorResolution Resolutions[] = { EColorResolution::RES4, EColorResolution::RES2, EColorResolution::RES1 };
+	const ETextureCompression Compressions[] = { ETextureCompression::NONE, ETextureCompression::FAST, 
+												 ETextureCompression::HIGH_QUALITY };
+	const TCHAR* CompressionNames[] = { TEXT("Uncompressed"), TEXT("BC1 fast"), TEXT("BC1 high quality") };
+
+	std::shared_ptr<RealSenseImpl> Impl = IRealSensePlugin::Get().GetCaptureService();
+	Impl->StopCamera();
+	Impl->EnableFeature(RealSenseFeature::CAMERA_STREAMING);
+	Impl->SetSyntheticSource(true, FPS);
+
+	RS_LOG(Display, "Latency of %d frames per configuration, %s build, %s RHI, camera at %.1f fps, ticks at %.1f Hz", 
+		   Frames, EBuildConfigurations::ToString(FApp::GetBuildConfiguration()), GDynamicRHI ? GDynamicRHI->GetName() : TEXT("no"), 
+		   FPS, TickRate);
+
+	FString CSV = TEXT("Resolution,Compression,Stage,Frames,Min,Mean,P50,P90,P99,Max,ReadBack\n");
+	for (EColorResolution Resolution : Resolutions) {
+		Impl->SetColorCameraResolution(Resolution);
+		const int32 Width = Impl->GetColorImageWidth();
+		const int32 Height = Impl->GetColorImageHeight();
+
+		TArray<FSimpleColor> ColorBuffer;
+		ColorBuffer.SetNumUninitialized(Width * Height);
+		uint8* ColorPixels = reinterpret_cast<uint8*>(ColorBuffer.GetData());
+
+		for (int32 c = 0; c < ARRAY_COUNT(Compressions); ++c) {
+			UTexture2D* ColorTexture = UTexture2D::CreateTransient(Width, Height, 
+				(Compressions[c] == ETextureCompression::NONE) ? PF_B8G8R8A8 : PF_DXT1);
+			ColorTexture->AddToRoot();
+			ColorTexture->UpdateResource();
+
+			std::shared_ptr<LatencyProbe> Probe = std::make_shared<LatencyProbe>();
+			Impl->StartCamera();
+
+			// Stops early if the source delivers fewer frames than expected
+			const double EndTime = FPlatformTime::Seconds() + 2.0 * Frames / FPS + 5.0;
+			double NextTickTime = FPlatformTime::Seconds();
+			int32 PickedUp = 0;
+			while ((PickedUp < Frames) && (FPlatformTime::Seconds() < EndTime)) {
+				NextTickTime += 1.0 / TickRate;
+				const double WaitSeconds = NextTickTime - FPlatformTime::Seconds();
+				if (WaitSeconds > 0.0) {
+					FPlatformProcess::Sleep(static_cast<float>(WaitSeconds));
+				}
+
+				// The steps of ARealSenseSessionManager::Tick() and UCameraStreamComponent::UpdateTextures()
+				Impl->SwapFrames();
+				FMemory::Memcpy(ColorPixels, Impl->GetColorBuffer(), Width * Height * 4);
+				if (Probe->RecordPickup(ColorPixels, Width, Height)) {
+					PickedUp++;
+				}
+				URealSenseBlueprintLibrary::ColorBufferToTexture(ColorBuffer, ColorTexture, 
+																 Compressions[c] == ETextureCompression::HIGH_QUALITY);
+				Probe->RecordUpload(ColorTexture, ColorPixels, Width, Height);
+			}
+
+			Impl->StopCamera();
+			FlushRenderingCommands();
+			ColorTexture->RemoveFromRoot();
+
+			const LatencyDistribution Pickup = Probe->GetPickupDistribution();
+			const LatencyDistribution Upload = Probe->GetUploadDistribution();
+			const int32 ReadBack = Probe->GetVerifiedUploads();
+			RS_LOG(Display, "%d x %d, %s:", Width, Height, CompressionNames[c])
+			RS_LOG(Display, "  Game thread: %s", *Pickup.ToString())
+			RS_LOG(Display, "  Uploaded:    %s (%d read back)", *Upload.ToString(), ReadBack)
+
+			auto AddRow = [&](const TCHAR* Stage, const LatencyDistribution& Distribution, int32 Verified) {
+				CSV += FString::Printf(TEXT("%dx%d,%s,%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%d\n"), Width, Height, 
+									   CompressionNames[c], Stage, Distribution.count, Distribution.min, Distribution.mean,
+									   Distribution.p50, Distribution.p90, Distribution.p99, Distribution.max, Verified);
+			};
+			AddRow(TEXT("GameThread"), Pickup, 0);
+			AddRow(TEXT("Uploaded"), Upload, ReadBack);
+		}
+	}
+
+	Impl->SetSyntheticSource(false, 0.0f);
+
+	if (OutputFilename.IsEmpty() == false) {
+		if (FFileHelper::SaveStringToFile(CSV, *OutputFilename) == false) {
+			RS_LOG(Error, "Could not write %s", *OutputFilename)
+			return 1;
+		}
+		RS_LOG(Display, "Wrote %s", *OutputFilename)
+	}
+
+	return 0;
+}
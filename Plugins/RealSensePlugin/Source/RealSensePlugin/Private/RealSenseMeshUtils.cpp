@@ -0,0 +1,395 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "RealSenseMeshUtils.h"
+#include "ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Mesh Smoothing"), STAT_RealSenseMeshSmoothing, STATGROUP_RealSense);
+DECLARE_CYCLE_STAT(TEXT("Mesh Normals"), STAT_RealSenseMeshNormals, STATGROUP_RealSense);
+DECLARE_CYCLE_STAT(TEXT("Mesh Clustering"), STAT_RealSenseMeshClustering, STATGROUP_RealSense);
+DECLARE_CYCLE_STAT(TEXT("Mesh Cleanup"), STAT_RealSenseMeshCleanup, STATGROUP_RealSense);
+
+// Every triangle corner contributes its two opposite vertices to the row of 
+// its vertex. The rows are then sorted and deduplicated in parallel and 
+// compacted into the final arrays.
+void BuildMeshAdjacency(int32 NumVertices, const TArray<int32>& Triangles, FMeshAdjacency& Adjacency)
+{
+	const int32 NumTriangles = Triangles.Num() / 3;
+
+	TArray<int32> Counts;
+	Counts.SetNumZeroed(NumVertices + 1);
+
+	auto IsValidTriangle = [&](int32 t) {
+		const int32* Tri = Triangles.GetData() + 3 * t;
+		return (Tri[0] >= 0) && (Tri[0] < NumVertices) && 
+			   (Tri[1] >= 0) && (Tri[1] < NumVertices) && 
+			   (Tri[2] >= 0) && (Tri[2] < NumVertices);
+	};
+
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		if (IsValidTriangle(t)) {
+			Counts[Triangles[3 * t]] += 2;
+			Counts[Triangles[3 * t + 1]] += 2;
+			Counts[Triangles[3 * t + 2]] += 2;
+		}
+	}
+
+	TArray<int32> RawOffsets;
+	RawOffsets.SetNumUninitialized(NumVertices + 1);
+	RawOffsets[0] = 0;
+	for (int32 v = 0; v < NumVertices; ++v) {
+		RawOffsets[v + 1] = RawOffsets[v] + Counts[v];
+		Counts[v] = RawOffsets[v];
+	}
+
+	TArray<int32> RawNeighbors;
+	RawNeighbors.SetNumUninitialized(RawOffsets[NumVertices]);
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		if (IsValidTriangle(t) == false) {
+			continue;
+		}
+		const int32* Tri = Triangles.GetData() + 3 * t;
+		for (int32 Corner = 0; Corner < 3; ++Corner) {
+			const int32 v = Tri[Corner];
+			RawNeighbors[Counts[v]++] = Tri[(Corner + 1) % 3];
+			RawNeighbors[Counts[v]++] = Tri[(Corner + 2) % 3];
+		}
+	}
+
+	// Sort and deduplicate every row in place, storing the unique count
+	ParallelFor(NumVertices, [&](int32 v) {
+		int32* Row = RawNeighbors.GetData() + RawOffsets[v];
+		const int32 Num = RawOffsets[v + 1] - RawOffsets[v];
+		Sort(Row, Num);
+		int32 Unique = 0;
+		for (int32 i = 0; i < Num; ++i) {
+			if ((Unique == 0) || (Row[i] != Row[Unique - 1])) {
+				Row[Unique++] = Row[i];
+			}
+		}
+		Counts[v] = Unique;
+	});
+
+	Adjacency.Offsets.SetNumUninitialized(NumVertices + 1);
+	Adjacency.Offsets[0] = 0;
+	for (int32 v = 0; v < NumVertices; ++v) {
+		Adjacency.Offsets[v + 1] = Adjacency.Offsets[v] + Counts[v];
+	}
+
+	Adjacency.Neighbors.SetNumUninitialized(Adjacency.Offsets[NumVertices]);
+	ParallelFor(NumVertices, [&](int32 v) {
+		FMemory::Memcpy(Adjacency.Neighbors.GetData() + Adjacency.Offsets[v], 
+						RawNeighbors.GetData() + RawOffsets[v], 
+						Counts[v] * sizeof(int32));
+	});
+}
+
+// Moves every vertex by Factor times its umbrella Laplacian (the offset to the
+// average of its neighbors), reading from Source and writing to Target.
+static void ApplyLaplacianStep(const FMeshAdjacency& Adjacency, const TArray<FVector>& Source, 
+							   TArray<FVector>& Target, float Factor)
+{
+	ParallelFor(Source.Num(), [&](int32 v) {
+		const int32 Begin = Adjacency.Offsets[v];
+		const int32 End = Adjacency.Offsets[v + 1];
+		if (Begin == End) {
+			Target[v] = Source[v];
+			return;
+		}
+
+		FVector Average = FVector::ZeroVector;
+		for (int32 i = Begin; i < End; ++i) {
+			Average += Source[Adjacency.Neighbors[i]];
+		}
+		Average /= static_cast<float>(End - Begin);
+
+		Target[v] = Source[v] + Factor * (Average - Source[v]);
+	});
+}
+
+// Alternates between the vertex array and a second buffer so that every step
+// reads a consistent set of positions. Each iteration is an even number of 
+// steps, so the result always ends up back in Vertices.
+void SmoothMeshTaubin(TArray<FVector>& Vertices, const TArray<int32>& Triangles, int32 Iterations,
+					  float Lambda, float Mu)
+{
+	if ((Iterations <= 0) || (Vertices.Num() == 0)) {
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseMeshSmoothing);
+
+	FMeshAdjacency Adjacency;
+	BuildMeshAdjacency(Vertices.Num(), Triangles, Adjacency);
+
+	TArray<FVector> Buffer;
+	Buffer.SetNumUninitialized(Vertices.Num());
+
+	for (int32 i = 0; i < Iterations; ++i) {
+		ApplyLaplacianStep(Adjacency, Vertices, Buffer, Lambda);
+		ApplyLaplacianStep(Adjacency, Buffer, Vertices, Mu);
+	}
+}
+
+// Runs in two passes that never write to shared memory: the first computes 
+// the cross product of every triangle in parallel (its length is twice the 
+// triangle area, which provides the area weighting), the second gathers the 
+// products of the incident triangles of every vertex in parallel through a 
+// vertex-to-triangle index.
+//
+// Scans carry vertex colors instead of texture coordinates, so tangents are 
+// built from the normal alone: the projection of a fixed reference axis onto 
+// the tangent plane, which keeps them continuous over the surface.
+void ComputeMeshNormalsAndTangents(const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+								   TArray<FVector>& Normals, TArray<FVector>& Tangents)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseMeshNormals);
+
+	const int32 NumVertices = Vertices.Num();
+	const int32 NumTriangles = Triangles.Num() / 3;
+
+	Normals.SetNumUninitialized(NumVertices);
+	Tangents.SetNumUninitialized(NumVertices);
+
+	// Pass 1: weighted face normals, zero for invalid triangles
+	TArray<FVector> FaceNormals;
+	FaceNormals.SetNumUninitialized(NumTriangles);
+	ParallelFor(NumTriangles, [&](int32 t) {
+		const int32* Tri = Triangles.GetData() + 3 * t;
+		if ((Tri[0] < 0) || (Tri[0] >= NumVertices) || 
+			(Tri[1] < 0) || (Tri[1] >= NumVertices) || 
+			(Tri[2] < 0) || (Tri[2] >= NumVertices)) {
+			FaceNormals[t] = FVector::ZeroVector;
+			return;
+		}
+		const FVector& A = Vertices[Tri[0]];
+		const FVector& B = Vertices[Tri[1]];
+		const FVector& C = Vertices[Tri[2]];
+		// UE4 uses clockwise front faces, so the normal is (C - A) x (B - A)
+		FaceNormals[t] = FVector::CrossProduct(C - A, B - A);
+	});
+
+	// Vertex-to-triangle index in compressed sparse row form
+	TArray<int32> Offsets;
+	Offsets.SetNumZeroed(NumVertices + 1);
+	for (int32 i = 0; i < NumTriangles * 3; ++i) {
+		const int32 v = Triangles[i];
+		if ((v >= 0) && (v < NumVertices)) {
+			Offsets[v + 1]++;
+		}
+	}
+	for (int32 v = 0; v < NumVertices; ++v) {
+		Offsets[v + 1] += Offsets[v];
+	}
+
+	TArray<int32> Cursor(Offsets.GetData(), NumVertices);
+	TArray<int32> IncidentTriangles;
+	IncidentTriangles.SetNumUninitialized(Offsets[NumVertices]);
+	for (int32 i = 0; i < NumTriangles * 3; ++i) {
+		const int32 v = Triangles[i];
+		if ((v >= 0) && (v < NumVertices)) {
+			IncidentTriangles[Cursor[v]++] = i / 3;
+		}
+	}
+
+	// Pass 2: gather per vertex
+	ParallelFor(NumVertices, [&](int32 v) {
+		FVector Normal = FVector::ZeroVector;
+		for (int32 i = Offsets[v]; i < Offsets[v + 1]; ++i) {
+			Normal += FaceNormals[IncidentTriangles[i]];
+		}
+		Normal = Normal.GetSafeNormal();
+		if (Normal.IsZero()) {
+			Normal = FVector::UpVector;
+		}
+
+		// Pick the reference axis least aligned with the normal
+		const FVector Reference = (FMath::Abs(Normal.Z) < 0.9f) ? FVector::UpVector : FVector::ForwardVector;
+		Normals[v] = Normal;
+		Tangents[v] = FVector::CrossProduct(Reference, Normal).GetSafeNormal();
+	});
+}
+
+static int32 FindComponentRoot(TArray<int32>& Parents, int32 i)
+{
+	while (Parents[i] != i) {
+		Parents[i] = Parents[Parents[i]];
+		i = Parents[i];
+	}
+	return i;
+}
+
+// Components are found with a union-find over the vertices of the valid 
+// triangles, which is linear in the size of the mesh.
+void CleanMesh(TArray<FVector>& Vertices, TArray<int32>& Triangles, float MinComponentFraction, 
+			   TArray<int32>& VertexRemap)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseMeshCleanup);
+
+	const int32 NumVertices = Vertices.Num();
+
+	// Drop invalid and degenerate triangles
+	int32 NumTriangles = 0;
+	for (int32 t = 0; t < Triangles.Num() / 3; ++t) {
+		const int32 a = Triangles[3 * t + 0];
+		const int32 b = Triangles[3 * t + 1];
+		const int32 c = Triangles[3 * t + 2];
+		if ((a < 0) || (a >= NumVertices) || (b < 0) || (b >= NumVertices) || (c < 0) || (c >= NumVertices) ||
+			(a == b) || (b == c) || (a == c)) {
+			continue;
+		}
+		Triangles[3 * NumTriangles + 0] = a;
+		Triangles[3 * NumTriangles + 1] = b;
+		Triangles[3 * NumTriangles + 2] = c;
+		NumTriangles++;
+	}
+	Triangles.SetNum(NumTriangles * 3);
+
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(NumVertices);
+	for (int32 v = 0; v < NumVertices; ++v) {
+		Parents[v] = v;
+	}
+	for (int32 i = 0; i < NumTriangles * 3; i += 3) {
+		for (int32 k = 1; k < 3; ++k) {
+			const int32 a = FindComponentRoot(Parents, Triangles[i]);
+			const int32 b = FindComponentRoot(Parents, Triangles[i + k]);
+			if (a != b) {
+				Parents[FMath::Max(a, b)] = FMath::Min(a, b);
+			}
+		}
+	}
+
+	TArray<int32> ComponentTriangles;
+	ComponentTriangles.SetNumZeroed(NumVertices);
+	for (int32 i = 0; i < NumTriangles * 3; i += 3) {
+		ComponentTriangles[FindComponentRoot(Parents, Triangles[i])]++;
+	}
+
+	// Keep the triangles of large components and the vertices they use
+	const int32 MinTriangles = FMath::CeilToInt(MinComponentFraction * NumTriangles);
+	VertexRemap.Init(INDEX_NONE, NumVertices);
+	int32 NumKept = 0;
+	int32 NumKeptVertices = 0;
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		if (ComponentTriangles[FindComponentRoot(Parents, Triangles[3 * t])] < MinTriangles) {
+			continue;
+		}
+		for (int32 k = 0; k < 3; ++k) {
+			int32& Remap = VertexRemap[Triangles[3 * t + k]];
+			if (Remap == INDEX_NONE) {
+				Remap = NumKeptVertices++;
+			}
+			Triangles[3 * NumKept + k] = Remap;
+		}
+		NumKept++;
+	}
+	Triangles.SetNum(NumKept * 3);
+
+	TArray<FVector> KeptVertices;
+	KeptVertices.SetNumUninitialized(NumKeptVertices);
+	for (int32 v = 0; v < NumVertices; ++v) {
+		if (VertexRemap[v] != INDEX_NONE) {
+			KeptVertices[VertexRemap[v]] = Vertices[v];
+		}
+	}
+	Vertices = MoveTemp(KeptVertices);
+}
+
+// The cell of each vertex is computed in parallel and packed with its group 
+// into a sort key, so that sorting the vertices groups every cluster into a 
+// contiguous run.
+void ClusterMeshVertices(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, 
+						 const TArray<int32>& VertexGroups, float CellSize, TArray<int32>& VertexClusters, 
+						 TArray<FVector>& ClusteredVertices, TArray<int32>& ClusteredTriangles)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseMeshClustering);
+
+	const int32 NumVertices = Vertices.Num();
+	const int32 NumTriangles = Triangles.Num() / 3;
+	const bool bHasGroups = (VertexGroups.Num() == NumVertices);
+
+	VertexClusters.SetNumUninitialized(NumVertices);
+	ClusteredVertices.Reset();
+	ClusteredTriangles.Reset();
+	if (NumVertices == 0) {
+		return;
+	}
+
+	// 21 bits per cell coordinate, relative to the corner of the bounds
+	const FBox Bounds(Vertices.GetData(), NumVertices);
+	const float MaxCells = (1 << 21) - 1;
+	CellSize = FMath::Max(CellSize, Bounds.GetSize().GetMax() / MaxCells);
+	const float InvCellSize = 1.0f / FMath::Max(CellSize, SMALL_NUMBER);
+
+	struct ClusterKey {
+		uint64 Cell;
+		int32 Group;
+		int32 Vertex;
+
+		inline bool operator<(const ClusterKey& Other) const
+		{
+			return (Cell < Other.Cell) || ((Cell == Other.Cell) && (Group < Other.Group));
+		}
+	};
+
+	TArray<ClusterKey> Keys;
+	Keys.SetNumUninitialized(NumVertices);
+	ParallelFor(NumVertices, [&](int32 v) {
+		const FVector Cell = (Vertices[v] - Bounds.Min) * InvCellSize;
+		const uint64 X = FMath::Min(static_cast<uint64>(Cell.X), static_cast<uint64>(MaxCells));
+		const uint64 Y = FMath::Min(static_cast<uint64>(Cell.Y), static_cast<uint64>(MaxCells));
+		const uint64 Z = FMath::Min(static_cast<uint64>(Cell.Z), static_cast<uint64>(MaxCells));
+		Keys[v].Cell = (X << 42) | (Y << 21) | Z;
+		Keys[v].Group = bHasGroups ? VertexGroups[v] : 0;
+		Keys[v].Vertex = v;
+	});
+	Keys.Sort();
+
+	TArray<int32> Counts;
+	for (int32 i = 0; i < NumVertices; ++i) {
+		if ((i == 0) || (Keys[i - 1] < Keys[i])) {
+			ClusteredVertices.Add(FVector::ZeroVector);
+			Counts.Add(0);
+		}
+		const int32 Cluster = ClusteredVertices.Num() - 1;
+		VertexClusters[Keys[i].Vertex] = Cluster;
+		ClusteredVertices[Cluster] += Vertices[Keys[i].Vertex];
+		Counts[Cluster]++;
+	}
+
+	ParallelFor(ClusteredVertices.Num(), [&](int32 c) {
+		ClusteredVertices[c] /= Counts[c];
+	});
+
+	ClusteredTriangles.Reserve(NumTriangles * 3);
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		const int32* Tri = Triangles.GetData() + 3 * t;
+		if ((Tri[0] < 0) || (Tri[0] >= NumVertices) || 
+			(Tri[1] < 0) || (Tri[1] >= NumVertices) || 
+			(Tri[2] < 0) || (Tri[2] >= NumVertices)) {
+			continue;
+		}
+		const int32 a = VertexClusters[Tri[0]];
+		const int32 b = VertexClusters[Tri[1]];
+		const int32 c = VertexClusters[Tri[2]];
+		if ((a != b) && (b != c) && (a != c)) {
+			ClusteredTriangles.Add(a);
+			ClusteredTriangles.Add(b);
+			ClusteredTriangles.Add(c);
+		}
+	}
+}
@@ -0,0 +1,553 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "RealSenseUtils.h"
+#include "RealSenseMeshUtils.h"
+#include "Async.h"
+#include "ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Mesh File Write"), STAT_RealSenseMeshFileWrite, STATGROUP_RealSense);
+
+// LoadMeshFile scales the middleware's meters by this factor
+static const float ScanScale = 150.0f;
+
+// Number of vertices or faces formatted by one task
+static const int32 LinesPerChunk = 8192;
+
+// Number of chunks formatted in parallel before they are handed to the writer
+static const int32 ChunksPerBatch = 32;
+
+// Upper bound of the bytes of any line written, with every number at its 
+// longest (e.g. "-1.17549435e-38" or "-2147483648")
+static const int32 MaxLineBytes = 128;
+
+namespace {
+
+// Shortest round-trip formatting of floats after Ulf Adams, "Ryu: fast 
+// float-to-string conversion" (PLDI 2018). The tables hold 5^-q and 5^i
+// normalized to 59 and 61 significant bits.
+const int32 Pow5InvBitCount = 59;
+const int32 Pow5BitCount = 61;
+
+const uint64 Pow5InvSplit[31] = {
+	576460752303423489u, 461168601842738791u, 368934881474191033u,
+	295147905179352826u, 472236648286964522u, 377789318629571618u,
+	302231454903657294u, 483570327845851670u, 386856262276681336u,
+	309485009821345069u, 495176015714152110u, 396140812571321688u,
+	316912650057057351u, 507060240091291761u, 405648192073033409u,
+	324518553658426727u, 519229685853482763u, 415383748682786211u,
+	332306998946228969u, 531691198313966350u, 425352958651173080u,
+	340282366920938464u, 544451787073501542u, 435561429658801234u,
+	348449143727040987u, 557518629963265579u, 446014903970612463u,
+	356811923176489971u, 570899077082383953u, 456719261665907162u,
+	365375409332725730u,
+};
+
+const uint64 Pow5Split[47] = {
+	1152921504606846976u, 1441151880758558720u, 1801439850948198400u,
+	2251799813685248000u, 1407374883553280000u, 1759218604441600000u,
+	2199023255552000000u, 1374389534720000000u, 1717986918400000000u,
+	2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+	2097152000000000000u, 1310720000000000000u, 1638400000000000000u,
+	2048000000000000000u, 1280000000000000000u, 1600000000000000000u,
+	2000000000000000000u, 1250000000000000000u, 1562500000000000000u,
+	1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+	1907348632812500000u, 1192092895507812500u, 1490116119384765625u,
+	1862645149230957031u, 1164153218269348144u, 1455191522836685180u,
+	1818989403545856475u, 2273736754432320594u, 1421085471520200371u,
+	1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+	1734723475976807094u, 2168404344971008868u, 1355252715606880542u,
+	1694065894508600678u, 2117582368135750847u, 1323488980084844279u,
+	1654361225106055349u, 2067951531382569187u, 1292469707114105741u,
+	1615587133892632177u, 2019483917365790221u,
+};
+
+// ceil(log2(5^e)), or 1 for e = 0
+inline int32 Pow5Bits(int32 e) { return static_cast<int32>((static_cast<uint32>(e) * 1217359) >> 19) + 1; }
+
+// floor(log10(2^e)) and floor(log10(5^e))
+inline uint32 Log10Pow2(int32 e) { return (static_cast<uint32>(e) * 78913) >> 18; }
+inline uint32 Log10Pow5(int32 e) { return (static_cast<uint32>(e) * 732923) >> 20; }
+
+inline bool IsMultipleOfPow5(uint32 Value, uint32 p)
+{
+	uint32 Count = 0;
+	while ((Value != 0) && (Value % 5 == 0)) {
+		Value /= 5;
+		Count++;
+	}
+	return Count >= p;
+}
+
+inline bool IsMultipleOfPow2(uint32 Value, uint32 p) { return (Value & ((1u << p) - 1)) == 0; }
+
+inline uint32 MulShift(uint32 m, uint64 Factor, int32 Shift)
+{
+	const uint64 Lo = static_cast<uint64>(m) * static_cast<uint32>(Factor);
+	const uint64 Hi = static_cast<uint64>(m) * static_cast<uint32>(Factor >> 32);
+	return static_cast<uint32>(((Lo >> 32) + Hi) >> (Shift - 32));
+}
+
+// Returns the shortest decimal digits that round to the float with the given
+// mantissa and biased exponent, and the power of ten they are scaled by.
+uint32 ShortestDecimal(uint32 IeeeMantissa, uint32 IeeeExponent, int32& Exponent10)
+{
+	int32 e2;
+	uint32 m2;
+	if (IeeeExponent == 0) {
+		e2 = 1 - 127 - 23 - 2;
+		m2 = IeeeMantissa;
+	}
+	else {
+		e2 = static_cast<int32>(IeeeExponent) - 127 - 23 - 2;
+		m2 = (1u << 23) | IeeeMantissa;
+	}
+	const bool bAcceptBounds = (m2 & 1) == 0;
+
+	// The interval of decimals that round to this float is [mm, mp] / 4 * 2^e2
+	const uint32 mv = 4 * m2;
+	const uint32 mmShift = ((IeeeMantissa != 0) || (IeeeExponent <= 1)) ? 1 : 0;
+	const uint32 mp = 4 * m2 + 2;
+	const uint32 mm = 4 * m2 - 1 - mmShift;
+
+	uint32 vr, vp, vm;
+	bool bVmTrailingZeros = false;
+	bool bVrTrailingZeros = false;
+	uint32 LastRemovedDigit = 0;
+
+	if (e2 >= 0) {
+		const uint32 q = Log10Pow2(e2);
+		Exponent10 = q;
+		const int32 k = Pow5InvBitCount + Pow5Bits(q) - 1;
+		const int32 i = -e2 + q + k;
+		vr = MulShift(mv, Pow5InvSplit[q], i);
+		vp = MulShift(mp, Pow5InvSplit[q], i);
+		vm = MulShift(mm, Pow5InvSplit[q], i);
+		if ((q != 0) && ((vp - 1) / 10 <= vm / 10)) {
+			const int32 l = Pow5InvBitCount + Pow5Bits(q - 1) - 1;
+			LastRemovedDigit = MulShift(mv, Pow5InvSplit[q - 1], -e2 + q - 1 + l) % 10;
+		}
+		if (q <= 9) {
+			if (mv % 5 == 0) {
+				bVrTrailingZeros = IsMultipleOfPow5(mv, q);
+			}
+			else if (bAcceptBounds) {
+				bVmTrailingZeros = IsMultipleOfPow5(mm, q);
+			}
+			else {
+				vp -= IsMultipleOfPow5(mp, q) ? 1 : 0;
+			}
+		}
+	}
+	else {
+		const uint32 q = Log10Pow5(-e2);
+		Exponent10 = q + e2;
+		const int32 i = -e2 - q;
+		const int32 k = Pow5Bits(i) - Pow5BitCount;
+		int32 j = q - k;
+		vr = MulShift(mv, Pow5Split[i], j);
+		vp = MulShift(mp, Pow5Split[i], j);
+		vm = MulShift(mm, Pow5Split[i], j);
+		if ((q != 0) && ((vp - 1) / 10 <= vm / 10)) {
+			j = q - 1 - (Pow5Bits(i + 1) - Pow5BitCount);
+			LastRemovedDigit = MulShift(mv, Pow5Split[i + 1], j) % 10;
+		}
+		if (q <= 1) {
+			bVrTrailingZeros = true;
+			if (bAcceptBounds) {
+				bVmTrailingZeros = (mmShift == 1);
+			}
+			else {
+				--vp;
+			}
+		}
+		else if (q < 31) {
+			bVrTrailingZeros = IsMultipleOfPow2(mv, q - 1);
+		}
+	}
+
+	// Remove digits while the interval still holds a shorter decimal
+	int32 Removed = 0;
+	uint32 Output;
+	if (bVmTrailingZeros || bVrTrailingZeros) {
+		while (vp / 10 > vm / 10) {
+			bVmTrailingZeros &= (vm % 10 == 0);
+			bVrTrailingZeros &= (LastRemovedDigit == 0);
+			LastRemovedDigit = vr % 10;
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			++Removed;
+		}
+		if (bVmTrailingZeros) {
+			while (vm % 10 == 0) {
+				bVrTrailingZeros &= (LastRemovedDigit == 0);
+				LastRemovedDigit = vr % 10;
+				vr /= 10;
+				vp /= 10;
+				vm /= 10;
+				++Removed;
+			}
+		}
+		if (bVrTrailingZeros && (LastRemovedDigit == 5) && (vr % 2 == 0)) {
+			// Round half to even
+			LastRemovedDigit = 4;
+		}
+		Output = vr + ((((vr == vm) && (!bAcceptBounds || !bVmTrailingZeros)) || (LastRemovedDigit >= 5)) ? 1 : 0);
+	}
+	else {
+		while (vp / 10 > vm / 10) {
+			LastRemovedDigit = vr % 10;
+			vr /= 10;
+			vp /= 10;
+			vm /= 10;
+			++Removed;
+		}
+		Output = vr + (((vr == vm) || (LastRemovedDigit >= 5)) ? 1 : 0);
+	}
+
+	Exponent10 += Removed;
+	return Output;
+}
+
+inline ANSICHAR* WriteUInt(ANSICHAR* Out, uint32 Value)
+{
+	ANSICHAR Digits[10];
+	int32 NumDigits = 0;
+	do {
+		Digits[NumDigits++] = '0' + (Value % 10);
+		Value /= 10;
+	} while (Value != 0);
+	while (NumDigits > 0) {
+		*Out++ = Digits[--NumDigits];
+	}
+	return Out;
+}
+
+inline ANSICHAR* WriteInt(ANSICHAR* Out, int32 Value)
+{
+	if (Value < 0) {
+		*Out++ = '-';
+		return WriteUInt(Out, 0u - static_cast<uint32>(Value));
+	}
+	return WriteUInt(Out, static_cast<uint32>(Value));
+}
+
+// Writes the shortest decimal that reads back as exactly the same float, in
+// plain notation for moderate exponents and scientific notation otherwise.
+ANSICHAR* WriteFloat(ANSICHAR* Out, float Value)
+{
+	uint32 Bits;
+	FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+	const uint32 IeeeMantissa = Bits & ((1u << 23) - 1);
+	const uint32 IeeeExponent = (Bits >> 23) & 0xff;
+
+	// Mesh files have no representation for NaN and infinity
+	if (IeeeExponent == 0xff) {
+		*Out++ = '0';
+		return Out;
+	}
+	if (Bits >> 31) {
+		*Out++ = '-';
+	}
+	if ((IeeeExponent == 0) && (IeeeMantissa == 0)) {
+		*Out++ = '0';
+		return Out;
+	}
+
+	int32 Exponent10;
+	uint32 Output = ShortestDecimal(IeeeMantissa, IeeeExponent, Exponent10);
+
+	ANSICHAR Digits[10];
+	int32 NumDigits = 0;
+	for (uint32 v = Output; v != 0; v /= 10) {
+		NumDigits++;
+	}
+	for (int32 i = NumDigits - 1; i >= 0; --i) {
+		Digits[i] = '0' + (Output % 10);
+		Output /= 10;
+	}
+
+	// Number of digits before the decimal point
+	const int32 Point = NumDigits + Exponent10;
+
+	if ((Exponent10 >= 0) && (Point <= 9)) {
+		for (int32 i = 0; i < NumDigits; ++i) *Out++ = Digits[i];
+		for (int32 i = 0; i < Exponent10; ++i) *Out++ = '0';
+	}
+	else if ((Point > 0) && (Point < NumDigits)) {
+		for (int32 i = 0; i < Point; ++i) *Out++ = Digits[i];
+		*Out++ = '.';
+		for (int32 i = Point; i < NumDigits; ++i) *Out++ = Digits[i];
+	}
+	else if ((Point <= 0) && (Point > -5)) {
+		*Out++ = '0';
+		*Out++ = '.';
+		for (int32 i = Point; i < 0; ++i) *Out++ = '0';
+		for (int32 i = 0; i < NumDigits; ++i) *Out++ = Digits[i];
+	}
+	else {
+		*Out++ = Digits[0];
+		if (NumDigits > 1) {
+			*Out++ = '.';
+			for (int32 i = 1; i < NumDigits; ++i) *Out++ = Digits[i];
+		}
+		*Out++ = 'e';
+		Out = WriteInt(Out, Point - 1);
+	}
+	return Out;
+}
+
+inline ANSICHAR* WriteString(ANSICHAR* Out, const ANSICHAR* String)
+{
+	while (*String) {
+		*Out++ = *String++;
+	}
+	return Out;
+}
+
+enum class MeshSection : uint8 {
+	Vertices,
+	Normals,
+	Faces,
+};
+
+// A range of lines of one section of the file
+struct FormatJob {
+	MeshSection Section;
+	int32 Begin;
+	int32 End;
+};
+
+// Mesh in the coordinate space of the file
+struct MeshFileData {
+	bool bPly;
+	TArray<FVector> Vertices;
+	TArray<FVector> Normals;
+	const TArray<int32>* Triangles;
+	const TArray<FColor>* Colors;
+};
+
+// Formats the lines of a job into Buffer, which is resized to fit
+void FormatChunk(const MeshFileData& Mesh, const FormatJob& Job, TArray<ANSICHAR>& Buffer)
+{
+	Buffer.SetNumUninitialized((Job.End - Job.Begin) * MaxLineBytes, false);
+	ANSICHAR* Out = Buffer.GetData();
+
+	const TArray<FColor>& Colors = *Mesh.Colors;
+	const TArray<int32>& Triangles = *Mesh.Triangles;
+
+	for (int32 i = Job.Begin; i < Job.End; ++i) {
+		switch (Job.Section) {
+		case MeshSection::Vertices: {
+			const FVector& V = Mesh.Vertices[i];
+			const FColor Color = Colors.IsValidIndex(i) ? Colors[i] : FColor::White;
+			if (Mesh.bPly) {
+				const FVector& N = Mesh.Normals[i];
+				Out = WriteFloat(Out, V.X); *Out++ = ' ';
+				Out = WriteFloat(Out, V.Y); *Out++ = ' ';
+				Out = WriteFloat(Out, V.Z); *Out++ = ' ';
+				Out = WriteFloat(Out, N.X); *Out++ = ' ';
+				Out = WriteFloat(Out, N.Y); *Out++ = ' ';
+				Out = WriteFloat(Out, N.Z); *Out++ = ' ';
+				Out = WriteUInt(Out, Color.R); *Out++ = ' ';
+				Out = WriteUInt(Out, Color.G); *Out++ = ' ';
+				Out = WriteUInt(Out, Color.B);
+			}
+			else {
+				// Colors are stored as 0 - 1 floats after the position
+				*Out++ = 'v'; *Out++ = ' ';
+				Out = WriteFloat(Out, V.X); *Out++ = ' ';
+				Out = WriteFloat(Out, V.Y); *Out++ = ' ';
+				Out = WriteFloat(Out, V.Z); *Out++ = ' ';
+				Out = WriteFloat(Out, Color.R / 255.0f); *Out++ = ' ';
+				Out = WriteFloat(Out, Color.G / 255.0f); *Out++ = ' ';
+				Out = WriteFloat(Out, Color.B / 255.0f);
+			}
+			break;
+		}
+		case MeshSection::Normals: {
+			const FVector& N = Mesh.Normals[i];
+			*Out++ = 'v'; *Out++ = 'n'; *Out++ = ' ';
+			Out = WriteFloat(Out, N.X); *Out++ = ' ';
+			Out = WriteFloat(Out, N.Y); *Out++ = ' ';
+			Out = WriteFloat(Out, N.Z);
+			break;
+		}
+		case MeshSection::Faces: {
+			const int32* Tri = Triangles.GetData() + 3 * i;
+			if (Mesh.bPly) {
+				*Out++ = '3';
+				for (int32 k = 0; k < 3; ++k) {
+					*Out++ = ' ';
+					Out = WriteInt(Out, Tri[k]);
+				}
+			}
+			else {
+				// 1-based vertex and normal indices, as written by the middleware
+				*Out++ = 'f';
+				for (int32 k = 0; k < 3; ++k) {
+					*Out++ = ' ';
+					Out = WriteInt(Out, Tri[k] + 1);
+					*Out++ = '/'; *Out++ = '/';
+					Out = WriteInt(Out, Tri[k] + 1);
+				}
+			}
+			break;
+		}
+		}
+		*Out++ = '\n';
+	}
+
+	Buffer.SetNum(Out - Buffer.GetData(), false);
+}
+
+void AddJobs(MeshSection Section, int32 NumLines, TArray<FormatJob>& Jobs)
+{
+	for (int32 Begin = 0; Begin < NumLines; Begin += LinesPerChunk) {
+		Jobs.Add({ Section, Begin, FMath::Min(Begin + LinesPerChunk, NumLines) });
+	}
+}
+
+}
+
+// Converts the mesh back to the coordinate space of the middleware and formats
+// batches of chunks in parallel. Each batch is written by a background task
+// while the next one is formatted into a second set of buffers, so the file
+// is streamed through a single buffered writer without holding the whole 
+// text in memory.
+bool SaveMeshFile(const FString& filename, const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+				  const TArray<FColor>& Colors, const TArray<FVector>& Normals, FMeshFileWriteStats* Stats)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseMeshFileWrite);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumVertices = Vertices.Num();
+	const int32 NumTriangles = Triangles.Num() / 3;
+
+	for (int32 i = 0; i < NumTriangles * 3; ++i) {
+		if ((Triangles[i] < 0) || (Triangles[i] >= NumVertices)) {
+			RS_LOG(Error, "Invalid vertex index in mesh written to %s", *filename);
+			return false;
+		}
+	}
+
+	MeshFileData Mesh;
+	Mesh.bPly = filename.EndsWith(TEXT(".ply"), ESearchCase::IgnoreCase);
+	Mesh.Triangles = &Triangles;
+	Mesh.Colors = &Colors;
+	Mesh.Vertices.SetNumUninitialized(NumVertices);
+	Mesh.Normals.SetNumUninitialized(NumVertices);
+
+	TArray<FVector> ComputedNormals;
+	if (Normals.Num() != NumVertices) {
+		TArray<FVector> Tangents;
+		ComputeMeshNormalsAndTangents(Vertices, Triangles, ComputedNormals, Tangents);
+	}
+	const TArray<FVector>& SourceNormals = (Normals.Num() == NumVertices) ? Normals : ComputedNormals;
+
+	ParallelFor(NumVertices, [&](int32 v) {
+		Mesh.Vertices[v] = ConvertUnrealVectorToRS(Vertices[v]) / ScanScale;
+		Mesh.Normals[v] = ConvertUnrealVectorToRS(SourceNormals[v]);
+	});
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*filename));
+	if (Writer.IsValid() == false) {
+		RS_LOG(Error, "Could not open %s for writing", *filename);
+		return false;
+	}
+
+	FString Header;
+	if (Mesh.bPly) {
+		Header = FString::Printf(TEXT("ply\nformat ascii 1.0\nelement vertex %d\n")
+			TEXT("property float x\nproperty float y\nproperty float z\n")
+			TEXT("property float nx\nproperty float ny\nproperty float nz\n")
+			TEXT("property uchar red\nproperty uchar green\nproperty uchar blue\n")
+			TEXT("element face %d\nproperty list uchar int vertex_indices\nend_header\n"), NumVertices, NumTriangles);
+	}
+	else {
+		Header = FString::Printf(TEXT("# %d vertices, %d triangles\n"), NumVertices, NumTriangles);
+	}
+	FTCHARToUTF8 HeaderText(*Header);
+	Writer->Serialize(const_cast<ANSICHAR*>(HeaderText.Get()), HeaderText.Length());
+
+	TArray<FormatJob> Jobs;
+	AddJobs(MeshSection::Vertices, NumVertices, Jobs);
+	if (Mesh.bPly == false) {
+		AddJobs(MeshSection::Normals, NumVertices, Jobs);
+	}
+	AddJobs(MeshSection::Faces, NumTriangles, Jobs);
+
+	int64 Bytes = HeaderText.Length();
+	double FormatSeconds = 0.0;
+	double WriteSeconds = 0.0;
+
+	TArray<TArray<ANSICHAR>> Buffers[2];
+	Buffers[0].SetNum(ChunksPerBatch);
+	Buffers[1].SetNum(ChunksPerBatch);
+	TFuture<void> PendingWrite;
+
+	for (int32 Batch = 0, First = 0; First < Jobs.Num(); ++Batch, First += ChunksPerBatch) {
+		TArray<TArray<ANSICHAR>>& BatchBuffers = Buffers[Batch & 1];
+		const int32 NumChunks = FMath::Min(ChunksPerBatch, Jobs.Num() - First);
+
+		const double FormatStart = FPlatformTime::Seconds();
+		ParallelFor(NumChunks, [&](int32 c) {
+			FormatChunk(Mesh, Jobs[First + c], BatchBuffers[c]);
+		});
+		FormatSeconds += FPlatformTime::Seconds() - FormatStart;
+
+		// The previous batch has to be on its way before its buffers are reused
+		if (PendingWrite.IsValid()) {
+			PendingWrite.Wait();
+		}
+		for (int32 c = 0; c < NumChunks; ++c) {
+			Bytes += BatchBuffers[c].Num();
+		}
+		PendingWrite = Async<void>(EAsyncExecution::ThreadPool, [&Writer, &BatchBuffers, &WriteSeconds, NumChunks]() {
+			const double WriteStart = FPlatformTime::Seconds();
+			for (int32 c = 0; c < NumChunks; ++c) {
+				Writer->Serialize(BatchBuffers[c].GetData(), BatchBuffers[c].Num());
+			}
+			WriteSeconds += FPlatformTime::Seconds() - WriteStart;
+		});
+	}
+
+	if (PendingWrite.IsValid()) {
+		PendingWrite.Wait();
+	}
+
+	const double CloseStart = FPlatformTime::Seconds();
+	const bool bSuccess = Writer->Close() && (Writer->IsError() == false);
+	WriteSeconds += FPlatformTime::Seconds() - CloseStart;
+
+	FMeshFileWriteStats WriteStats;
+	WriteStats.Bytes = Bytes;
+	WriteStats.FormatSeconds = FormatSeconds;
+	WriteStats.WriteSeconds = WriteSeconds;
+	WriteStats.TotalSeconds = FPlatformTime::Seconds() - StartTime;
+	if (Stats) {
+		*Stats = WriteStats;
+	}
+
+	RS_LOG(Log, "Wrote %s : %.1f MB in %.1f ms (%.0f MB/s overall, %.0f MB/s formatting, %.0f MB/s writing)",
+		   *filename, WriteStats.Bytes / (1024.0 * 1024.0), WriteStats.TotalSeconds * 1000.0,
+		   WriteStats.GetMegabytesPerSecond(WriteStats.TotalSeconds),
+		   WriteStats.GetMegabytesPerSecond(WriteStats.FormatSeconds),
+		   WriteStats.GetMegabytesPerSecond(WriteStats.WriteSeconds));
+
+	return bSuccess;
+}
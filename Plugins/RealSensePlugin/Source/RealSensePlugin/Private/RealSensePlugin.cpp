@@ -15,9 +15,23 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 #include "RealSensePluginPrivatePCH.h"
 
+#include "RealSenseImpl.h"
+
 class FRealSensePlugin : public IRealSensePlugin
 {
 	void StartupModule() override {}	// This code will execute after the module is loaded into memory
-	void ShutdownModule() override {}	// This function may be called during shutdown or before reloading
+	void ShutdownModule() override { captureService.reset(); }	// This function may be called during shutdown or before reloading
+
+	std::shared_ptr<RealSenseImpl> GetCaptureService() override 
+	{
+		if (captureService == nullptr) {
+			captureService = std::make_shared<RealSenseImpl>();
+		}
+		return captureService;
+	}
+
+	// Owned by the module rather than by a session manager, so that the 
+	// camera keeps streaming while levels are unloaded and loaded
+	std::shared_ptr<RealSenseImpl> captureService;
 };
 IMPLEMENT_MODULE(FRealSensePlugin, RealSensePlugin)
\ No newline at end of file
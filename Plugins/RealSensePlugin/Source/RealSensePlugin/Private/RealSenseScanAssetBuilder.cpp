@@ -0,0 +1,322 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "RealSenseScanAsset.h"
+#include "RealSenseMeshUtils.h"
+#include "Async.h"
+#include "ParallelFor.h"
+
+#if WITH_EDITOR
+#include "RawMesh.h"
+#include "AssetRegistryModule.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Materials/MaterialExpressionTextureSample.h"
+#endif
+
+DECLARE_CYCLE_STAT(TEXT("Scan Asset Preparation"), STAT_RealSenseScanAssetPrepare, STATGROUP_RealSense);
+DECLARE_CYCLE_STAT(TEXT("Scan Asset Creation"), STAT_RealSenseScanAssetCreate, STATGROUP_RealSense);
+
+// Voxel resolution of the convex decomposition, matching UScan3DComponent so
+// that both share the cached hulls of a scan.
+static const int32 CollisionResolution = 48;
+
+#if WITH_EDITOR
+
+namespace {
+
+// One LOD of the scan, with all attributes stored per vertex
+struct ScanMeshLOD {
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector> Normals;
+	TArray<FVector> Tangents;
+	TArray<FVector2D> UVs;
+	TArray<FColor> Colors;
+	TArray<int32> Groups;
+};
+
+// Everything the game thread needs to create the assets
+struct ScanAssetData {
+	TArray<FRawMesh> LODs;
+	TArray<FScanConvexHull> Hulls;
+	int32 TextureSize{ 0 };
+	TArray<FColor> Texels;
+};
+
+// Simplifies Source by vertex clustering and averages the attributes of the
+// merged vertices. Vertices of different groups, i.e. texture charts, stay
+// separate so that the averaged texture coordinates remain valid.
+void SimplifyScanMesh(const ScanMeshLOD& Source, float CellSize, ScanMeshLOD& LOD)
+{
+	TArray<int32> Clusters;
+	ClusterMeshVertices(Source.Vertices, Source.Triangles, Source.Groups, CellSize, 
+						Clusters, LOD.Vertices, LOD.Triangles);
+
+	const int32 NumClusters = LOD.Vertices.Num();
+	TArray<FVector4> ColorSums;
+	TArray<int32> Counts;
+	LOD.Normals.SetNumZeroed(NumClusters);
+	LOD.Tangents.SetNumZeroed(NumClusters);
+	LOD.UVs.SetNumZeroed(NumClusters);
+	LOD.Groups.SetNumZeroed(NumClusters);
+	ColorSums.SetNumZeroed(NumClusters);
+	Counts.SetNumZeroed(NumClusters);
+
+	for (int32 v = 0; v < Source.Vertices.Num(); ++v) {
+		const int32 c = Clusters[v];
+		const FColor& Color = Source.Colors[v];
+		LOD.Normals[c] += Source.Normals[v];
+		LOD.Tangents[c] += Source.Tangents[v];
+		LOD.UVs[c] += Source.UVs[v];
+		LOD.Groups[c] = Source.Groups.Num() ? Source.Groups[v] : 0;
+		ColorSums[c] += FVector4(Color.R, Color.G, Color.B, Color.A);
+		Counts[c]++;
+	}
+
+	LOD.Colors.SetNumUninitialized(NumClusters);
+	ParallelFor(NumClusters, [&](int32 c) {
+		const FVector Normal = LOD.Normals[c].GetSafeNormal();
+		LOD.Normals[c] = Normal.IsZero() ? FVector::UpVector : Normal;
+		LOD.Tangents[c] = (LOD.Tangents[c] - LOD.Normals[c] * FVector::DotProduct(LOD.Tangents[c], LOD.Normals[c])).GetSafeNormal();
+		LOD.UVs[c] /= Counts[c];
+		const FVector4 Color = ColorSums[c] * (1.0f / Counts[c]);
+		LOD.Colors[c] = FColor(static_cast<uint8>(Color.X), static_cast<uint8>(Color.Y), 
+							   static_cast<uint8>(Color.Z), static_cast<uint8>(Color.W));
+	});
+}
+
+void ConvertToRawMesh(const ScanMeshLOD& LOD, FRawMesh& RawMesh)
+{
+	const int32 NumWedges = LOD.Triangles.Num();
+
+	RawMesh.VertexPositions = LOD.Vertices;
+	RawMesh.WedgeIndices = LOD.Triangles;
+	RawMesh.WedgeTangentX.SetNumUninitialized(NumWedges);
+	RawMesh.WedgeTangentY.SetNumUninitialized(NumWedges);
+	RawMesh.WedgeTangentZ.SetNumUninitialized(NumWedges);
+	RawMesh.WedgeTexCoords[0].SetNumUninitialized(NumWedges);
+	RawMesh.WedgeColors.SetNumUninitialized(NumWedges);
+	for (int32 w = 0; w < NumWedges; ++w) {
+		const int32 v = LOD.Triangles[w];
+		RawMesh.WedgeTangentX[w] = LOD.Tangents[v];
+		RawMesh.WedgeTangentY[w] = FVector::CrossProduct(LOD.Normals[v], LOD.Tangents[v]);
+		RawMesh.WedgeTangentZ[w] = LOD.Normals[v];
+		RawMesh.WedgeTexCoords[0][w] = LOD.UVs[v];
+		RawMesh.WedgeColors[w] = LOD.Colors[v];
+	}
+
+	RawMesh.FaceMaterialIndices.Init(0, NumWedges / 3);
+	RawMesh.FaceSmoothingMasks.Init(1, NumWedges / 3);
+}
+
+// Runs on a worker thread. The LODs are simplified in parallel; the convex 
+// decomposition runs on this thread, so that a conversion never blocks a pool
+// thread waiting for another pool task.
+bool PrepareScanAsset(const FString& ScanFilename, const FScanAssetOptions& Options, ScanAssetData& Data)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseScanAssetPrepare);
+
+	ScanMeshLOD Scan;
+	LoadMeshFile(ScanFilename, Scan.Vertices, Scan.Triangles, Scan.Colors, Scan.Normals, Scan.Tangents);
+	if ((Scan.Vertices.Num() == 0) || (Scan.Triangles.Num() == 0)) {
+		return false;
+	}
+
+	if (Options.SmoothingIterations > 0) {
+		SmoothMeshTaubin(Scan.Vertices, Scan.Triangles, Options.SmoothingIterations);
+		ComputeMeshNormalsAndTangents(Scan.Vertices, Scan.Triangles, Scan.Normals, Scan.Tangents);
+	}
+
+	if (Options.bGenerateCollision) {
+		const int32 MaxHulls = FMath::Max(Options.MaxCollisionHulls, 1);
+		if (LoadConvexHullCache(ScanFilename, Scan.Vertices, Scan.Triangles, MaxHulls, CollisionResolution, Data.Hulls) == false) {
+			ComputeConvexDecomposition(Scan.Vertices, Scan.Triangles, MaxHulls, CollisionResolution, Data.Hulls);
+			SaveConvexHullCache(ScanFilename, Scan.Vertices, Scan.Triangles, MaxHulls, CollisionResolution, Data.Hulls);
+		}
+	}
+
+	// LOD 0 is the full scan, split along the texture charts if baked
+	TArray<ScanMeshLOD> LODs;
+	LODs.SetNum(FMath::Max(Options.NumLODs, 1));
+	ScanMeshLOD& LOD0 = LODs[0];
+
+	FBakedColorAtlas Atlas;
+	if (Options.bBakeTexture && 
+		BakeVertexColorAtlas(Scan.Vertices, Scan.Triangles, Scan.Colors, FMath::Clamp(Options.TextureSize, 64, 8192), Atlas)) {
+		const int32 NumVertices = Atlas.Vertices.Num();
+		LOD0.Normals.SetNumUninitialized(NumVertices);
+		LOD0.Tangents.SetNumUninitialized(NumVertices);
+		LOD0.Colors.SetNumUninitialized(NumVertices);
+		for (int32 v = 0; v < NumVertices; ++v) {
+			LOD0.Normals[v] = Scan.Normals[Atlas.SourceVertices[v]];
+			LOD0.Tangents[v] = Scan.Tangents[Atlas.SourceVertices[v]];
+			LOD0.Colors[v] = Scan.Colors[Atlas.SourceVertices[v]];
+		}
+		LOD0.Vertices = MoveTemp(Atlas.Vertices);
+		LOD0.Triangles = MoveTemp(Atlas.Triangles);
+		LOD0.UVs = MoveTemp(Atlas.UVs);
+		LOD0.Groups = MoveTemp(Atlas.VertexCharts);
+		Data.TextureSize = Atlas.TextureSize;
+		Data.Texels = MoveTemp(Atlas.Texels);
+	}
+	else {
+		LOD0.Vertices = Scan.Vertices;
+		LOD0.Triangles = Scan.Triangles;
+		LOD0.Normals = Scan.Normals;
+		LOD0.Tangents = Scan.Tangents;
+		LOD0.Colors = Scan.Colors;
+		LOD0.UVs.SetNumZeroed(Scan.Vertices.Num());
+	}
+
+	const float Size = FBox(LOD0.Vertices.GetData(), LOD0.Vertices.Num()).GetSize().GetMax();
+	ParallelFor(LODs.Num() - 1, [&](int32 i) {
+		const int32 Resolution = FMath::Max(Options.LOD1Resolution >> i, 1);
+		SimplifyScanMesh(LOD0, Size / Resolution, LODs[i + 1]);
+	});
+
+	// Coarse LODs can collapse completely
+	int32 NumLODs = 1;
+	while ((NumLODs < LODs.Num()) && (LODs[NumLODs].Triangles.Num() > 0)) {
+		NumLODs++;
+	}
+
+	Data.LODs.SetNum(NumLODs);
+	ParallelFor(NumLODs, [&](int32 i) {
+		ConvertToRawMesh(LODs[i], Data.LODs[i]);
+	});
+
+	return true;
+}
+
+UObject* CreateAssetObject(UClass* Class, const FString& PackageName)
+{
+	UPackage* Package = CreatePackage(nullptr, *PackageName);
+	Package->FullyLoad();
+	const FString AssetName = FPackageName::GetLongPackageAssetName(PackageName);
+	return NewObject<UObject>(Package, Class, *AssetName, RF_Public | RF_Standalone);
+}
+
+// Creates the color texture and a material that samples it on UV 0
+UMaterialInterface* CreateScanMaterial(const FString& PackageName, ScanAssetData& Data)
+{
+	UTexture2D* Texture = CastChecked<UTexture2D>(CreateAssetObject(UTexture2D::StaticClass(), PackageName + TEXT("_Color")));
+	Texture->Source.Init(Data.TextureSize, Data.TextureSize, 1, 1, TSF_BGRA8, reinterpret_cast<const uint8*>(Data.Texels.GetData()));
+	Texture->SRGB = true;
+	Texture->PostEditChange();
+	Texture->MarkPackageDirty();
+	FAssetRegistryModule::AssetCreated(Texture);
+
+	UMaterial* Material = CastChecked<UMaterial>(CreateAssetObject(UMaterial::StaticClass(), PackageName + TEXT("_Material")));
+	UMaterialExpressionTextureSample* TextureSample = NewObject<UMaterialExpressionTextureSample>(Material);
+	TextureSample->Texture = Texture;
+	TextureSample->SamplerType = SAMPLERTYPE_Color;
+	TextureSample->MaterialExpressionEditorX = -300;
+	Material->Expressions.Add(TextureSample);
+	Material->BaseColor.Expression = TextureSample;
+	Material->PostEditChange();
+	Material->MarkPackageDirty();
+	FAssetRegistryModule::AssetCreated(Material);
+
+	return Material;
+}
+
+// Runs on the game thread
+UStaticMesh* CreateScanAssets(const FString& PackageName, ScanAssetData& Data)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseScanAssetCreate);
+
+	const bool bHasTexture = (Data.Texels.Num() > 0);
+	UMaterialInterface* Material = bHasTexture ? CreateScanMaterial(PackageName, Data) : UMaterial::GetDefaultMaterial(MD_Surface);
+	UStaticMesh* StaticMesh = CastChecked<UStaticMesh>(CreateAssetObject(UStaticMesh::StaticClass(), PackageName));
+
+	StaticMesh->LightingGuid = FGuid::NewGuid();
+	StaticMesh->LightMapCoordinateIndex = bHasTexture ? 1 : 0;
+	StaticMesh->bAutoComputeLODScreenSize = false;
+	StaticMesh->StaticMaterials.Add(FStaticMaterial(Material));
+
+	for (int32 i = 0; i < Data.LODs.Num(); ++i) {
+		FStaticMeshSourceModel* SourceModel = new(StaticMesh->SourceModels) FStaticMeshSourceModel();
+		SourceModel->RawMeshBulkData->SaveRawMesh(Data.LODs[i]);
+		SourceModel->BuildSettings.bRecomputeNormals = false;
+		SourceModel->BuildSettings.bRecomputeTangents = false;
+		SourceModel->BuildSettings.bGenerateLightmapUVs = bHasTexture;
+		SourceModel->BuildSettings.SrcLightmapIndex = 0;
+		SourceModel->BuildSettings.DstLightmapIndex = 1;
+		SourceModel->ScreenSize = 1.0f / (1 << i);
+	}
+
+	if (Data.Hulls.Num() > 0) {
+		StaticMesh->CreateBodySetup();
+		UBodySetup* BodySetup = StaticMesh->BodySetup;
+		BodySetup->RemoveSimpleCollision();
+		for (const FScanConvexHull& Hull : Data.Hulls) {
+			FKConvexElem Element;
+			Element.VertexData = Hull.Vertices;
+			Element.UpdateElemBox();
+			BodySetup->AggGeom.ConvexElems.Add(Element);
+		}
+		BodySetup->InvalidatePhysicsData();
+	}
+
+	StaticMesh->Build(true);
+	StaticMesh->MarkPackageDirty();
+	FAssetRegistryModule::AssetCreated(StaticMesh);
+
+	return StaticMesh;
+}
+
+}
+
+void ConvertScanToStaticMeshAsync(const FString& ScanFilename, const FString& PackageName, 
+								  const FScanAssetOptions& Options, TFunction<void(UStaticMesh*)> OnComplete)
+{
+	FText Reason;
+	if (FPackageName::IsValidLongPackageName(PackageName, false, &Reason) == false) {
+		RS_LOG(Error, "Invalid asset path %s: %s", *PackageName, *Reason.ToString())
+		if (OnComplete) {
+			OnComplete(nullptr);
+		}
+		return;
+	}
+
+	Async<void>(EAsyncExecution::ThreadPool, [ScanFilename, PackageName, Options, OnComplete]() {
+		TSharedPtr<ScanAssetData, ESPMode::ThreadSafe> Data = MakeShareable(new ScanAssetData());
+		if (PrepareScanAsset(ScanFilename, Options, *Data) == false) {
+			RS_LOG(Error, "Could not load the scan %s", *ScanFilename);
+			Data.Reset();
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [PackageName, Data, OnComplete]() {
+			UStaticMesh* StaticMesh = Data.IsValid() ? CreateScanAssets(PackageName, *Data) : nullptr;
+			if (OnComplete) {
+				OnComplete(StaticMesh);
+			}
+		});
+	});
+}
+
+#else
+
+void ConvertScanToStaticMeshAsync(const FString& ScanFilename, const FString& PackageName, 
+								  const FScanAssetOptions& Options, TFunction<void(UStaticMesh*)> OnComplete)
+{
+	RS_LOG(Warning, "Static mesh assets can only be created in the editor");
+	if (OnComplete) {
+		OnComplete(nullptr);
+	}
+}
+
+#endif
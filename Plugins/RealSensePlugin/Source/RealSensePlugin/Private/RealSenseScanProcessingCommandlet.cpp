@@ -0,0 +1,434 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "RealSenseScanProcessingCommandlet.h"
+#include "RealSenseMeshUtils.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Async.h"
+#include <atomic>
+
+// Voxel resolution of the convex decomposition, matching UScan3DComponent so
+// that the hulls written here are found by the component at runtime.
+static const int32 CollisionResolution = 48;
+
+// Thumbnails are rendered at this multiple of their size and filtered down
+static const int32 ThumbnailSupersampling = 2;
+
+namespace {
+
+enum ScanStage {
+	Load,
+	Clean,
+	Smooth,
+	Decimate,
+	Write,
+	Collision,
+	Thumbnail,
+	NumStages
+};
+
+const TCHAR* ScanStageNames[NumStages] = {
+	TEXT("Load"),
+	TEXT("Clean"),
+	TEXT("Smooth"),
+	TEXT("Decimate"),
+	TEXT("Write"),
+	TEXT("Collision"),
+	TEXT("Thumbnail"),
+};
+
+struct ScanProcessingSettings {
+	FString InputDirectory;
+	FString OutputDirectory;
+	int32 Jobs;
+	int32 SmoothIterations;
+	int32 Resolution;
+	int32 MaxHulls;
+	int32 ThumbnailSize;
+	float MinComponentFraction;
+	bool bForce;
+};
+
+// Time spent in each stage, summed over all files and worker threads
+struct ScanStageTimes {
+	std::atomic<uint64> Microseconds[NumStages];
+
+	ScanStageTimes()
+	{
+		for (int32 i = 0; i < NumStages; ++i) {
+			Microseconds[i] = 0;
+		}
+	}
+};
+
+// Adds the lifetime of the scope to the total of a stage
+class ScopedStageTimer {
+public:
+	ScopedStageTimer(ScanStageTimes& InTimes, ScanStage InStage) 
+		: Times(InTimes), Stage(InStage), StartTime(FPlatformTime::Seconds()) {}
+
+	~ScopedStageTimer()
+	{
+		Times.Microseconds[Stage] += static_cast<uint64>((FPlatformTime::Seconds() - StartTime) * 1000000.0);
+	}
+
+private:
+	ScanStageTimes& Times;
+	ScanStage Stage;
+	double StartTime;
+};
+
+// Describes the settings that affect the outputs of a scan. It is stored next
+// to the outputs, so that changing any of them reprocesses the scan.
+FString GetOutputSettingsString(const ScanProcessingSettings& Settings)
+{
+	return FString::Printf(TEXT("Smooth=%d Resolution=%d Hulls=%d HullResolution=%d ThumbnailSize=%d MinComponentFraction=%g"),
+						   Settings.SmoothIterations, Settings.Resolution, Settings.MaxHulls, CollisionResolution,
+						   Settings.ThumbnailSize, Settings.MinComponentFraction);
+}
+
+FString MakeAbsoluteDirectory(FString Directory)
+{
+	if (FPaths::IsRelative(Directory)) {
+		Directory = FPaths::GameContentDir() / Directory;
+	}
+	FPaths::NormalizeDirectoryName(Directory);
+	return Directory;
+}
+
+// Renders the vertex-colored mesh with a z-buffer from a three-quarter view
+// of its front, which faces -X after LoadMeshFile(), onto a transparent 
+// background.
+void RenderThumbnail(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, const TArray<FColor>& Colors,
+					 int32 Size, TArray<FColor>& Pixels)
+{
+	const int32 RenderSize = Size * ThumbnailSupersampling;
+
+	const float Yaw = FMath::DegreesToRadians(-25.0f);
+	const float Pitch = FMath::DegreesToRadians(15.0f);
+	const FVector Forward(FMath::Cos(Pitch) * FMath::Cos(Yaw), FMath::Cos(Pitch) * FMath::Sin(Yaw), -FMath::Sin(Pitch));
+	const FVector Right = FVector(-Forward.Y, Forward.X, 0.0f).GetSafeNormal();
+	const FVector Up = (FVector::UpVector - Forward * Forward.Z).GetSafeNormal();
+
+	// Fit the projected mesh into the image with a small margin
+	TArray<FVector> Projected;
+	Projected.SetNumUninitialized(Vertices.Num());
+	FVector2D Min(BIG_NUMBER, BIG_NUMBER);
+	FVector2D Max(-BIG_NUMBER, -BIG_NUMBER);
+	for (int32 v = 0; v < Vertices.Num(); ++v) {
+		Projected[v] = FVector(FVector::DotProduct(Vertices[v], Right), FVector::DotProduct(Vertices[v], Up),
+							   FVector::DotProduct(Vertices[v], Forward));
+		Min = FVector2D(FMath::Min(Min.X, Projected[v].X), FMath::Min(Min.Y, Projected[v].Y));
+		Max = FVector2D(FMath::Max(Max.X, Projected[v].X), FMath::Max(Max.Y, Projected[v].Y));
+	}
+	const FVector2D Center = (Min + Max) * 0.5f;
+	const float Scale = 0.9f * RenderSize / FMath::Max3(Max.X - Min.X, Max.Y - Min.Y, KINDA_SMALL_NUMBER);
+	for (FVector& P : Projected) {
+		P.X = (P.X - Center.X) * Scale + RenderSize * 0.5f;
+		P.Y = (Center.Y - P.Y) * Scale + RenderSize * 0.5f;
+	}
+
+	TArray<FColor> Image;
+	TArray<float> Depth;
+	Image.Init(FColor(0, 0, 0, 0), RenderSize * RenderSize);
+	Depth.Init(BIG_NUMBER, RenderSize * RenderSize);
+
+	for (int32 t = 0; t < Triangles.Num() / 3; ++t) {
+		const int32* Tri = Triangles.GetData() + 3 * t;
+		const FVector& A = Projected[Tri[0]];
+		const FVector& B = Projected[Tri[1]];
+		const FVector& C = Projected[Tri[2]];
+		const float Area = (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+		if (FMath::Abs(Area) < SMALL_NUMBER) {
+			continue;
+		}
+
+		// Headlight shading, independent of the winding of the scan
+		const FVector Normal = FVector::CrossProduct(Vertices[Tri[2]] - Vertices[Tri[0]], 
+													 Vertices[Tri[1]] - Vertices[Tri[0]]).GetSafeNormal();
+		const float Shade = 0.35f + 0.65f * FMath::Abs(FVector::DotProduct(Normal, Forward));
+
+		const int32 MinX = FMath::Max(FMath::FloorToInt(FMath::Min3(A.X, B.X, C.X)), 0);
+		const int32 MinY = FMath::Max(FMath::FloorToInt(FMath::Min3(A.Y, B.Y, C.Y)), 0);
+		const int32 MaxX = FMath::Min(FMath::CeilToInt(FMath::Max3(A.X, B.X, C.X)), RenderSize - 1);
+		const int32 MaxY = FMath::Min(FMath::CeilToInt(FMath::Max3(A.Y, B.Y, C.Y)), RenderSize - 1);
+
+		for (int32 y = MinY; y <= MaxY; ++y) {
+			const float Y = y + 0.5f;
+			for (int32 x = MinX; x <= MaxX; ++x) {
+				const float X = x + 0.5f;
+				const float W0 = ((B.X - X) * (C.Y - Y) - (B.Y - Y) * (C.X - X)) / Area;
+				const float W1 = ((C.X - X) * (A.Y - Y) - (C.Y - Y) * (A.X - X)) / Area;
+				const float W2 = 1.0f - W0 - W1;
+				if ((W0 < 0.0f) || (W1 < 0.0f) || (W2 < 0.0f)) {
+					continue;
+				}
+				const int32 i = y * RenderSize + x;
+				const float Z = W0 * A.Z + W1 * B.Z + W2 * C.Z;
+				if (Z >= Depth[i]) {
+					continue;
+				}
+				Depth[i] = Z;
+				const FColor& C0 = Colors[Tri[0]];
+				const FColor& C1 = Colors[Tri[1]];
+				const FColor& C2 = Colors[Tri[2]];
+				Image[i] = FColor(
+					static_cast<uint8>(FMath::Min((W0 * C0.R + W1 * C1.R + W2 * C2.R) * Shade, 255.0f)),
+					static_cast<uint8>(FMath::Min((W0 * C0.G + W1 * C1.G + W2 * C2.G) * Shade, 255.0f)),
+					static_cast<uint8>(FMath::Min((W0 * C0.B + W1 * C1.B + W2 * C2.B) * Shade, 255.0f)),
+					255);
+			}
+		}
+	}
+
+	// Box filter down to the thumbnail size
+	const int32 Samples = ThumbnailSupersampling * ThumbnailSupersampling;
+	Pixels.SetNumUninitialized(Size * Size);
+	for (int32 y = 0; y < Size; ++y) {
+		for (int32 x = 0; x < Size; ++x) {
+			uint32 Sum[4] = { 0, 0, 0, 0 };
+			for (int32 sy = 0; sy < ThumbnailSupersampling; ++sy) {
+				for (int32 sx = 0; sx < ThumbnailSupersampling; ++sx) {
+					const FColor& S = Image[(y * ThumbnailSupersampling + sy) * RenderSize + x * ThumbnailSupersampling + sx];
+					Sum[0] += S.R;
+					Sum[1] += S.G;
+					Sum[2] += S.B;
+					Sum[3] += S.A;
+				}
+			}
+			Pixels[y * Size + x] = FColor(Sum[0] / Samples, Sum[1] / Samples, Sum[2] / Samples, Sum[3] / Samples);
+		}
+	}
+}
+
+// Runs all stages for one scan. The meshes of a scan are released before the
+// worker moves on, so memory is bounded by the number of jobs.
+bool ProcessScan(const FString& ScanFilename, const FString& OutputFilename, const FString& ThumbnailFilename,
+				 const ScanProcessingSettings& Settings, IImageWrapperModule& ImageWrapperModule, ScanStageTimes& Times)
+{
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FColor> Colors;
+	TArray<FVector> Normals;
+	TArray<FVector> Tangents;
+
+	{
+		ScopedStageTimer Timer(Times, Load);
+		LoadMeshFile(ScanFilename, Vertices, Triangles, Colors, Normals, Tangents);
+		if ((Vertices.Num() == 0) || (Triangles.Num() == 0)) {
+			return false;
+		}
+	}
+
+	{
+		ScopedStageTimer Timer(Times, Clean);
+		TArray<int32> Remap;
+		CleanMesh(Vertices, Triangles, Settings.MinComponentFraction, Remap);
+		TArray<FColor> CleanColors;
+		CleanColors.SetNumUninitialized(Vertices.Num());
+		for (int32 v = 0; v < Remap.Num(); ++v) {
+			if (Remap[v] != INDEX_NONE) {
+				CleanColors[Remap[v]] = Colors[v];
+			}
+		}
+		Colors = MoveTemp(CleanColors);
+		if (Triangles.Num() == 0) {
+			return false;
+		}
+	}
+
+	if (Settings.SmoothIterations > 0) {
+		ScopedStageTimer Timer(Times, Smooth);
+		SmoothMeshTaubin(Vertices, Triangles, Settings.SmoothIterations);
+	}
+
+	if (Settings.Resolution > 0) {
+		ScopedStageTimer Timer(Times, Decimate);
+		const float CellSize = FBox(Vertices.GetData(), Vertices.Num()).GetSize().GetMax() / Settings.Resolution;
+		TArray<int32> Clusters;
+		TArray<FVector> ClusteredVertices;
+		TArray<int32> ClusteredTriangles;
+		ClusterMeshVertices(Vertices, Triangles, TArray<int32>(), CellSize, Clusters, ClusteredVertices, ClusteredTriangles);
+
+		TArray<FVector4> ColorSums;
+		ColorSums.SetNumZeroed(ClusteredVertices.Num());
+		for (int32 v = 0; v < Clusters.Num(); ++v) {
+			ColorSums[Clusters[v]] += FVector4(Colors[v].R, Colors[v].G, Colors[v].B, 1.0f);
+		}
+		Colors.SetNumUninitialized(ClusteredVertices.Num());
+		for (int32 c = 0; c < ColorSums.Num(); ++c) {
+			const FVector4 Color = ColorSums[c] * (1.0f / ColorSums[c].W);
+			Colors[c] = FColor(static_cast<uint8>(Color.X), static_cast<uint8>(Color.Y), static_cast<uint8>(Color.Z));
+		}
+		Vertices = MoveTemp(ClusteredVertices);
+		Triangles = MoveTemp(ClusteredTriangles);
+	}
+
+	{
+		ScopedStageTimer Timer(Times, Write);
+		if (SaveMeshFile(OutputFilename, Vertices, Triangles, Colors, TArray<FVector>()) == false) {
+			return false;
+		}
+	}
+
+	if (Settings.MaxHulls > 0) {
+		ScopedStageTimer Timer(Times, Collision);
+		// The cache is keyed by the mesh as LoadMeshFile() returns it, which
+		// is recentered and rescaled, so the hulls are computed on the file 
+		// that was just written.
+		TArray<FVector> LoadedVertices;
+		TArray<int32> LoadedTriangles;
+		TArray<FColor> LoadedColors;
+		LoadMeshFile(OutputFilename, LoadedVertices, LoadedTriangles, LoadedColors, Normals, Tangents);
+		TArray<FScanConvexHull> Hulls;
+		ComputeConvexDecomposition(LoadedVertices, LoadedTriangles, Settings.MaxHulls, CollisionResolution, Hulls);
+		if (SaveConvexHullCache(OutputFilename, LoadedVertices, LoadedTriangles, Settings.MaxHulls, CollisionResolution, Hulls) == false) {
+			return false;
+		}
+	}
+
+	if (Settings.ThumbnailSize > 0) {
+		ScopedStageTimer Timer(Times, Thumbnail);
+		TArray<FColor> Pixels;
+		RenderThumbnail(Vertices, Triangles, Colors, Settings.ThumbnailSize, Pixels);
+		IImageWrapperPtr ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+		if (ImageWrapper.IsValid() == false ||
+			ImageWrapper->SetRaw(Pixels.GetData(), Pixels.Num() * sizeof(FColor), Settings.ThumbnailSize, 
+								 Settings.ThumbnailSize, ERGBFormat::BGRA, 8) == false) {
+			return false;
+		}
+		if (FFileHelper::SaveArrayToFile(ImageWrapper->GetCompressed(), *ThumbnailFilename) == false) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+}
+
+URealSenseScanProcessingCommandlet::URealSenseScanProcessingCommandlet(const class FObjectInitializer& ObjInit)
+	: Super(ObjInit)
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+// Each worker thread pulls the next scan from a shared counter, so a fixed 
+// number of scans are in memory at any time while the stages themselves 
+// still use ParallelFor internally.
+int32 URealSenseScanProcessingCommandlet::Main(const FString& Params)
+{
+	ScanProcessingSettings Settings;
+	Settings.Jobs = FMath::Max(FPlatformMisc::NumberOfCores() / 2, 1);
+	Settings.SmoothIterations = 5;
+	Settings.Resolution = 256;
+	Settings.MaxHulls = 16;
+	Settings.ThumbnailSize = 256;
+	Settings.MinComponentFraction = 0.01f;
+	Settings.bForce = FParse::Param(*Params, TEXT("Force"));
+
+	if (FParse::Value(*Params, TEXT("Input="), Settings.InputDirectory) == false) {
+		RS_LOG(Error, "Missing -Input=<Directory>");
+		return 1;
+	}
+	Settings.InputDirectory = MakeAbsoluteDirectory(Settings.InputDirectory);
+	if (FParse::Value(*Params, TEXT("Output="), Settings.OutputDirectory)) {
+		Settings.OutputDirectory = MakeAbsoluteDirectory(Settings.OutputDirectory);
+	}
+	else {
+		Settings.OutputDirectory = Settings.InputDirectory / TEXT("Processed");
+	}
+	FParse::Value(*Params, TEXT("Jobs="), Settings.Jobs);
+	FParse::Value(*Params, TEXT("Smooth="), Settings.SmoothIterations);
+	FParse::Value(*Params, TEXT("Resolution="), Settings.Resolution);
+	FParse::Value(*Params, TEXT("Hulls="), Settings.MaxHulls);
+	FParse::Value(*Params, TEXT("ThumbnailSize="), Settings.ThumbnailSize);
+	Settings.Jobs = FMath::Max(Settings.Jobs, 1);
+
+	IFileManager& FileManager = IFileManager::Get();
+	TArray<FString> ScanFiles;
+	FileManager.FindFiles(ScanFiles, *(Settings.InputDirectory / TEXT("*.obj")), true, false);
+	if (FileManager.MakeDirectory(*Settings.OutputDirectory, true) == false) {
+		RS_LOG(Error, "Could not create %s", *Settings.OutputDirectory);
+		return 1;
+	}
+
+	// Modules have to be loaded on the main thread
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+
+	const FString OutputSettings = GetOutputSettingsString(Settings);
+
+	RS_LOG(Display, "Processing %d scans in %s with %d jobs", ScanFiles.Num(), *Settings.InputDirectory, Settings.Jobs);
+	const double StartTime = FPlatformTime::Seconds();
+
+	ScanStageTimes Times;
+	std::atomic<int32> NextScan(0);
+	std::atomic<int32> NumProcessed(0);
+	std::atomic<int32> NumSkipped(0);
+	std::atomic<int32> NumFailed(0);
+
+	TArray<TFuture<void>> Workers;
+	for (int32 j = 0; j < FMath::Min(Settings.Jobs, ScanFiles.Num()); ++j) {
+		Workers.Add(Async<void>(EAsyncExecution::Thread, [&]() {
+			for (int32 i = NextScan++; i < ScanFiles.Num(); i = NextScan++) {
+				const FString ScanFilename = Settings.InputDirectory / ScanFiles[i];
+				const FString OutputFilename = Settings.OutputDirectory / ScanFiles[i];
+				const FString ThumbnailFilename = FPaths::ChangeExtension(OutputFilename, TEXT("png"));
+				const FString SettingsFilename = FPaths::ChangeExtension(OutputFilename, TEXT("settings"));
+
+				// Up to date if every output is at least as new as the scan and
+				// was written with the same settings
+				const FDateTime ScanTime = FileManager.GetTimeStamp(*ScanFilename);
+				auto IsUpToDate = [&FileManager, &ScanTime](const FString& Filename) {
+					const FDateTime Time = FileManager.GetTimeStamp(*Filename);
+					return (Time != FDateTime::MinValue()) && (Time >= ScanTime);
+				};
+				FString PreviousSettings;
+				if ((Settings.bForce == false) && IsUpToDate(OutputFilename) &&
+					((Settings.MaxHulls <= 0) || IsUpToDate(GetConvexHullCacheFilename(OutputFilename))) &&
+					((Settings.ThumbnailSize <= 0) || IsUpToDate(ThumbnailFilename)) &&
+					FFileHelper::LoadFileToString(PreviousSettings, *SettingsFilename) && (PreviousSettings == OutputSettings)) {
+					NumSkipped++;
+					continue;
+				}
+
+				if (ProcessScan(ScanFilename, OutputFilename, ThumbnailFilename, Settings, ImageWrapperModule, Times) &&
+					FFileHelper::SaveStringToFile(OutputSettings, *SettingsFilename)) {
+					NumProcessed++;
+				}
+				else {
+					RS_LOG(Warning, "Failed to process %s", *ScanFilename);
+					NumFailed++;
+				}
+			}
+		}));
+	}
+	for (TFuture<void>& Worker : Workers) {
+		Worker.Wait();
+	}
+
+	RS_LOG(Display, "%d processed, %d up to date, %d failed in %.2f s", NumProcessed.load(), NumSkipped.load(),
+		   NumFailed.load(), FPlatformTime::Seconds() - StartTime);
+	for (int32 s = 0; s < NumStages; ++s) {
+		RS_LOG(Display, "  %-10s %10.2f s", ScanStageNames[s], Times.Microseconds[s].load() / 1000000.0);
+	}
+
+	return (NumFailed.load() == 0) ? 0 : 1;
+}
@@ -15,22 +15,92 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 #include "RealSensePluginPrivatePCH.h"
 #include "RealSenseSessionManager.h"
+#include "TriggerVolumeComponent.h"
+#include "LatencyProbe.h"
 
-// Initialized the feature set to 0 (no features enabled) and creates a new
-// RealSenseImpl object.
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Depth Valid Ratio"), STAT_RealSenseDepthValidRatio, STATGROUP_RealSense);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Depth Hole Count"), STAT_RealSenseDepthHoleCount, STATGROUP_RealSense);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Depth Hole Area"), STAT_RealSenseDepthHoleArea, STATGROUP_RealSense);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Depth Temporal Noise (mm)"), STAT_RealSenseDepthTemporalNoise, STATGROUP_RealSense);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Depth Median (mm)"), STAT_RealSenseDepthMedian, STATGROUP_RealSense);
+
+// Initialized the feature set to 0 (no features enabled) and attaches to the
+// RealSenseImpl object owned by the plugin module.
 ARealSenseSessionManager::ARealSenseSessionManager(const class FObjectInitializer& Init)
 	: Super(Init)
 {
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bTickEvenWhenPaused = true;
 
 	RealSenseFeatureSet = 0;
 
-	impl = std::unique_ptr<RealSenseImpl>(new RealSenseImpl());
+	bScanBufferEnabled = true;
+
+	CaptureIdleSeconds = 0.0f;
+	CaptureKeepAliveFPS = 0.0f;
+	LastDataAccessTime = 0.0;
+
+	ReplayTime = 0.0;
+	ReplayEndTime = 0.0;
+	ReplaySpeed = 1.0f;
+
+	NextTriggerVolumeId = 0;
+	bTriggerVolumesChanged = false;
+
+	// Default objects are constructed while the module is being loaded, before
+	// it can hand out the capture pipeline, and never use it.
+	if (HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject)) {
+		return;
+	}
+
+	// The pipeline may still be streaming from a previous level, in which 
+	// case the buffers take the size of its current resolutions.
+	impl = IRealSensePlugin::Get().GetCaptureService();
+	ColorBuffer.SetNumUninitialized(impl->GetColorImageWidth() * impl->GetColorImageHeight());
+	HeadCropBuffer.SetNumZeroed(impl->GetHeadCropImageWidth() * impl->GetHeadCropImageHeight());
 }
 
 void ARealSenseSessionManager::BeginPlay() 
 {
 	Super::BeginPlay();
+
+	LastDataAccessTime = FPlatformTime::Seconds();
+}
+
+// The camera keeps running when the level of this actor is unloaded, so that
+// the next level can attach to it. The features, trigger volumes, processing
+// options, recording and throttling of this level are removed from the 
+// pipeline; components of the next level enable what they need again.
+void ARealSenseSessionManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (LatencyTestProbe) {
+		StopLatencyTest();
+	}
+
+	if ((EndPlayReason == EEndPlayReason::LevelTransition) || (EndPlayReason == EEndPlayReason::RemovedFromWorld)) {
+		const RealSenseFeature Features[] = { RealSenseFeature::CAMERA_STREAMING, RealSenseFeature::SCAN_3D, 
+											  RealSenseFeature::HEAD_TRACKING, RealSenseFeature::SEGMENTATION_3D };
+		for (RealSenseFeature Feature : Features) {
+			if (RealSenseFeatureSet & Feature) {
+				DisableFeature(Feature);
+			}
+		}
+		impl->SetTriggerVolumes(TArray<TriggerVolume>());
+		impl->StopFrameRecording();
+		impl->DisableHeadCrop();
+		impl->DisableHeadPoseQueue();
+		impl->DisableDepthUpsampling();
+		impl->DisableDistanceField();
+		impl->DisableTouchDetection();
+		impl->DisableBodyBounds();
+		impl->ClearFloorPlane();
+		impl->SetCaptureThrottled(false, 0.0f);
+	}
+	else {
+		impl->StopCamera();
+	}
 }
 
 // Grab a new frame of RealSense data and process it based on the current
@@ -43,6 +113,17 @@ void ARealSenseSessionManager::Tick(float DeltaTime)
 		return;
 	}
 
+	// Components do not tick while the game is paused, so the capture is
+	// throttled once the idle interval has passed.
+	UpdateCaptureThrottling();
+	if (GetWorld()->IsPaused()) {
+		return;
+	}
+
+	if (impl->IsReplaying()) {
+		UpdateReplay(DeltaTime);
+	}
+
 	// Grab the next frame of RealSense data
 	impl->SwapFrames();
 
@@ -52,26 +133,155 @@ void ARealSenseSessionManager::Tick(float DeltaTime)
 		const uint32 ColorImageSize = impl->GetColorImageWidth() * impl->GetColorImageHeight() * bytesPerPixel;
 		FMemory::Memcpy(ColorBuffer.GetData(), impl->GetColorBuffer(), ColorImageSize);
 
+		if (LatencyTestProbe) {
+			LatencyTestProbe->RecordPickup(reinterpret_cast<const uint8*>(ColorBuffer.GetData()), 
+										   impl->GetColorImageWidth(), impl->GetColorImageHeight());
+		}
+
 		// Update the DepthBuffer
 		DepthBuffer.Empty();
 		const uint32 DepthImageSize = impl->GetDepthImageWidth() * impl->GetDepthImageHeight();
 		for (auto it = impl->GetDepthBuffer(), end = it + DepthImageSize; it != end; it++) {
 			DepthBuffer.Add(*it);
 		}
+
+		const FDepthQualityMetrics DepthQuality = impl->GetDepthQuality();
+		SET_FLOAT_STAT(STAT_RealSenseDepthValidRatio, DepthQuality.ValidRatio);
+		SET_DWORD_STAT(STAT_RealSenseDepthHoleCount, DepthQuality.HoleCount);
+		SET_DWORD_STAT(STAT_RealSenseDepthHoleArea, DepthQuality.HoleArea);
+		SET_FLOAT_STAT(STAT_RealSenseDepthTemporalNoise, DepthQuality.TemporalNoise);
+		SET_DWORD_STAT(STAT_RealSenseDepthMedian, DepthQuality.MedianDepth);
+
+		// Update the UpsampledDepthBuffer
+		if (impl->IsDepthUpsamplingEnabled()) {
+			const uint32 UpsampledDepthImageSize = impl->GetUpsampledDepthImageWidth() * impl->GetUpsampledDepthImageHeight();
+			UpsampledDepthBuffer.SetNumUninitialized(UpsampledDepthImageSize);
+			const uint16* UpsampledDepth = impl->GetUpsampledDepthBuffer();
+			for (uint32 i = 0; i < UpsampledDepthImageSize; i++) {
+				UpsampledDepthBuffer[i] = UpsampledDepth[i];
+			}
+		}
+	}
+
+	if (RealSenseFeatureSet & RealSenseFeature::CAMERA_STREAMING) {
+		UpdateTriggerVolumes();
+
+		// Update the TouchPoints
+		if (impl->IsTouchDetectionEnabled()) {
+			TouchPoints = impl->GetTouchPoints();
+		}
+	}
+
+	if (impl->IsDistanceFieldEnabled()) {
+		// Update the DistanceFieldBuffer
+		const FStreamResolution DistanceFieldResolution = impl->GetDistanceFieldResolution();
+		const uint32 DistanceFieldImageSize = DistanceFieldResolution.width * DistanceFieldResolution.height * impl->GetDistanceFieldBytesPerPixel();
+		DistanceFieldBuffer.SetNumUninitialized(DistanceFieldImageSize);
+		FMemory::Memcpy(DistanceFieldBuffer.GetData(), impl->GetDistanceFieldBuffer(), DistanceFieldImageSize);
 	}
 
-	if (RealSenseFeatureSet & RealSenseFeature::SCAN_3D) {
+	if ((RealSenseFeatureSet & RealSenseFeature::SCAN_3D) && bScanBufferEnabled) {
 		const uint8 bytesPerPixel = 4;
 		const uint32 Scan3DImageSize = impl->GetScan3DImageWidth() * impl->GetScan3DImageHeight();
-		if (impl->HasScan3DImageSizeChanged()) {
+		if (impl->HasScan3DImageSizeChanged() || (ScanBuffer.Num() != Scan3DImageSize)) {
 			ScanBuffer.SetNumUninitialized(Scan3DImageSize);
 		}
 	
 		// Update the ScanBuffer
-		if (ScanBuffer.Num() == Scan3DImageSize) {
+		if ((ScanBuffer.Num() == Scan3DImageSize) && (impl->GetScanBufferSize() == Scan3DImageSize * bytesPerPixel)) {
 			FMemory::Memcpy(ScanBuffer.GetData(), impl->GetScanBuffer(), Scan3DImageSize * bytesPerPixel);
 		}
 	}
+
+	if ((RealSenseFeatureSet & RealSenseFeature::HEAD_TRACKING) && impl->IsHeadCropEnabled()) {
+		// Update the HeadCropBuffer
+		const uint8 bytesPerPixel = 4;
+		const uint32 HeadCropImageSize = impl->GetHeadCropImageWidth() * impl->GetHeadCropImageHeight();
+		if (HeadCropBuffer.Num() == HeadCropImageSize) {
+			FMemory::Memcpy(HeadCropBuffer.GetData(), impl->GetHeadCropBuffer(), HeadCropImageSize * bytesPerPixel);
+		}
+	}
+}
+
+// Registered trigger volumes are tested against every frame, so they count as
+// an access on every tick.
+void ARealSenseSessionManager::UpdateCaptureThrottling()
+{
+	if (TriggerVolumes.Num() > 0) {
+		LastDataAccessTime = FPlatformTime::Seconds();
+	}
+
+	const bool bIdle = (CaptureIdleSeconds > 0.0f) && (FPlatformTime::Seconds() - LastDataAccessTime > CaptureIdleSeconds);
+	if (bIdle && (impl->IsCaptureThrottled() == false)) {
+		RS_LOG(Log, "No RealSense data accessed for %.1f s, throttling capture to %.1f fps", CaptureIdleSeconds, CaptureKeepAliveFPS)
+		impl->SetCaptureThrottled(true, CaptureKeepAliveFPS);
+	}
+	else if ((bIdle == false) && impl->IsCaptureThrottled()) {
+		impl->SetCaptureThrottled(false, CaptureKeepAliveFPS);
+	}
+}
+
+// The recording keeps going during the replay, so the replay time is clamped
+// to the frames that are still recorded.
+void ARealSenseSessionManager::UpdateReplay(float DeltaTime)
+{
+	double Oldest, Newest;
+	if (impl->GetRecordedRange(Oldest, Newest) == false) {
+		return;
+	}
+
+	ReplayTime += DeltaTime * ReplaySpeed;
+	if ((ReplaySpeed > 0.0f) && (ReplayTime > ReplayEndTime)) {
+		impl->StopReplay();
+		return;
+	}
+
+	ReplayTime = FMath::Clamp(ReplayTime, Oldest, Newest);
+	impl->SetReplayTime(ReplayTime);
+}
+
+// Sends changed volumes and the camera transform to the camera processing 
+// thread, then compares the occupied volumes of the latest frame with those 
+// of the previous frame. Both lists are sorted by identifier, so only the 
+// volumes that are or were occupied are visited.
+void ARealSenseSessionManager::UpdateTriggerVolumes()
+{
+	if (bTriggerVolumesChanged) {
+		TArray<TriggerVolume> Volumes;
+		TriggerVolumes.GenerateValueArray(Volumes);
+		impl->SetTriggerVolumes(Volumes);
+		bTriggerVolumesChanged = false;
+	}
+	impl->SetCameraTransform(GetActorTransform());
+
+	const TArray<FIntPoint>& Occupancy = impl->GetTriggerOccupancy();
+
+	auto Notify = [this](int32 Id, int32 Count) {
+		const TWeakObjectPtr<UTriggerVolumeComponent>* Component = TriggerVolumeComponents.Find(Id);
+		if (Component && Component->IsValid()) {
+			(*Component)->UpdatePointCount(Count);
+		}
+	};
+
+	int32 i = 0;
+	int32 j = 0;
+	while ((i < Occupancy.Num()) || (j < TriggerOccupancy.Num())) {
+		if ((j == TriggerOccupancy.Num()) || ((i < Occupancy.Num()) && (Occupancy[i].X < TriggerOccupancy[j].X))) {
+			Notify(Occupancy[i].X, Occupancy[i].Y);
+			i++;
+		}
+		else if ((i == Occupancy.Num()) || (TriggerOccupancy[j].X < Occupancy[i].X)) {
+			Notify(TriggerOccupancy[j].X, 0);
+			j++;
+		}
+		else {
+			Notify(Occupancy[i].X, Occupancy[i].Y);
+			i++;
+			j++;
+		}
+	}
+
+	TriggerOccupancy = Occupancy;
 }
 
 void ARealSenseSessionManager::EnableFeature(RealSenseFeature feature)
@@ -96,8 +306,19 @@ bool ARealSenseSessionManager::IsCameraRunning() const
 	return impl->IsCameraThreadRunning();
 }
 
+void ARealSenseSessionManager::PrewarmCamera()
+{
+	impl->PrewarmCamera();
+}
+
+bool ARealSenseSessionManager::IsCameraPrewarmed() const
+{
+	return impl->IsCameraPrewarmed();
+}
+
 void ARealSenseSessionManager::StartCamera() 
 { 
+	LastDataAccessTime = FPlatformTime::Seconds();
 	impl->StartCamera(); 
 }
 
@@ -106,6 +327,102 @@ void ARealSenseSessionManager::StopCamera()
 	impl->StopCamera(); 
 }
 
+void ARealSenseSessionManager::SetCaptureThrottling(float IdleSeconds, float KeepAliveFPS)
+{
+	CaptureIdleSeconds = FMath::Max(IdleSeconds, 0.0f);
+	CaptureKeepAliveFPS = FMath::Max(KeepAliveFPS, 0.0f);
+	if (impl->IsCaptureThrottled()) {
+		impl->SetCaptureThrottled(CaptureIdleSeconds > 0.0f, CaptureKeepAliveFPS);
+	}
+}
+
+// Resumes the camera processing thread right away instead of waiting for the 
+// next Tick(), so that the data catches up as soon as possible.
+void ARealSenseSessionManager::NotifyDataAccess()
+{
+	LastDataAccessTime = FPlatformTime::Seconds();
+	if (impl->IsCaptureThrottled()) {
+		impl->SetCaptureThrottled(false, CaptureKeepAliveFPS);
+	}
+}
+
+bool ARealSenseSessionManager::IsCaptureThrottled() const
+{
+	return impl->IsCaptureThrottled();
+}
+
+void ARealSenseSessionManager::EnableFrameRecording(float DurationSeconds, int32 MemoryLimitMB)
+{
+	impl->StartFrameRecording(FMath::Max(DurationSeconds, 0.0f), static_cast<uint64>(FMath::Max(MemoryLimitMB, 0)) << 20);
+}
+
+void ARealSenseSessionManager::DisableFrameRecording()
+{
+	impl->StopFrameRecording();
+}
+
+bool ARealSenseSessionManager::IsFrameRecordingEnabled() const
+{
+	return impl->IsFrameRecording();
+}
+
+float ARealSenseSessionManager::GetRecordedSeconds() const
+{
+	double Oldest, Newest;
+	if (impl->GetRecordedRange(Oldest, Newest) == false) {
+		return 0.0f;
+	}
+	return static_cast<float>(Newest - Oldest);
+}
+
+void ARealSenseSessionManager::StartReplay(float SecondsAgo, float Speed)
+{
+	double Oldest, Newest;
+	if (impl->GetRecordedRange(Oldest, Newest) == false) {
+		return;
+	}
+
+	impl->StartReplay();
+	ReplayEndTime = Newest;
+	ReplaySpeed = Speed;
+	SeekReplay(SecondsAgo);
+}
+
+void ARealSenseSessionManager::SeekReplay(float SecondsAgo)
+{
+	double Oldest, Newest;
+	if ((impl->IsReplaying() == false) || (impl->GetRecordedRange(Oldest, Newest) == false)) {
+		return;
+	}
+
+	ReplayTime = FMath::Clamp(Newest - SecondsAgo, Oldest, Newest);
+	impl->SetReplayTime(ReplayTime);
+}
+
+void ARealSenseSessionManager::SetReplaySpeed(float Speed)
+{
+	ReplaySpeed = Speed;
+}
+
+void ARealSenseSessionManager::StopReplay()
+{
+	impl->StopReplay();
+}
+
+bool ARealSenseSessionManager::IsReplaying() const
+{
+	return impl->IsReplaying();
+}
+
+float ARealSenseSessionManager::GetReplaySecondsAgo() const
+{
+	double Oldest, Newest;
+	if ((impl->IsReplaying() == false) || (impl->GetRecordedRange(Oldest, Newest) == false)) {
+		return 0.0f;
+	}
+	return static_cast<float>(Newest - ReplayTime);
+}
+
 int32 ARealSenseSessionManager::GetColorImageWidth() const
 { 
 	return impl->GetColorImageWidth(); 
@@ -193,6 +510,39 @@ bool ARealSenseSessionManager::IsStreamSetValid(EColorResolution ColorResolution
 	return impl->IsStreamSetValid(ColorResolution, DepthResolution);
 }
 
+FRealSenseFrameSnapshot ARealSenseSessionManager::GetFrameSnapshot() const
+{
+	return FRealSenseFrameSnapshot(impl->GetFrameSnapshot(), 
+								   impl->GetColorCameraResolution(), impl->GetDepthCameraResolution(),
+								   impl->GetScan3DResolution(), impl->GetHeadCropResolution(),
+								   impl->GetUpsampledDepthResolution(), impl->GetDistanceFieldResolution());
+}
+
+uint64 ARealSenseSessionManager::GetFrameNumber() const
+{
+	return impl->GetFrameNumber();
+}
+
+int64 ARealSenseSessionManager::GetFrameSensorTimestamp() const
+{
+	return impl->GetFrameSensorTimestamp();
+}
+
+double ARealSenseSessionManager::GetFrameTimestamp() const
+{
+	return impl->GetFrameTimestamp();
+}
+
+double ARealSenseSessionManager::GetFrameTimestampUncertainty() const
+{
+	return impl->GetFrameTimestampUncertainty();
+}
+
+double ARealSenseSessionManager::GetClockDriftPPM() const
+{
+	return impl->GetClockDriftPPM();
+}
+
 TArray<FSimpleColor> ARealSenseSessionManager::GetColorBuffer() const
 { 
 	return ColorBuffer; 
@@ -203,6 +553,116 @@ TArray<int32> ARealSenseSessionManager::GetDepthBuffer() const
 	return DepthBuffer; 
 }
 
+FDepthQualityMetrics ARealSenseSessionManager::GetDepthQuality() const
+{
+	return impl->GetDepthQuality();
+}
+
+void ARealSenseSessionManager::EnableDepthUpsampling(EDepthUpsampleScale Scale)
+{
+	impl->EnableDepthUpsampling(Scale);
+}
+
+void ARealSenseSessionManager::DisableDepthUpsampling()
+{
+	impl->DisableDepthUpsampling();
+}
+
+int32 ARealSenseSessionManager::GetUpsampledDepthImageWidth() const
+{
+	return impl->GetUpsampledDepthImageWidth();
+}
+
+int32 ARealSenseSessionManager::GetUpsampledDepthImageHeight() const
+{
+	return impl->GetUpsampledDepthImageHeight();
+}
+
+TArray<int32> ARealSenseSessionManager::GetUpsampledDepthBuffer() const
+{
+	return UpsampledDepthBuffer;
+}
+
+float ARealSenseSessionManager::GetDepthUpsampleMilliseconds() const
+{
+	return impl->GetDepthUpsampleMilliseconds();
+}
+
+void ARealSenseSessionManager::EnableDistanceField(EDistanceFieldSource Source, int32 Width, int32 Height,
+													EDistanceFieldFormat Format, float MaxDistance)
+{
+	impl->EnableDistanceField(Source, Width, Height, Format, MaxDistance);
+}
+
+void ARealSenseSessionManager::DisableDistanceField()
+{
+	impl->DisableDistanceField();
+}
+
+void ARealSenseSessionManager::SetDistanceFieldDepthRange(int32 NearDepth, int32 FarDepth)
+{
+	impl->SetDistanceFieldDepthRange(NearDepth, FarDepth);
+}
+
+int32 ARealSenseSessionManager::GetDistanceFieldImageWidth() const
+{
+	return impl->GetDistanceFieldResolution().width;
+}
+
+int32 ARealSenseSessionManager::GetDistanceFieldImageHeight() const
+{
+	return impl->GetDistanceFieldResolution().height;
+}
+
+TArray<uint8> ARealSenseSessionManager::GetDistanceFieldBuffer() const
+{
+	return DistanceFieldBuffer;
+}
+
+void ARealSenseSessionManager::StartLatencyTest(float FramesPerSecond)
+{
+	if (impl->GetColorImageWidth() == 0) {
+		RS_LOG(Warning, "Latency test needs the color camera resolution to be set")
+		return;
+	}
+
+	LatencyTestProbe = std::make_shared<LatencyProbe>();
+	impl->SetSyntheticSource(true, FramesPerSecond);
+	RS_LOG(Log, "Latency test started with %d x %d color at %.1f fps", impl->GetColorImageWidth(), 
+		   impl->GetColorImageHeight(), FramesPerSecond)
+}
+
+// Waits for the render commands of the probe, so that the report includes 
+// the uploads of the last frames.
+void ARealSenseSessionManager::StopLatencyTest()
+{
+	if (LatencyTestProbe == nullptr) {
+		return;
+	}
+
+	FlushRenderingCommands();
+	RS_LOG(Log, "Latency of %d x %d color frames:", impl->GetColorImageWidth(), impl->GetColorImageHeight())
+	RS_LOG(Log, "  Game thread: %s", *LatencyTestProbe->GetPickupDistribution().ToString())
+	RS_LOG(Log, "  Uploaded:    %s (%d read back)", *LatencyTestProbe->GetUploadDistribution().ToString(), 
+		   LatencyTestProbe->GetVerifiedUploads())
+
+	LatencyTestProbe.reset();
+	impl->SetSyntheticSource(false, 0.0f);
+}
+
+bool ARealSenseSessionManager::IsLatencyTestRunning() const
+{
+	return (LatencyTestProbe != nullptr);
+}
+
+void ARealSenseSessionManager::RecordColorTextureUpload(const TArray<FSimpleColor>& Buffer, UTexture2D* Texture)
+{
+	if (LatencyTestProbe && Texture && (Buffer.Num() == Texture->GetSizeX() * Texture->GetSizeY())) {
+		LatencyTestProbe->RecordUpload(Texture, reinterpret_cast<const uint8*>(Buffer.GetData()), 
+									   Texture->GetSizeX(), Texture->GetSizeY());
+	}
+}
+
 TArray<FSimpleColor> ARealSenseSessionManager::GetScanBuffer() const 
 { 
 	return ScanBuffer; 
@@ -238,6 +698,11 @@ bool ARealSenseSessionManager::IsScanning() const
 	return impl->IsScanning();
 }
 
+void ARealSenseSessionManager::SetScanBufferEnabled(bool bEnabled)
+{
+	bScanBufferEnabled = bEnabled;
+}
+
 bool ARealSenseSessionManager::HasScan3DImageSizeChanged() const
 {
 	return impl->HasScan3DImageSizeChanged();
@@ -261,4 +726,134 @@ FVector ARealSenseSessionManager::GetHeadPosition() const
 FRotator ARealSenseSessionManager::GetHeadRotation() const
 {
 	return impl->GetHeadRotation();
-}
\ No newline at end of file
+}
+
+// Enables the head crop and resizes the HeadCropBuffer to match
+void ARealSenseSessionManager::EnableHeadCrop(int32 Width, int32 Height, float Smoothing)
+{
+	impl->EnableHeadCrop(Width, Height, Smoothing);
+	HeadCropBuffer.SetNumZeroed(Width * Height);
+}
+
+void ARealSenseSessionManager::DisableHeadCrop()
+{
+	impl->DisableHeadCrop();
+}
+
+int32 ARealSenseSessionManager::GetHeadCropImageWidth() const
+{
+	return impl->GetHeadCropImageWidth();
+}
+
+int32 ARealSenseSessionManager::GetHeadCropImageHeight() const
+{
+	return impl->GetHeadCropImageHeight();
+}
+
+TArray<FSimpleColor> ARealSenseSessionManager::GetHeadCropBuffer() const
+{
+	return HeadCropBuffer;
+}
+
+void ARealSenseSessionManager::EnableHeadPoseQueue(int32 Capacity)
+{
+	impl->EnableHeadPoseQueue(static_cast<uint32>(FMath::Max(Capacity, 1)));
+}
+
+void ARealSenseSessionManager::DisableHeadPoseQueue()
+{
+	impl->DisableHeadPoseQueue();
+}
+
+int32 ARealSenseSessionManager::DrainHeadPoseSamples(TArray<FHeadPoseSample>& Samples)
+{
+	return static_cast<int32>(impl->DrainHeadPoseSamples(Samples));
+}
+
+int32 ARealSenseSessionManager::GetDroppedHeadPoseSamples() const
+{
+	return static_cast<int32>(impl->GetDroppedHeadPoseSamples());
+}
+
+int32 ARealSenseSessionManager::AddTriggerVolume(UTriggerVolumeComponent* Component, const TriggerVolume& Volume)
+{
+	const int32 Id = NextTriggerVolumeId++;
+	TriggerVolume& Added = TriggerVolumes.Add(Id, Volume);
+	Added.id = Id;
+	TriggerVolumeComponents.Add(Id, Component);
+	bTriggerVolumesChanged = true;
+	return Id;
+}
+
+void ARealSenseSessionManager::UpdateTriggerVolume(int32 Id, const TriggerVolume& Volume)
+{
+	if (TriggerVolume* Existing = TriggerVolumes.Find(Id)) {
+		*Existing = Volume;
+		Existing->id = Id;
+		bTriggerVolumesChanged = true;
+	}
+}
+
+void ARealSenseSessionManager::RemoveTriggerVolume(int32 Id)
+{
+	if (TriggerVolumes.Remove(Id) > 0) {
+		TriggerVolumeComponents.Remove(Id);
+		bTriggerVolumesChanged = true;
+	}
+}
+
+void ARealSenseSessionManager::SetTriggerVolumeStride(int32 Stride)
+{
+	impl->SetTriggerVolumeStride(Stride);
+}
+
+void ARealSenseSessionManager::StartTouchCalibration(int32 NumFrames)
+{
+	impl->StartTouchCalibration(NumFrames);
+}
+
+void ARealSenseSessionManager::EnableTouchDetection(int32 MinHeight, int32 MaxHeight, int32 MinArea, int32 MaxArea)
+{
+	impl->EnableTouchDetection(MinHeight, MaxHeight, MinArea, MaxArea);
+}
+
+void ARealSenseSessionManager::DisableTouchDetection()
+{
+	impl->DisableTouchDetection();
+	TouchPoints.Empty();
+}
+
+bool ARealSenseSessionManager::IsTouchCalibrated() const
+{
+	return impl->IsTouchCalibrated();
+}
+
+TArray<FTouchPoint> ARealSenseSessionManager::GetTouchPoints() const
+{
+	return TouchPoints;
+}
+
+void ARealSenseSessionManager::EnableBodyBounds()
+{
+	impl->EnableBodyBounds();
+}
+
+void ARealSenseSessionManager::DisableBodyBounds()
+{
+	impl->DisableBodyBounds();
+}
+
+void ARealSenseSessionManager::SetFloorPlane(const FPlane& Plane)
+{
+	impl->SetFloorPlane(Plane);
+}
+
+void ARealSenseSessionManager::ClearFloorPlane()
+{
+	impl->ClearFloorPlane();
+}
+
+FBodyBounds ARealSenseSessionManager::GetBodyBounds() const
+{
+	return impl->GetBodyBounds();
+}
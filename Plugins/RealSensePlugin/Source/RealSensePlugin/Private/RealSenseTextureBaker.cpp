@@ -0,0 +1,447 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "RealSenseMeshUtils.h"
+#include "ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Color Atlas Bake"), STAT_RealSenseColorAtlasBake, STATGROUP_RealSense);
+
+// Empty texels kept around each chart, so that bilinear filtering and the
+// first mip levels do not blend neighboring charts.
+static const int32 ChartPadding = 2;
+
+// Charts with fewer triangles are merged into a neighboring chart when that
+// does not fold the projection, which keeps noisy scans from shattering into
+// thousands of tiny charts.
+static const int32 MinChartTriangles = 8;
+
+// Fraction of the atlas that the chart rectangles are expected to fill
+static const float PackingEfficiency = 0.7f;
+
+namespace {
+
+// A connected set of triangles that face the same axis direction and are
+// parameterized by an orthographic projection along that axis.
+struct AtlasChart {
+	int32 Direction;
+	FVector2D Min;
+	FVector2D Max;
+	int32 FirstTriangle;
+	int32 NumTriangles;
+	FIntPoint Origin;
+	FIntPoint Size;
+};
+
+// Directions are +X, -X, +Y, -Y, +Z, -Z
+inline int32 GetDominantDirection(const FVector& Normal)
+{
+	const FVector Abs = Normal.GetAbs();
+	const int32 Axis = (Abs.X >= Abs.Y && Abs.X >= Abs.Z) ? 0 : ((Abs.Y >= Abs.Z) ? 1 : 2);
+	return 2 * Axis + ((Normal[Axis] < 0.0f) ? 1 : 0);
+}
+
+// The projection along a direction does not fold a triangle as long as the
+// normal points into the same half space.
+inline bool IsFacingDirection(const FVector& Normal, int32 Direction)
+{
+	const float Component = Normal[Direction / 2];
+	return (Direction & 1) ? (Component < 0.0f) : (Component > 0.0f);
+}
+
+inline FVector2D ProjectAlongDirection(const FVector& P, int32 Direction)
+{
+	const int32 Axis = Direction / 2;
+	return FVector2D(P[(Axis + 1) % 3], P[(Axis + 2) % 3]);
+}
+
+inline int32 FindRoot(TArray<int32>& Parents, int32 i)
+{
+	while (Parents[i] != i) {
+		Parents[i] = Parents[Parents[i]];
+		i = Parents[i];
+	}
+	return i;
+}
+
+inline uint64 UndirectedEdgeKey(int32 a, int32 b)
+{
+	const uint32 Lo = static_cast<uint32>(FMath::Min(a, b));
+	const uint32 Hi = static_cast<uint32>(FMath::Max(a, b));
+	return (static_cast<uint64>(Hi) << 32) | Lo;
+}
+
+// Labels the triangles with connected components of equal direction and
+// returns the number of triangles of each label.
+void LabelCharts(const TArray<int32>& EdgeNeighbors, const TArray<int32>& Directions,
+				 TArray<int32>& Labels, TArray<int32>& LabelSizes)
+{
+	const int32 NumTriangles = Directions.Num();
+
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(NumTriangles);
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		Parents[t] = t;
+	}
+
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		for (int32 e = 0; e < 3; ++e) {
+			const int32 n = EdgeNeighbors[3 * t + e];
+			if ((n > t) && (Directions[n] == Directions[t])) {
+				const int32 a = FindRoot(Parents, t);
+				const int32 b = FindRoot(Parents, n);
+				if (a != b) {
+					Parents[FMath::Max(a, b)] = FMath::Min(a, b);
+				}
+			}
+		}
+	}
+
+	Labels.SetNumUninitialized(NumTriangles);
+	LabelSizes.SetNumZeroed(NumTriangles);
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		Labels[t] = FindRoot(Parents, t);
+		LabelSizes[Labels[t]]++;
+	}
+}
+
+// Places the charts on shelves sorted by height. Returns false if they do
+// not fit into the atlas at the given texel density.
+bool PackCharts(TArray<AtlasChart>& Charts, const TArray<int32>& Order, float TexelsPerUnit, int32 TextureSize)
+{
+	int32 ShelfX = 0;
+	int32 ShelfY = 0;
+	int32 ShelfHeight = 0;
+
+	for (int32 c : Order) {
+		AtlasChart& Chart = Charts[c];
+		const FVector2D Extent = (Chart.Max - Chart.Min) * TexelsPerUnit;
+		Chart.Size.X = FMath::CeilToInt(Extent.X) + 1 + 2 * ChartPadding;
+		Chart.Size.Y = FMath::CeilToInt(Extent.Y) + 1 + 2 * ChartPadding;
+
+		if (ShelfX + Chart.Size.X > TextureSize) {
+			ShelfX = 0;
+			ShelfY += ShelfHeight;
+			ShelfHeight = 0;
+		}
+		if ((Chart.Size.X > TextureSize) || (ShelfY + Chart.Size.Y > TextureSize)) {
+			return false;
+		}
+
+		Chart.Origin = FIntPoint(ShelfX, ShelfY);
+		ShelfX += Chart.Size.X;
+		ShelfHeight = FMath::Max(ShelfHeight, Chart.Size.Y);
+	}
+
+	return true;
+}
+
+// Fills the texels covered by the triangle with the barycentric interpolation
+// of its vertex colors. Triangle corners are given in texel units.
+void RasterizeTriangle(const FVector2D P[3], const FLinearColor C[3], int32 TextureSize,
+					   TArray<FColor>& Texels, TArray<uint8>& Coverage)
+{
+	const float Area = (P[1].X - P[0].X) * (P[2].Y - P[0].Y) - (P[1].Y - P[0].Y) * (P[2].X - P[0].X);
+	if (FMath::Abs(Area) < SMALL_NUMBER) {
+		return;
+	}
+	const float InvArea = 1.0f / Area;
+
+	const int32 MinX = FMath::Max(FMath::FloorToInt(FMath::Min3(P[0].X, P[1].X, P[2].X)), 0);
+	const int32 MinY = FMath::Max(FMath::FloorToInt(FMath::Min3(P[0].Y, P[1].Y, P[2].Y)), 0);
+	const int32 MaxX = FMath::Min(FMath::CeilToInt(FMath::Max3(P[0].X, P[1].X, P[2].X)), TextureSize - 1);
+	const int32 MaxY = FMath::Min(FMath::CeilToInt(FMath::Max3(P[0].Y, P[1].Y, P[2].Y)), TextureSize - 1);
+
+	// Small tolerance so that texel centers on shared edges are not lost
+	const float Tolerance = -1e-4f;
+
+	for (int32 y = MinY; y <= MaxY; ++y) {
+		const float Y = y + 0.5f;
+		for (int32 x = MinX; x <= MaxX; ++x) {
+			const float X = x + 0.5f;
+			const float W0 = ((P[1].X - X) * (P[2].Y - Y) - (P[1].Y - Y) * (P[2].X - X)) * InvArea;
+			const float W1 = ((P[2].X - X) * (P[0].Y - Y) - (P[2].Y - Y) * (P[0].X - X)) * InvArea;
+			const float W2 = 1.0f - W0 - W1;
+			if ((W0 < Tolerance) || (W1 < Tolerance) || (W2 < Tolerance)) {
+				continue;
+			}
+			const FLinearColor Color = C[0] * W0 + C[1] * W1 + C[2] * W2;
+			const int32 i = y * TextureSize + x;
+			Texels[i] = Color.ToFColor(false);
+			Coverage[i] = 1;
+		}
+	}
+}
+
+// Grows the charts into the padding, one texel per pass, by averaging the
+// covered neighbors of each empty texel.
+void DilateCharts(int32 TextureSize, int32 Passes, TArray<FColor>& Texels, TArray<uint8>& Coverage)
+{
+	TArray<FColor> NextTexels;
+	TArray<uint8> NextCoverage;
+
+	for (int32 Pass = 0; Pass < Passes; ++Pass) {
+		NextTexels = Texels;
+		NextCoverage = Coverage;
+
+		ParallelFor(TextureSize, [&](int32 y) {
+			for (int32 x = 0; x < TextureSize; ++x) {
+				if (Coverage[y * TextureSize + x]) {
+					continue;
+				}
+				uint32 Sum[4] = { 0, 0, 0, 0 };
+				uint32 Count = 0;
+				for (int32 dy = -1; dy <= 1; ++dy) {
+					for (int32 dx = -1; dx <= 1; ++dx) {
+						const int32 nx = x + dx;
+						const int32 ny = y + dy;
+						if ((nx < 0) || (ny < 0) || (nx >= TextureSize) || (ny >= TextureSize)) {
+							continue;
+						}
+						const int32 n = ny * TextureSize + nx;
+						if (Coverage[n]) {
+							Sum[0] += Texels[n].R;
+							Sum[1] += Texels[n].G;
+							Sum[2] += Texels[n].B;
+							Sum[3] += Texels[n].A;
+							Count++;
+						}
+					}
+				}
+				if (Count > 0) {
+					const int32 i = y * TextureSize + x;
+					NextTexels[i] = FColor(Sum[0] / Count, Sum[1] / Count, Sum[2] / Count, Sum[3] / Count);
+					NextCoverage[i] = 1;
+				}
+			}
+		});
+
+		Exchange(Texels, NextTexels);
+		Exchange(Coverage, NextCoverage);
+	}
+}
+
+}
+
+// Charts are built by grouping edge-connected triangles by the axis direction
+// their face normal is closest to, which parameterizes each chart without
+// folds. The charts are shelf-packed at a uniform texel density, shrinking
+// the density until they fit, and rasterized in parallel since their
+// rectangles do not overlap.
+bool BakeVertexColorAtlas(const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+						  const TArray<FColor>& Colors, int32 TextureSize, FBakedColorAtlas& Atlas)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseColorAtlasBake);
+
+	const int32 NumVertices = Vertices.Num();
+	const int32 NumTriangles = Triangles.Num() / 3;
+	if ((NumTriangles == 0) || (Colors.Num() != NumVertices) || (TextureSize <= 2 * ChartPadding)) {
+		return false;
+	}
+
+	for (int32 i = 0; i < NumTriangles * 3; ++i) {
+		if ((Triangles[i] < 0) || (Triangles[i] >= NumVertices)) {
+			return false;
+		}
+	}
+
+	// Face normals and initial directions
+	TArray<FVector> FaceNormals;
+	TArray<int32> Directions;
+	FaceNormals.SetNumUninitialized(NumTriangles);
+	Directions.SetNumUninitialized(NumTriangles);
+	ParallelFor(NumTriangles, [&](int32 t) {
+		const FVector& A = Vertices[Triangles[3 * t + 0]];
+		const FVector& B = Vertices[Triangles[3 * t + 1]];
+		const FVector& C = Vertices[Triangles[3 * t + 2]];
+		FaceNormals[t] = FVector::CrossProduct(C - A, B - A);
+		Directions[t] = GetDominantDirection(FaceNormals[t]);
+	});
+
+	// Neighbor across each edge; edges shared by more than two triangles are
+	// treated as seams.
+	TArray<int32> EdgeNeighbors;
+	EdgeNeighbors.Init(-1, NumTriangles * 3);
+	{
+		TMap<uint64, int32> FirstEdge;
+		FirstEdge.Reserve(NumTriangles * 3 / 2);
+		for (int32 i = 0; i < NumTriangles * 3; ++i) {
+			const int32 a = Triangles[i];
+			const int32 b = Triangles[(i % 3 == 2) ? (i - 2) : (i + 1)];
+			const uint64 Key = UndirectedEdgeKey(a, b);
+			int32* Other = FirstEdge.Find(Key);
+			if (Other == nullptr) {
+				FirstEdge.Add(Key, i);
+			}
+			else if (*Other >= 0) {
+				EdgeNeighbors[i] = *Other / 3;
+				EdgeNeighbors[*Other] = i / 3;
+				*Other = -1;
+			}
+		}
+	}
+
+	TArray<int32> Labels;
+	TArray<int32> LabelSizes;
+	LabelCharts(EdgeNeighbors, Directions, Labels, LabelSizes);
+
+	// Merge the triangles of tiny charts into the largest neighboring chart
+	// whose direction they face.
+	bool bMerged = false;
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		if (LabelSizes[Labels[t]] >= MinChartTriangles) {
+			continue;
+		}
+		int32 BestSize = LabelSizes[Labels[t]];
+		for (int32 e = 0; e < 3; ++e) {
+			const int32 n = EdgeNeighbors[3 * t + e];
+			if ((n >= 0) && (LabelSizes[Labels[n]] > BestSize) && IsFacingDirection(FaceNormals[t], Directions[n])) {
+				BestSize = LabelSizes[Labels[n]];
+				Directions[t] = Directions[n];
+				bMerged = true;
+			}
+		}
+	}
+	if (bMerged) {
+		LabelCharts(EdgeNeighbors, Directions, Labels, LabelSizes);
+	}
+
+	// Compact the labels into charts and sort the triangles by chart
+	TArray<AtlasChart> Charts;
+	TArray<int32> ChartOfLabel;
+	ChartOfLabel.Init(-1, NumTriangles);
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		int32& c = ChartOfLabel[Labels[t]];
+		if (c < 0) {
+			c = Charts.Num();
+			Charts.AddZeroed();
+			AtlasChart& Chart = Charts.Last();
+			Chart.Direction = Directions[t];
+			Chart.Min = FVector2D(BIG_NUMBER, BIG_NUMBER);
+			Chart.Max = FVector2D(-BIG_NUMBER, -BIG_NUMBER);
+		}
+		Charts[c].NumTriangles++;
+	}
+
+	int32 FirstTriangle = 0;
+	for (AtlasChart& Chart : Charts) {
+		Chart.FirstTriangle = FirstTriangle;
+		FirstTriangle += Chart.NumTriangles;
+		Chart.NumTriangles = 0;
+	}
+
+	TArray<int32> ChartTriangles;
+	ChartTriangles.SetNumUninitialized(NumTriangles);
+	for (int32 t = 0; t < NumTriangles; ++t) {
+		AtlasChart& Chart = Charts[ChartOfLabel[Labels[t]]];
+		ChartTriangles[Chart.FirstTriangle + Chart.NumTriangles++] = t;
+	}
+
+	ParallelFor(Charts.Num(), [&](int32 c) {
+		AtlasChart& Chart = Charts[c];
+		for (int32 i = 0; i < Chart.NumTriangles; ++i) {
+			const int32 t = ChartTriangles[Chart.FirstTriangle + i];
+			for (int32 k = 0; k < 3; ++k) {
+				const FVector2D P = ProjectAlongDirection(Vertices[Triangles[3 * t + k]], Chart.Direction);
+				Chart.Min = FVector2D(FMath::Min(Chart.Min.X, P.X), FMath::Min(Chart.Min.Y, P.Y));
+				Chart.Max = FVector2D(FMath::Max(Chart.Max.X, P.X), FMath::Max(Chart.Max.Y, P.Y));
+			}
+		}
+	});
+
+	// Find a texel density at which all charts fit
+	TArray<int32> Order;
+	Order.SetNumUninitialized(Charts.Num());
+	double ChartArea = 0.0;
+	for (int32 c = 0; c < Charts.Num(); ++c) {
+		Order[c] = c;
+		const FVector2D Extent = Charts[c].Max - Charts[c].Min;
+		ChartArea += Extent.X * Extent.Y;
+	}
+	Order.Sort([&Charts](int32 a, int32 b) {
+		return (Charts[a].Max.Y - Charts[a].Min.Y) > (Charts[b].Max.Y - Charts[b].Min.Y);
+	});
+
+	float TexelsPerUnit = FMath::Sqrt(PackingEfficiency * TextureSize * TextureSize / FMath::Max(ChartArea, (double)SMALL_NUMBER));
+	bool bPacked = false;
+	for (int32 Attempt = 0; (Attempt < 64) && (bPacked == false); ++Attempt) {
+		bPacked = PackCharts(Charts, Order, TexelsPerUnit, TextureSize);
+		if (bPacked == false) {
+			TexelsPerUnit *= 0.9f;
+		}
+	}
+	if (bPacked == false) {
+		return false;
+	}
+
+	// Split the mesh along the chart seams
+	Atlas.Vertices.Reset();
+	Atlas.UVs.Reset();
+	Atlas.SourceVertices.Reset();
+	Atlas.VertexCharts.Reset();
+	Atlas.Triangles.SetNumUninitialized(NumTriangles * 3);
+
+	TArray<int32> LastChart;
+	TArray<int32> LastIndex;
+	LastChart.Init(-1, NumVertices);
+	LastIndex.SetNumUninitialized(NumVertices);
+
+	const float InvTextureSize = 1.0f / TextureSize;
+	for (int32 c = 0; c < Charts.Num(); ++c) {
+		const AtlasChart& Chart = Charts[c];
+		const FVector2D Offset(Chart.Origin.X + ChartPadding + 0.5f, Chart.Origin.Y + ChartPadding + 0.5f);
+		for (int32 i = 0; i < Chart.NumTriangles; ++i) {
+			const int32 t = ChartTriangles[Chart.FirstTriangle + i];
+			for (int32 k = 0; k < 3; ++k) {
+				const int32 v = Triangles[3 * t + k];
+				if (LastChart[v] != c) {
+					LastChart[v] = c;
+					LastIndex[v] = Atlas.Vertices.Add(Vertices[v]);
+					Atlas.SourceVertices.Add(v);
+					Atlas.VertexCharts.Add(c);
+					const FVector2D P = ProjectAlongDirection(Vertices[v], Chart.Direction);
+					Atlas.UVs.Add((Offset + (P - Chart.Min) * TexelsPerUnit) * InvTextureSize);
+				}
+				Atlas.Triangles[3 * t + k] = LastIndex[v];
+			}
+		}
+	}
+
+	// Rasterize each chart into its own rectangle
+	Atlas.TextureSize = TextureSize;
+	Atlas.Texels.Init(FColor(0, 0, 0, 255), TextureSize * TextureSize);
+	TArray<uint8> Coverage;
+	Coverage.SetNumZeroed(TextureSize * TextureSize);
+
+	ParallelFor(Charts.Num(), [&](int32 c) {
+		const AtlasChart& Chart = Charts[c];
+		for (int32 i = 0; i < Chart.NumTriangles; ++i) {
+			const int32 t = ChartTriangles[Chart.FirstTriangle + i];
+			FVector2D P[3];
+			FLinearColor C[3];
+			for (int32 k = 0; k < 3; ++k) {
+				const int32 v = Atlas.Triangles[3 * t + k];
+				P[k] = Atlas.UVs[v] * TextureSize;
+				C[k] = FLinearColor(Colors[Atlas.SourceVertices[v]].R, Colors[Atlas.SourceVertices[v]].G,
+									Colors[Atlas.SourceVertices[v]].B, Colors[Atlas.SourceVertices[v]].A) / 255.0f;
+			}
+			RasterizeTriangle(P, C, TextureSize, Atlas.Texels, Coverage);
+		}
+	});
+
+	DilateCharts(TextureSize, ChartPadding, Atlas.Texels, Coverage);
+
+	return true;
+}
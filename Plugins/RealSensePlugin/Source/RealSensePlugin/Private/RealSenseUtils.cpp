@@ -15,6 +15,7 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 #include "RealSensePluginPrivatePCH.h"
 #include "RealSenseUtils.h"
+#include "RealSenseMeshUtils.h"
 
 DEFINE_LOG_CATEGORY(RealSensePlugin);
 
@@ -25,6 +26,12 @@ FVector ConvertRSVectorToUnreal(FVector v)
 	return FVector(v.Z, v.X, -v.Y);
 }
 
+// Inverse of ConvertRSVectorToUnreal().
+FVector ConvertUnrealVectorToRS(FVector v)
+{
+	return FVector(v.Y, -v.Z, v.X);
+}
+
 // Maps the depth value to a number between 0 - 255 so it can
 // be represented as an 8-bit color.
 uint8 ConvertDepthValueTo8Bit(int32 depth, int32 width)
@@ -220,7 +227,58 @@ void CopyDepthImageToBuffer(PXCImage* image, TArray<uint16>& data, const uint32
 	image->ReleaseAccess(&imageData);
 }
 
-void LoadMeshFile(const FString& filename, TArray<FVector>& Vertices, TArray<int32>& Triangles, TArray<FColor>& Colors)
+// Bilinearly resamples the window [x0, x0 + width) x [y0, y0 + height) of the 
+// BGRA source image into the BGRA destination image. Weights are kept in 8-bit 
+// fixed point since this runs once per frame on the camera processing thread.
+void CropAndScaleImage(const TArray<uint8>& src, const uint32 srcWidth, const uint32 srcHeight,
+					   float x0, float y0, float width, float height,
+					   TArray<uint8>& dst, const uint32 dstWidth, const uint32 dstHeight)
+{
+	const uint8 bytesPerPixel = 4;
+	if ((srcWidth == 0) || (srcHeight == 0) || (dstWidth == 0) || (dstHeight == 0) ||
+		(src.Num() < (int32)(srcWidth * srcHeight * bytesPerPixel)) ||
+		(dst.Num() < (int32)(dstWidth * dstHeight * bytesPerPixel))) {
+		return;
+	}
+
+	const float stepX = width / dstWidth;
+	const float stepY = height / dstHeight;
+	const uint32 srcPitch = srcWidth * bytesPerPixel;
+
+	const uint8* in = src.GetData();
+	uint8* out = dst.GetData();
+
+	for (uint32 y = 0; y < dstHeight; ++y) {
+		const float sy = FMath::Clamp(y0 + (y + 0.5f) * stepY - 0.5f, 0.0f, srcHeight - 1.0f);
+		const uint32 y1 = static_cast<uint32>(sy);
+		const uint32 y2 = FMath::Min(y1 + 1, srcHeight - 1);
+		const uint32 fy = static_cast<uint32>((sy - y1) * 256.0f);
+
+		const uint8* row1 = in + y1 * srcPitch;
+		const uint8* row2 = in + y2 * srcPitch;
+
+		for (uint32 x = 0; x < dstWidth; ++x) {
+			const float sx = FMath::Clamp(x0 + (x + 0.5f) * stepX - 0.5f, 0.0f, srcWidth - 1.0f);
+			const uint32 x1 = static_cast<uint32>(sx);
+			const uint32 x2 = FMath::Min(x1 + 1, srcWidth - 1);
+			const uint32 fx = static_cast<uint32>((sx - x1) * 256.0f);
+
+			const uint8* p00 = row1 + x1 * bytesPerPixel;
+			const uint8* p01 = row1 + x2 * bytesPerPixel;
+			const uint8* p10 = row2 + x1 * bytesPerPixel;
+			const uint8* p11 = row2 + x2 * bytesPerPixel;
+
+			for (uint32 c = 0; c < bytesPerPixel; ++c) {
+				const uint32 top = p00[c] * (256 - fx) + p01[c] * fx;
+				const uint32 bottom = p10[c] * (256 - fx) + p11[c] * fx;
+				*out++ = static_cast<uint8>((top * (256 - fy) + bottom * fy) >> 16);
+			}
+		}
+	}
+}
+
+void LoadMeshFile(const FString& filename, TArray<FVector>& Vertices, TArray<int32>& Triangles, TArray<FColor>& Colors,
+				  TArray<FVector>& Normals, TArray<FVector>& Tangents)
 {
 	// TODO: Check if Reserving Lines ahead of time is faster
 	TArray<FString> Lines;
@@ -230,6 +288,8 @@ void LoadMeshFile(const FString& filename, TArray<FVector>& Vertices, TArray<int
 	Vertices.Empty();
 	Triangles.Empty();
 	Colors.Empty();
+	Normals.Empty();
+	Tangents.Empty();
 
 	float x = 0.0f;
 	float y = 0.0f;
@@ -285,4 +345,6 @@ void LoadMeshFile(const FString& filename, TArray<FVector>& Vertices, TArray<int
 	for (int i = 0; i < Vertices.Num(); i++) {
 		Vertices[i] -= MeshCenter;
 	}
+
+	ComputeMeshNormalsAndTangents(Vertices, Triangles, Normals, Tangents);
 }
@@ -15,11 +15,13 @@
 /////////////////////////////////////////////////////////////////////////////////////////////
 #include "RealSensePluginPrivatePCH.h"
 #include "Scan3DComponent.h"
+#include "RealSenseMeshUtils.h"
 
 UScan3DComponent::UScan3DComponent(const class FObjectInitializer& ObjInit) 
 	: Super(ObjInit) 
 { 
 	bHasScanStarted = false;
+	bDirectPreviewUpload = false;
 	m_feature = RealSenseFeature::SCAN_3D;
 }
 
@@ -30,6 +32,8 @@ void UScan3DComponent::InitializeComponent()
 	Super::InitializeComponent();
 
 	ScanTexture = UTexture2D::CreateTransient(1, 1,	EPixelFormat::PF_B8G8R8A8);
+
+	SetDirectPreviewUpload(bDirectPreviewUpload);
 }
 
 // Copies the ScanBuffer and checks if a current scan has just completed.
@@ -37,22 +41,51 @@ void UScan3DComponent::InitializeComponent()
 void UScan3DComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, 
 	                                 FActorComponentTickFunction *ThisTickFunction) 
 {
+	// Scans can be loaded and processed without a running camera, so check
+	// for finished background work first.
+	if (CollisionHullsResult.IsValid() && CollisionHullsResult.IsReady()) {
+		CollisionHulls = CollisionHullsResult.Get();
+		CollisionHullsResult = TFuture<TArray<FScanConvexHull>>();
+		OnCollisionHullsComputed.Broadcast();
+	}
+
+	if (ColorAtlasResult.IsValid() && ColorAtlasResult.IsReady()) {
+		TSharedPtr<FBakedColorAtlas, ESPMode::ThreadSafe> Atlas = ColorAtlasResult.Get();
+		ColorAtlasResult = TFuture<TSharedPtr<FBakedColorAtlas, ESPMode::ThreadSafe>>();
+		if (Atlas.IsValid()) {
+			ApplyColorAtlas(*Atlas);
+			OnColorTextureBaked.Broadcast();
+		}
+	}
+
 	if (globalRealSenseSession->IsCameraRunning() == false) {
 		return;
 	}
 
+	// A running scan needs every frame, whether or not the preview is visible
+	if (bHasScanStarted) {
+		globalRealSenseSession->NotifyDataAccess();
+	}
+	NotifyDataAccessIfRendered(ScanTexture);
+
 	// The 3D Scanning preview image size can be changed automatically by the
 	// middleware, so it is important to check every tick if the image size
 	// has changed so that the ScanTexture object can be resized to match.
-	if (globalRealSenseSession->HasScan3DImageSizeChanged()) {
-		int Scan3DImageWidth = globalRealSenseSession->GetScan3DImageWidth();
-		int Scan3DImageHeight = globalRealSenseSession->GetScan3DImageHeight();
+	int Scan3DImageWidth = globalRealSenseSession->GetScan3DImageWidth();
+	int Scan3DImageHeight = globalRealSenseSession->GetScan3DImageHeight();
+	if (globalRealSenseSession->HasScan3DImageSizeChanged() || 
+		((Scan3DImageWidth > 0) && (Scan3DImageWidth != ScanTexture->GetSizeX() || Scan3DImageHeight != ScanTexture->GetSizeY()))) {
 		ScanTexture = UTexture2D::CreateTransient(Scan3DImageWidth, Scan3DImageHeight,
 											      EPixelFormat::PF_B8G8R8A8);
 		ScanTexture->UpdateResource();
 	}
 
-	ScanBuffer = globalRealSenseSession->GetScanBuffer();
+	if (bDirectPreviewUpload) {
+		UploadPreview();
+	}
+	else {
+		ScanBuffer = globalRealSenseSession->GetScanBuffer();
+	}
 
 	if (globalRealSenseSession->HasScanCompleted() && bHasScanStarted) {
 		OnScanComplete.Broadcast();
@@ -60,6 +93,46 @@ void UScan3DComponent::TickComponent(float DeltaTime, enum ELevelTick TickType,
 	}
 }
 
+void UScan3DComponent::SetDirectPreviewUpload(bool bEnable)
+{
+	bDirectPreviewUpload = bEnable;
+	globalRealSenseSession->SetScanBufferEnabled(bEnable == false);
+	if (bEnable) {
+		ScanBuffer.Empty();
+	}
+}
+
+// The render command holds a snapshot of the frame, which keeps the preview 
+// image alive and unchanged until the upload has finished, so the image is 
+// not copied on the game thread at all.
+void UScan3DComponent::UploadPreview()
+{
+	FRealSenseFrameSnapshot Snapshot = globalRealSenseSession->GetFrameSnapshot();
+	if ((Snapshot.IsValid() == false) || (Snapshot.GetFrameNumber() == PreviewFrameNumber)) {
+		return;
+	}
+
+	FTexture2DResource* Resource = static_cast<FTexture2DResource*>(ScanTexture->Resource);
+	const uint32 Width = ScanTexture->GetSizeX();
+	const uint32 Height = ScanTexture->GetSizeY();
+	const uint32 BytesPerPixel = 4;
+	if ((Resource == nullptr) || (Snapshot.GetScanImage().Num() != Width * Height * BytesPerPixel)) {
+		return;
+	}
+	PreviewFrameNumber = Snapshot.GetFrameNumber();
+
+	ENQUEUE_UNIQUE_RENDER_COMMAND_FOURPARAMETER(
+		UploadScanPreview,
+		FTexture2DResource*, Resource, Resource,
+		FRealSenseFrameSnapshot, Snapshot, Snapshot,
+		uint32, Width, Width,
+		uint32, Height, Height,
+		{
+			const FUpdateTextureRegion2D Region(0, 0, 0, 0, Width, Height);
+			RHIUpdateTexture2D(Resource->GetTexture2DRHI(), 0, Region, Width * 4, Snapshot.GetScanImage().GetData());
+		});
+}
+
 void UScan3DComponent::ConfigureScanning(EScan3DMode ScanningMode, bool bSolidify)
 {
 	globalRealSenseSession->ConfigureScanning(ScanningMode, bSolidify, false);
@@ -85,7 +158,121 @@ void UScan3DComponent::SaveScan(FString Filename)
 void UScan3DComponent::LoadScan(FString Filename)
 {
 	Filename = FPaths::GameContentDir().Append(Filename);
-	LoadMeshFile(Filename, Vertices, Triangles, Colors);
+	LoadMeshFile(Filename, Vertices, Triangles, Colors, Normals, Tangents);
+	LoadedScanFilename = Filename;
+	CollisionHulls.Empty();
+	UV0.Empty();
+
+	// Results computed for the previous mesh are never published
+	CollisionHullsResult = TFuture<TArray<FScanConvexHull>>();
+	ColorAtlasResult = TFuture<TSharedPtr<FBakedColorAtlas, ESPMode::ThreadSafe>>();
+}
+
+bool UScan3DComponent::ExportScan(FString Filename)
+{
+	Filename = FPaths::GameContentDir().Append(Filename);
+	return SaveMeshFile(Filename, Vertices, Triangles, Colors, Normals);
+}
+
+void UScan3DComponent::SmoothScan(int32 Iterations)
+{
+	SmoothMeshTaubin(Vertices, Triangles, Iterations);
+	ComputeMeshNormalsAndTangents(Vertices, Triangles, Normals, Tangents);
+	CollisionHulls.Empty();
+	CollisionHullsResult = TFuture<TArray<FScanConvexHull>>();
+	ColorAtlasResult = TFuture<TSharedPtr<FBakedColorAtlas, ESPMode::ThreadSafe>>();
+}
+
+// Copies the mesh so that the decomposition does not race with later edits 
+// of the Vertices and Triangles arrays, then runs it on the thread pool. The
+// cache lookup happens on the worker as well to keep file access off the game
+// thread.
+void UScan3DComponent::ComputeCollisionHulls(int32 MaxHulls, int32 Resolution)
+{
+	if (CollisionHullsResult.IsValid() || (Vertices.Num() == 0)) {
+		return;
+	}
+
+	const FString ScanFilename = LoadedScanFilename;
+	const TArray<FVector> MeshVertices = Vertices;
+	const TArray<int32> MeshTriangles = Triangles;
+
+	CollisionHullsResult = Async<TArray<FScanConvexHull>>(EAsyncExecution::ThreadPool, 
+		[ScanFilename, MeshVertices, MeshTriangles, MaxHulls, Resolution]() {
+			TArray<FScanConvexHull> Hulls;
+			if (ScanFilename.IsEmpty() || 
+				(LoadConvexHullCache(ScanFilename, MeshVertices, MeshTriangles, MaxHulls, Resolution, Hulls) == false)) {
+				ComputeConvexDecomposition(MeshVertices, MeshTriangles, MaxHulls, Resolution, Hulls);
+				if (ScanFilename.IsEmpty() == false) {
+					SaveConvexHullCache(ScanFilename, MeshVertices, MeshTriangles, MaxHulls, Resolution, Hulls);
+				}
+			}
+			return Hulls;
+		});
+}
+
+// Bakes a copy of the mesh on the thread pool. The resulting arrays are 
+// swapped in on the game thread, where the texture can be created.
+void UScan3DComponent::BakeColorTexture(int32 TextureSize)
+{
+	if (ColorAtlasResult.IsValid() || (Vertices.Num() == 0) || (Colors.Num() != Vertices.Num())) {
+		return;
+	}
+
+	const TArray<FVector> MeshVertices = Vertices;
+	const TArray<int32> MeshTriangles = Triangles;
+	TArray<FColor> MeshColors = Colors;
+	TArray<FVector> MeshNormals = Normals;
+	TArray<FVector> MeshTangents = Tangents;
+	TextureSize = FMath::Clamp(TextureSize, 64, 8192);
+
+	ColorAtlasResult = Async<TSharedPtr<FBakedColorAtlas, ESPMode::ThreadSafe>>(EAsyncExecution::ThreadPool, 
+		[MeshVertices, MeshTriangles, MeshColors, MeshNormals, MeshTangents, TextureSize]() mutable {
+			TSharedPtr<FBakedColorAtlas, ESPMode::ThreadSafe> Atlas = MakeShareable(new FBakedColorAtlas());
+			if (BakeVertexColorAtlas(MeshVertices, MeshTriangles, MeshColors, TextureSize, *Atlas) == false) {
+				Atlas.Reset();
+				return Atlas;
+			}
+			Atlas->SourceColors = MoveTemp(MeshColors);
+			Atlas->SourceNormals = MoveTemp(MeshNormals);
+			Atlas->SourceTangents = MoveTemp(MeshTangents);
+			return Atlas;
+		});
+}
+
+// Replaces the mesh arrays with the split mesh of the atlas, remapping the 
+// per-vertex attributes of the baked mesh, and uploads the atlas into the 
+// ColorTexture.
+void UScan3DComponent::ApplyColorAtlas(FBakedColorAtlas& Atlas)
+{
+	const int32 NumVertices = Atlas.Vertices.Num();
+	TArray<FColor> AtlasColors;
+	TArray<FVector> AtlasNormals;
+	TArray<FVector> AtlasTangents;
+	AtlasColors.SetNumUninitialized(NumVertices);
+	AtlasNormals.SetNumUninitialized(NumVertices);
+	AtlasTangents.SetNumUninitialized(NumVertices);
+	for (int32 i = 0; i < NumVertices; ++i) {
+		const int32 Source = Atlas.SourceVertices[i];
+		AtlasColors[i] = Atlas.SourceColors.IsValidIndex(Source) ? Atlas.SourceColors[Source] : FColor::White;
+		AtlasNormals[i] = Atlas.SourceNormals.IsValidIndex(Source) ? Atlas.SourceNormals[Source] : FVector::UpVector;
+		AtlasTangents[i] = Atlas.SourceTangents.IsValidIndex(Source) ? Atlas.SourceTangents[Source] : FVector::ForwardVector;
+	}
+
+	Vertices = MoveTemp(Atlas.Vertices);
+	Triangles = MoveTemp(Atlas.Triangles);
+	UV0 = MoveTemp(Atlas.UVs);
+	Colors = MoveTemp(AtlasColors);
+	Normals = MoveTemp(AtlasNormals);
+	Tangents = MoveTemp(AtlasTangents);
+	CollisionHulls.Empty();
+
+	ColorTexture = UTexture2D::CreateTransient(Atlas.TextureSize, Atlas.TextureSize, EPixelFormat::PF_B8G8R8A8);
+	auto out = ColorTexture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+	const uint32 size = Atlas.Texels.Num() * sizeof(FColor);
+	memcpy_s(out, size, Atlas.Texels.GetData(), size);
+	ColorTexture->PlatformData->Mips[0].BulkData.Unlock();
+	ColorTexture->UpdateResource();
 }
 
 bool UScan3DComponent::IsScanning() 
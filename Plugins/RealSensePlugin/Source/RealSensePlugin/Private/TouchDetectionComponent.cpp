@@ -0,0 +1,78 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "TouchDetectionComponent.h"
+
+UTouchDetectionComponent::UTouchDetectionComponent(const class FObjectInitializer& ObjInit) 
+	: Super(ObjInit) 
+{ 
+	m_feature = RealSenseFeature::CAMERA_STREAMING;
+}
+
+void UTouchDetectionComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	bCalibrated = false;
+}
+
+// Compares the touches of the latest frame with those of the previous frame
+// by identifier to raise OnTouchBegin and OnTouchEnd.
+void UTouchDetectionComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, 
+											 FActorComponentTickFunction *ThisTickFunction) 
+{
+	if (globalRealSenseSession->IsCameraRunning() == false) {
+		return;
+	}
+
+	// Touches drive gameplay, so the data is read on every tick
+	globalRealSenseSession->NotifyDataAccess();
+
+	if ((bCalibrated == false) && globalRealSenseSession->IsTouchCalibrated()) {
+		bCalibrated = true;
+		OnCalibrated.Broadcast();
+	}
+
+	const TArray<FTouchPoint> PreviousTouchPoints = MoveTemp(TouchPoints);
+	TouchPoints = globalRealSenseSession->GetTouchPoints();
+
+	for (const FTouchPoint& Touch : PreviousTouchPoints) {
+		if (TouchPoints.ContainsByPredicate([&Touch](const FTouchPoint& Other) { return Other.Id == Touch.Id; }) == false) {
+			OnTouchEnd.Broadcast(Touch);
+		}
+	}
+	for (const FTouchPoint& Touch : TouchPoints) {
+		if (PreviousTouchPoints.ContainsByPredicate([&Touch](const FTouchPoint& Other) { return Other.Id == Touch.Id; }) == false) {
+			OnTouchBegin.Broadcast(Touch);
+		}
+	}
+}
+
+void UTouchDetectionComponent::Calibrate(int32 NumFrames)
+{
+	bCalibrated = false;
+	globalRealSenseSession->StartTouchCalibration(NumFrames);
+}
+
+void UTouchDetectionComponent::EnableTouchDetection(int32 MinHeight, int32 MaxHeight, int32 MinArea, int32 MaxArea)
+{
+	globalRealSenseSession->EnableTouchDetection(MinHeight, MaxHeight, MinArea, MaxArea);
+}
+
+void UTouchDetectionComponent::DisableTouchDetection()
+{
+	globalRealSenseSession->DisableTouchDetection();
+}
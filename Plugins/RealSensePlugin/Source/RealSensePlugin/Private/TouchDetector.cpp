@@ -0,0 +1,326 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "TouchDetector.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+#include <emmintrin.h>
+#endif
+
+DECLARE_CYCLE_STAT(TEXT("Touch Detection"), STAT_RealSenseTouchDetection, STATGROUP_RealSense);
+
+// Touches further apart than this (in normalized image coordinates) between
+// two images are treated as different fingers.
+static const float MaxTrackDistance = 0.05f;
+
+TouchDetector::TouchDetector()
+	: width(0), height(0), minHeight(5), maxHeight(30), minArea(8), maxArea(2000),
+	  calibrationFramesLeft(0), bCalibrated(false), bBandChanged(false), nextId(1)
+{
+}
+
+void TouchDetector::StartCalibration(uint32 numFrames)
+{
+	calibrationFramesLeft = FMath::Clamp(numFrames, 1u, MaxCalibrationFrames);
+	bCalibrated = false;
+	depthSum.Reset();
+	depthSquaredSum.Reset();
+	validCount.Reset();
+	previousTouches.Reset();
+}
+
+void TouchDetector::Configure(uint16 newMinHeight, uint16 newMaxHeight, uint32 newMinArea, uint32 newMaxArea)
+{
+	if ((newMinHeight != minHeight) || (newMaxHeight != maxHeight)) {
+		minHeight = newMinHeight;
+		maxHeight = newMaxHeight;
+		bBandChanged = true;
+	}
+	minArea = newMinArea;
+	maxArea = newMaxArea;
+}
+
+void TouchDetector::Process(const TArray<uint16>& depth, const uint32 newWidth, const uint32 newHeight, TArray<FTouchPoint>& touches)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseTouchDetection);
+
+	touches.Reset();
+
+	const uint32 numPixels = newWidth * newHeight;
+	if ((numPixels == 0) || (depth.Num() < (int32)numPixels)) {
+		return;
+	}
+
+	// The reference surface only fits the resolution it was calibrated at
+	if ((newWidth != width) || (newHeight != height)) {
+		width = newWidth;
+		height = newHeight;
+		bCalibrated = false;
+		if (IsCalibrating()) {
+			StartCalibration(calibrationFramesLeft);
+		}
+	}
+
+	if (IsCalibrating()) {
+		if (depthSum.Num() != (int32)numPixels) {
+			depthSum.SetNumZeroed(numPixels);
+			depthSquaredSum.SetNumZeroed(numPixels);
+			validCount.SetNumZeroed(numPixels);
+		}
+		for (uint32 i = 0; i < numPixels; ++i) {
+			const uint32 d = depth[i];
+			if (d != 0) {
+				depthSum[i] += d;
+				depthSquaredSum[i] += d * d;
+				validCount[i]++;
+			}
+		}
+		if (--calibrationFramesLeft == 0) {
+			FinishCalibration();
+		}
+		return;
+	}
+
+	if (bCalibrated == false) {
+		return;
+	}
+
+	if (bBandChanged) {
+		UpdateBand();
+	}
+
+	Threshold(depth);
+	ExtractBlobs(depth, touches);
+	Track(touches);
+}
+
+// Pixels that were valid in less than half of the calibration images get no
+// reference and never report a touch.
+void TouchDetector::FinishCalibration()
+{
+	const uint32 numPixels = width * height;
+	uint16 maxValid = 0;
+	for (uint32 i = 0; i < numPixels; ++i) {
+		maxValid = FMath::Max(maxValid, validCount[i]);
+	}
+
+	reference.SetNumUninitialized(numPixels);
+	noise.SetNumUninitialized(numPixels);
+	for (uint32 i = 0; i < numPixels; ++i) {
+		const uint32 count = validCount[i];
+		if ((count == 0) || (count * 2 < maxValid)) {
+			reference[i] = 0;
+			noise[i] = 0;
+			continue;
+		}
+		const double mean = static_cast<double>(depthSum[i]) / count;
+		const double variance = FMath::Max(static_cast<double>(depthSquaredSum[i]) / count - mean * mean, 0.0);
+		reference[i] = static_cast<uint16>(mean + 0.5);
+		noise[i] = static_cast<uint16>(FMath::Min(FMath::Sqrt(variance) + 0.5, 65535.0));
+	}
+
+	depthSum.Empty();
+	depthSquaredSum.Empty();
+	validCount.Empty();
+
+	bCalibrated = true;
+	UpdateBand();
+}
+
+// A pixel touches if its depth lies in [bandNear, bandFar]. The far end 
+// stays above the calibration noise of the pixel, and pixels whose noise 
+// exceeds the band are disabled by an empty range.
+void TouchDetector::UpdateBand()
+{
+	const uint32 numPixels = width * height;
+	bandNear.SetNumUninitialized(numPixels);
+	bandFar.SetNumUninitialized(numPixels);
+	for (uint32 i = 0; i < numPixels; ++i) {
+		const uint32 nearOffset = maxHeight;
+		const uint32 farOffset = FMath::Max<uint32>(minHeight, NoiseSigmas * noise[i]);
+		if ((reference[i] == 0) || (farOffset > nearOffset) || (nearOffset >= reference[i])) {
+			bandNear[i] = 0xFFFF;
+			bandFar[i] = 0;
+		}
+		else {
+			bandNear[i] = static_cast<uint16>(reference[i] - nearOffset);
+			bandFar[i] = static_cast<uint16>(reference[i] - farOffset);
+		}
+	}
+	bBandChanged = false;
+}
+
+void TouchDetector::Threshold(const TArray<uint16>& depth)
+{
+	const uint32 numPixels = width * height;
+	mask.SetNumUninitialized(numPixels);
+
+	const uint16* d = depth.GetData();
+	const uint16* bn = bandNear.GetData();
+	const uint16* bf = bandFar.GetData();
+	uint8* m = mask.GetData();
+	uint32 i = 0;
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS
+	// d >= near and d <= far are both tested with saturating subtractions, 
+	// which are zero exactly when the unsigned comparison holds.
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 8 <= numPixels; i += 8) {
+		const __m128i depth8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i));
+		const __m128i near8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bn + i));
+		const __m128i far8 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bf + i));
+		const __m128i inside = _mm_and_si128(_mm_cmpeq_epi16(_mm_subs_epu16(near8, depth8), zero),
+											 _mm_cmpeq_epi16(_mm_subs_epu16(depth8, far8), zero));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(m + i), _mm_packs_epi16(inside, zero));
+	}
+#endif
+
+	for (; i < numPixels; ++i) {
+		m[i] = ((d[i] >= bn[i]) && (d[i] <= bf[i])) ? 0xFF : 0;
+	}
+}
+
+void TouchDetector::ExtractBlobs(const TArray<uint16>& depth, TArray<FTouchPoint>& touches)
+{
+	runs.Reset();
+	parents.Reset();
+	blobs.Reset();
+
+	// Label the runs of touching pixels in each row and merge them with the 
+	// overlapping runs of the previous row (4-connectivity).
+	int32 previousRowBegin = 0;
+	int32 previousRowEnd = 0;
+	for (uint32 y = 0; y < height; ++y) {
+		const uint8* row = mask.GetData() + y * width;
+		const uint16* depthRow = depth.GetData() + y * width;
+		const uint16* referenceRow = reference.GetData() + y * width;
+
+		const int32 rowBegin = runs.Num();
+		int32 overlap = previousRowBegin;
+		for (uint32 x = 0; x < width; ) {
+			if (row[x] == 0) {
+				++x;
+				continue;
+			}
+
+			TouchRun run;
+			run.start = x;
+			Blob blob = { 0, 0.0f, static_cast<float>(y), 0.0f };
+			while ((x < width) && (row[x] != 0)) {
+				blob.sumHeight += referenceRow[x] - depthRow[x];
+				++x;
+			}
+			run.end = x;
+			run.label = parents.Num();
+
+			blob.area = run.end - run.start;
+			blob.sumX = 0.5f * (run.start + run.end - 1) * blob.area;
+			blob.sumY *= blob.area;
+			parents.Add(run.label);
+			blobs.Add(blob);
+
+			while ((overlap < previousRowEnd) && (runs[overlap].end <= run.start)) {
+				++overlap;
+			}
+			for (int32 i = overlap; (i < previousRowEnd) && (runs[i].start < run.end); ++i) {
+				Union(runs[i].label, run.label);
+			}
+
+			runs.Add(run);
+		}
+		previousRowBegin = rowBegin;
+		previousRowEnd = runs.Num();
+	}
+
+	// Union() keeps the sums up to date on the roots
+	for (int32 label = 0; label < parents.Num(); ++label) {
+		const Blob& blob = blobs[label];
+		if ((parents[label] == label) && (blob.area >= minArea) && (blob.area <= maxArea)) {
+			FTouchPoint touch;
+			touch.Position = FVector2D((blob.sumX / blob.area + 0.5f) / width, (blob.sumY / blob.area + 0.5f) / height);
+			touch.Height = blob.sumHeight / blob.area;
+			touch.Area = blob.area;
+			touches.Add(touch);
+		}
+	}
+}
+
+// Greedily matches the closest pairs of previous and new touches. New 
+// touches without a match get a new identifier.
+void TouchDetector::Track(TArray<FTouchPoint>& touches)
+{
+	struct Match {
+		float distanceSquared;
+		int32 previous;
+		int32 current;
+	};
+
+	TArray<Match> matches;
+	for (int32 i = 0; i < previousTouches.Num(); ++i) {
+		for (int32 j = 0; j < touches.Num(); ++j) {
+			const float distanceSquared = FVector2D::DistSquared(previousTouches[i].Position, touches[j].Position);
+			if (distanceSquared <= MaxTrackDistance * MaxTrackDistance) {
+				matches.Add({ distanceSquared, i, j });
+			}
+		}
+	}
+	matches.Sort([](const Match& a, const Match& b) { return a.distanceSquared < b.distanceSquared; });
+
+	TArray<bool> previousMatched;
+	previousMatched.SetNumZeroed(previousTouches.Num());
+	for (FTouchPoint& touch : touches) {
+		touch.Id = 0;
+	}
+	for (const Match& match : matches) {
+		if ((previousMatched[match.previous] == false) && (touches[match.current].Id == 0)) {
+			previousMatched[match.previous] = true;
+			touches[match.current].Id = previousTouches[match.previous].Id;
+		}
+	}
+	for (FTouchPoint& touch : touches) {
+		if (touch.Id == 0) {
+			touch.Id = nextId++;
+		}
+	}
+
+	previousTouches = touches;
+}
+
+int32 TouchDetector::FindRoot(int32 label)
+{
+	while (parents[label] != label) {
+		parents[label] = parents[parents[label]];
+		label = parents[label];
+	}
+	return label;
+}
+
+void TouchDetector::Union(int32 a, int32 b)
+{
+	a = FindRoot(a);
+	b = FindRoot(b);
+	if (a == b) {
+		return;
+	}
+	if (a > b) {
+		Swap(a, b);
+	}
+	parents[b] = a;
+	blobs[a].area += blobs[b].area;
+	blobs[a].sumX += blobs[b].sumX;
+	blobs[a].sumY += blobs[b].sumY;
+	blobs[a].sumHeight += blobs[b].sumHeight;
+}
@@ -0,0 +1,115 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+// Detects fingertips touching a static surface in a stream of depth images.
+//
+// Calibration averages a number of depth images of the empty surface into a
+// per-pixel reference depth and noise estimate, so the surface does not need
+// to be flat. Tracking keeps the pixels that lie within a thin height band 
+// above the reference with an SSE2 pass over each row, labels the runs of 
+// those pixels with a union-find, and matches the resulting blobs to the 
+// touches of the previous image to keep their identifiers.
+class TouchDetector {
+public:
+	TouchDetector();
+
+	// Discards the reference surface and averages the next numFrames images
+	// into a new one. numFrames is clamped to [1, MaxCalibrationFrames].
+	void StartCalibration(uint32 numFrames);
+
+	inline bool IsCalibrating() const { return calibrationFramesLeft > 0; }
+
+	inline bool IsCalibrated() const { return bCalibrated; }
+
+	// Sets the height band (in millimeters above the surface) of touching 
+	// pixels and the range of blob areas (in pixels) reported as touches.
+	void Configure(uint16 minHeight, uint16 maxHeight, uint32 minArea, uint32 maxArea);
+
+	// Processes one depth image (in millimeters). While calibrating, the 
+	// image is added to the reference and no touches are reported.
+	void Process(const TArray<uint16>& depth, const uint32 width, const uint32 height, TArray<FTouchPoint>& touches);
+
+	// Pixels must be at least this many standard deviations of the calibration
+	// noise above the surface.
+	static const uint32 NoiseSigmas = 3;
+
+	// Frames that the 16-bit per-pixel counts and 32-bit depth sums of the 
+	// calibration can hold without overflowing
+	static const uint32 MaxCalibrationFrames = 1024;
+
+private:
+	// A horizontal run of touching pixels [start, end) in one row
+	struct TouchRun {
+		uint32 start;
+		uint32 end;
+		int32 label;
+	};
+
+	// Sums over the pixels of a blob, kept on the union-find roots
+	struct Blob {
+		uint32 area;
+		float sumX;
+		float sumY;
+		float sumHeight;
+	};
+
+	uint32 width;
+	uint32 height;
+
+	uint16 minHeight;
+	uint16 maxHeight;
+	uint32 minArea;
+	uint32 maxArea;
+
+	// Calibration state
+	uint32 calibrationFramesLeft;
+	bool bCalibrated;
+	TArray<uint32> depthSum;
+	TArray<uint64> depthSquaredSum;
+	TArray<uint16> validCount;
+
+	// Reference surface and noise, and the per-pixel depth band derived from them
+	TArray<uint16> reference;
+	TArray<uint16> noise;
+	TArray<uint16> bandNear;
+	TArray<uint16> bandFar;
+	bool bBandChanged;
+
+	TArray<uint8> mask;
+	TArray<TouchRun> runs;
+	TArray<int32> parents;
+	TArray<Blob> blobs;
+
+	TArray<FTouchPoint> previousTouches;
+	int32 nextId;
+
+	void FinishCalibration();
+
+	void UpdateBand();
+
+	void Threshold(const TArray<uint16>& depth);
+
+	void ExtractBlobs(const TArray<uint16>& depth, TArray<FTouchPoint>& touches);
+
+	void Track(TArray<FTouchPoint>& touches);
+
+	int32 FindRoot(int32 label);
+
+	void Union(int32 a, int32 b);
+};
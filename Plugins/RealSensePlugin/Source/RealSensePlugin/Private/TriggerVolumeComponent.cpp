@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "TriggerVolumeComponent.h"
+
+// The volume is driven by the RealSenseSessionManager, so this component
+// does not need to tick.
+UTriggerVolumeComponent::UTriggerVolumeComponent(const class FObjectInitializer& ObjInit) 
+	: Super(ObjInit) 
+{ 
+	m_feature = RealSenseFeature::CAMERA_STREAMING;
+	PrimaryComponentTick.bCanEverTick = false;
+
+	VolumeTransform = FTransform::Identity;
+	BoxExtent = FVector(25.0f, 25.0f, 25.0f);
+	MinPoints = 50;
+	PointCount = 0;
+	VolumeId = INDEX_NONE;
+}
+
+void UTriggerVolumeComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	VolumeId = globalRealSenseSession->AddTriggerVolume(this, MakeVolume());
+}
+
+void UTriggerVolumeComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (globalRealSenseSession && (VolumeId != INDEX_NONE)) {
+		globalRealSenseSession->RemoveTriggerVolume(VolumeId);
+		VolumeId = INDEX_NONE;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UTriggerVolumeComponent::SetVolume(FTransform Transform, FVector Extent)
+{
+	VolumeTransform = Transform;
+	BoxExtent = Extent;
+	UpdateVolume();
+}
+
+void UTriggerVolumeComponent::UpdateVolume()
+{
+	if (globalRealSenseSession && (VolumeId != INDEX_NONE)) {
+		globalRealSenseSession->UpdateTriggerVolume(VolumeId, MakeVolume());
+	}
+}
+
+void UTriggerVolumeComponent::SetPointStride(int32 Stride)
+{
+	globalRealSenseSession->SetTriggerVolumeStride(Stride);
+}
+
+bool UTriggerVolumeComponent::IsOccupied() const
+{
+	return PointCount > 0;
+}
+
+void UTriggerVolumeComponent::UpdatePointCount(int32 Count)
+{
+	const bool bWasOccupied = IsOccupied();
+	PointCount = Count;
+
+	if ((bWasOccupied == false) && IsOccupied()) {
+		OnTriggerEnter.Broadcast();
+	}
+	else if (bWasOccupied && (IsOccupied() == false)) {
+		OnTriggerExit.Broadcast();
+	}
+}
+
+// Places the box in the world using the transform of the owning actor.
+TriggerVolume UTriggerVolumeComponent::MakeVolume() const
+{
+	const AActor* Owner = GetOwner();
+	const FTransform WorldTransform = Owner ? VolumeTransform * Owner->GetActorTransform() : VolumeTransform;
+	return { 0, WorldTransform, BoxExtent.GetAbs(), FMath::Max(MinPoints, 1) };
+}
@@ -0,0 +1,183 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#include "RealSensePluginPrivatePCH.h"
+#include "TriggerVolumeTester.h"
+#include "ParallelFor.h"
+#include <algorithm>
+
+DECLARE_CYCLE_STAT(TEXT("Trigger Volumes"), STAT_RealSenseTriggerVolumes, STATGROUP_RealSense);
+
+// Maximum number of volumes in a leaf of the hierarchy
+static const int32 MaxLeafVolumes = 4;
+
+// Number of row bands tested in parallel
+static const int32 NumBands = 16;
+
+TriggerVolumeTester::TriggerVolumeTester()
+{
+	bandCounts.SetNum(NumBands);
+}
+
+// Top-down build that splits the volumes at the median of their centers
+// along the longest axis of the node. The volumes are reordered so that
+// every leaf references a contiguous range.
+void TriggerVolumeTester::SetVolumes(const TArray<TriggerVolume>& newVolumes)
+{
+	nodes.Reset();
+	volumes.Reset();
+	worldToVolume.Reset();
+	if (newVolumes.Num() == 0) {
+		return;
+	}
+
+	TArray<FBox> bounds;
+	TArray<int32> order;
+	bounds.SetNumUninitialized(newVolumes.Num());
+	order.SetNumUninitialized(newVolumes.Num());
+	for (int32 i = 0; i < newVolumes.Num(); ++i) {
+		bounds[i] = FBox(-newVolumes[i].extent, newVolumes[i].extent).TransformBy(newVolumes[i].transform);
+		order[i] = i;
+	}
+
+	nodes.AddUninitialized();
+	BuildNode(bounds, order, 0, 0, order.Num());
+
+	volumes.Reserve(order.Num());
+	worldToVolume.Reserve(order.Num());
+	for (int32 i : order) {
+		volumes.Add(newVolumes[i]);
+		worldToVolume.Add(newVolumes[i].transform.ToMatrixWithScale().Inverse());
+	}
+}
+
+void TriggerVolumeTester::BuildNode(const TArray<FBox>& bounds, TArray<int32>& order, int32 index, int32 first, int32 count)
+{
+	FBox nodeBounds(ForceInit);
+	FBox centerBounds(ForceInit);
+	for (int32 i = first; i < first + count; ++i) {
+		nodeBounds += bounds[order[i]];
+		centerBounds += bounds[order[i]].GetCenter();
+	}
+	nodes[index].bounds = nodeBounds;
+
+	if (count <= MaxLeafVolumes) {
+		nodes[index].first = first;
+		nodes[index].count = count;
+		return;
+	}
+
+	const FVector size = centerBounds.GetSize();
+	const int32 axis = (size.X >= size.Y && size.X >= size.Z) ? 0 : ((size.Y >= size.Z) ? 1 : 2);
+	const int32 half = count / 2;
+	int32* range = order.GetData() + first;
+	std::nth_element(range, range + half, range + count, [&bounds, axis](int32 a, int32 b) {
+		return bounds[a].GetCenter()[axis] < bounds[b].GetCenter()[axis];
+	});
+
+	// Children are stored next to each other
+	const int32 children = nodes.AddUninitialized(2);
+	nodes[index].first = children;
+	nodes[index].count = 0;
+	BuildNode(bounds, order, children, first, half);
+	BuildNode(bounds, order, children + 1, first + half, count - half);
+}
+
+// The world position of pixel (u, v) at depth z is origin + z * (ray0 + u * rayU + v * rayV),
+// so the rays are computed once per frame from the camera intrinsics and pose.
+void TriggerVolumeTester::Test(const TArray<uint16>& depth, const uint32 width, const uint32 height,
+							   float horizontalFOV, float verticalFOV, const FTransform& cameraToWorld,
+							   const uint32 stride, TArray<FIntPoint>& occupancy)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RealSenseTriggerVolumes);
+
+	occupancy.Reset();
+	if ((volumes.Num() == 0) || (depth.Num() < (int32)(width * height)) || (width == 0) || (height == 0)) {
+		return;
+	}
+
+	const float fx = 0.5f * width / FMath::Tan(FMath::DegreesToRadians(horizontalFOV * 0.5f));
+	const float fy = 0.5f * height / FMath::Tan(FMath::DegreesToRadians(verticalFOV * 0.5f));
+	const float cx = 0.5f * width;
+	const float cy = 0.5f * height;
+
+	// Camera space in millimeters to world space in centimeters
+	const float millimetersToCentimeters = 0.1f;
+	const FVector origin = cameraToWorld.GetLocation();
+	const FVector ray0 = cameraToWorld.TransformVector(ConvertRSVectorToUnreal(FVector(-cx / fx, -cy / fy, 1.0f)) * millimetersToCentimeters);
+	const FVector rayU = cameraToWorld.TransformVector(ConvertRSVectorToUnreal(FVector(1.0f / fx, 0.0f, 0.0f)) * millimetersToCentimeters);
+	const FVector rayV = cameraToWorld.TransformVector(ConvertRSVectorToUnreal(FVector(0.0f, 1.0f / fy, 0.0f)) * millimetersToCentimeters);
+
+	const FBox& rootBounds = nodes[0].bounds;
+	const uint32 step = FMath::Max(stride, 1u);
+	const uint32 rows = (height + step - 1) / step;
+
+	ParallelFor(NumBands, [&](int32 band) {
+		TMap<int32, int32>& counts = bandCounts[band];
+		counts.Reset();
+
+		int32 stack[64];
+		for (uint32 row = band * rows / NumBands; row < (band + 1) * rows / NumBands; ++row) {
+			const uint32 v = row * step;
+			const uint16* line = depth.GetData() + v * width;
+			const FVector rowRay = ray0 + rayV * (float)v;
+			for (uint32 u = 0; u < width; u += step) {
+				const uint16 z = line[u];
+				if (z == 0) {
+					continue;
+				}
+				const FVector point = origin + (rowRay + rayU * (float)u) * (float)z;
+				if (rootBounds.IsInside(point) == false) {
+					continue;
+				}
+
+				int32 top = 0;
+				stack[top++] = 0;
+				while (top > 0) {
+					const Node& node = nodes[stack[--top]];
+					if (node.bounds.IsInside(point) == false) {
+						continue;
+					}
+					if (node.count == 0) {
+						stack[top++] = node.first;
+						stack[top++] = node.first + 1;
+						continue;
+					}
+					for (int32 i = node.first; i < node.first + node.count; ++i) {
+						const FVector local = worldToVolume[i].TransformPosition(point);
+						const FVector& extent = volumes[i].extent;
+						if ((FMath::Abs(local.X) <= extent.X) && (FMath::Abs(local.Y) <= extent.Y) && (FMath::Abs(local.Z) <= extent.Z)) {
+							counts.FindOrAdd(i)++;
+						}
+					}
+				}
+			}
+		}
+	});
+
+	// Merge the bands, which only touches volumes that received points
+	TMap<int32, int32>& total = bandCounts[0];
+	for (int32 band = 1; band < NumBands; ++band) {
+		for (const TPair<int32, int32>& entry : bandCounts[band]) {
+			total.FindOrAdd(entry.Key) += entry.Value;
+		}
+	}
+	for (const TPair<int32, int32>& entry : total) {
+		if (entry.Value >= volumes[entry.Key].minPoints) {
+			occupancy.Add(FIntPoint(volumes[entry.Key].id, entry.Value));
+		}
+	}
+	occupancy.Sort([](const FIntPoint& a, const FIntPoint& b) { return a.X < b.X; });
+}
@@ -0,0 +1,70 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+// An oriented box in world space that counts the depth points inside it
+struct TriggerVolume {
+	int32 id;
+	FTransform transform;  // Volume to world, the box spans [-extent, extent] in volume space
+	FVector extent;
+	int32 minPoints;  // Points needed for the volume to count as occupied
+};
+
+// Counts the points of depth images that fall inside a set of trigger volumes.
+//
+// The world-space bounds of the volumes are organized in a bounding volume
+// hierarchy, so each point only visits the volumes whose bounds contain it
+// and the cost does not grow with volumes that stay empty. Points are
+// deprojected with a pinhole model from the field of view of the depth camera
+// and tested in parallel over bands of rows. The result only lists occupied
+// volumes.
+class TriggerVolumeTester {
+public:
+	TriggerVolumeTester();
+
+	// Replaces the volumes and rebuilds the hierarchy.
+	void SetVolumes(const TArray<TriggerVolume>& volumes);
+
+	inline bool HasVolumes() const { return volumes.Num() > 0; }
+
+	// Tests every stride-th pixel in both directions of the depth image (in
+	// millimeters). cameraToWorld places the camera in the world, with points
+	// converted to UE4 axes and centimeters. occupancy receives the id and
+	// point count of every volume with at least minPoints points, sorted by id.
+	void Test(const TArray<uint16>& depth, const uint32 width, const uint32 height,
+			  float horizontalFOV, float verticalFOV, const FTransform& cameraToWorld,
+			  const uint32 stride, TArray<FIntPoint>& occupancy);
+
+private:
+	// Leaves have a count > 0 and reference count volumes starting at first;
+	// inner nodes have their children at first and first + 1.
+	struct Node {
+		FBox bounds;
+		int32 first;
+		int32 count;
+	};
+
+	TArray<TriggerVolume> volumes;
+	TArray<FMatrix> worldToVolume;
+	TArray<Node> nodes;
+
+	// Per-band point counts, keyed by volume index
+	TArray<TMap<int32, int32>> bandCounts;
+
+	void BuildNode(const TArray<FBox>& bounds, TArray<int32>& order, int32 index, int32 first, int32 count);
+};
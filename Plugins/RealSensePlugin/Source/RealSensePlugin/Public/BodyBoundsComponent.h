@@ -0,0 +1,64 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseComponent.h"
+#include "BodyBoundsComponent.generated.h"
+
+// Provides the bounding box, head height and velocity of the person closest 
+// to the depth camera, for installations that do not need a skeleton. The 
+// bounds are in world space, with the RealSenseSessionManager actor placed 
+// where the camera is. Setting the floor plane keeps the floor out of the 
+// body and measures the head height from it.
+UCLASS(editinlinenew, meta = (BlueprintSpawnableComponent), ClassGroup = RealSense) 
+class UBodyBoundsComponent : public URealSenseComponent
+{
+	GENERATED_UCLASS_BODY()
+
+	// Bounds of the person in the latest depth image
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	FBodyBounds BodyBounds;
+
+	// Triggered when a person is found after no person was seen.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FRealSenseNullaryDelegate OnBodyFound;
+
+	// Triggered when the person is no longer seen.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FRealSenseNullaryDelegate OnBodyLost;
+
+	// Starts estimating the body bounds every frame. Requires the depth camera 
+	// resolution to be set.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void EnableBodyBounds();
+
+	// Stops estimating the body bounds.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void DisableBodyBounds();
+
+	// Sets the floor through Point with the given upward Normal, in world space.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void SetFloorPlane(FVector Point, FVector Normal = FVector(0.0f, 0.0f, 1.0f));
+
+	// Removes the floor plane. Head heights are then world Z coordinates.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void ClearFloorPlane();
+
+	UBodyBoundsComponent();
+
+	void TickComponent(float DeltaTime, enum ELevelTick TickType, 
+		               FActorComponentTickFunction *ThisTickFunction) override;
+};
@@ -38,18 +38,69 @@ class UCameraStreamComponent : public URealSenseComponent
 	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
 	TArray<int32> DepthBuffer;
 
+	// Quality metrics of the frame stored in the DepthBuffer: ratio of valid 
+	// pixels, holes, temporal noise, and median depth.
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	FDepthQualityMetrics DepthQuality;
+
+	// Array of depth values (in millimeters) upsampled to half or full color 
+	// resolution and aligned with the ColorBuffer. This buffer is only updated 
+	// after calling EnableDepthUpsampling().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	TArray<int32> UpsampledDepthBuffer;
+
+	// Average time in milliseconds the camera thread spends upsampling one 
+	// depth image at the current pair of resolutions.
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	float DepthUpsampleMilliseconds;
+
+	// Signed distance field of the foreground silhouette as raw 8- or 16-bit 
+	// pixels. Values above half range are outside the silhouette, values below
+	// are inside. This buffer is only updated after calling EnableDistanceField().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	TArray<uint8> DistanceFieldBuffer;
+
 	// Texture2D object used to easily visualize the ColorBuffer. 
 	// This texture is initialized upon setting the color camera resolution, and 
-	// should be set by calling ColorBufferToTexture().
+	// should be set by calling UpdateTextures() or ColorBufferToTexture().
 	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
 	UTexture2D* ColorTexture;
 
 	// Texture2D object used to easily visualize the DepthBuffer. 
-	// This texture is initialized upon setting the color camera resolution, and 
-	// should be set by calling DepthBufferToTexture().
+	// This texture is initialized upon setting the depth camera resolution, and 
+	// should be set by calling UpdateTextures() or DepthBufferToTexture().
 	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
 	UTexture2D* DepthTexture;
 
+	// Texture2D object used to easily visualize the UpsampledDepthBuffer. 
+	// This texture is initialized by EnableDepthUpsampling(), and should be set 
+	// by calling DepthBufferToTexture().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	UTexture2D* UpsampledDepthTexture;
+
+	// Single-channel Texture2D object used to sample the DistanceFieldBuffer in
+	// materials. This texture is initialized by EnableDistanceField(), and should
+	// be set by calling DistanceFieldBufferToTexture().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	UTexture2D* DistanceFieldTexture;
+
+	// Pixel format of the ColorTexture, DepthTexture and UpsampledDepthTexture.
+	// Block compressed textures (BC1 color, BC4 depth) store half a byte per 
+	// pixel, an eighth of the memory and upload bandwidth of the uncompressed 
+	// BGRA textures, at the cost of encoding them on the CPU. BC4 depth 
+	// textures hold the depth visualization in the red channel.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RealSense") 
+	ETextureCompression TextureCompression;
+
+	// Average time in milliseconds spent filling the textures in UpdateTextures().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	float TextureUpdateMilliseconds;
+
+	// Triggered when a replay played forward reaches the frame at which it 
+	// was started, and the buffers show live camera images again.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense")
+	FRealSenseNullaryDelegate OnReplayFinished;
+
 	// Sets the resolution that the RealSense RGB camera should use. 
 	// This function must be called before StartCamera() in order to 
 	// enable the RGB camera.
@@ -68,10 +119,127 @@ class UCameraStreamComponent : public URealSenseComponent
 	UFUNCTION(BlueprintCallable, Category = "RealSense")
 	virtual void Enable3DSegmentation(bool b3DSeg);
 
+	// Upsamples every depth frame to half or full color resolution using the 
+	// RGB camera image as a guide. This function must be called after setting 
+	// both camera resolutions. A running camera is restarted if the size of the
+	// upsampled image changes.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void EnableDepthUpsampling(EDepthUpsampleScale Scale);
+
+	// Stops upsampling depth frames.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void DisableDepthUpsampling();
+
+	// Computes a signed distance field of the user's silhouette every frame at
+	// a resolution of Width x Height. The silhouette is taken from 3D 
+	// segmentation or from the depth range set by SetDistanceFieldDepthRange().
+	// Distances beyond MaxDistance pixels saturate. This function must be called
+	// after setting the camera resolutions. A running camera is restarted if 
+	// the configuration changes.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void EnableDistanceField(EDistanceFieldSource Source = EDistanceFieldSource::DEPTH_THRESHOLD, 
+							 int32 Width = 320, int32 Height = 240,
+							 EDistanceFieldFormat Format = EDistanceFieldFormat::G8, 
+							 float MaxDistance = 32.0f);
+
+	// Stops computing the distance field.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void DisableDistanceField();
+
+	// Sets the range of depth values (in millimeters) that belong to the 
+	// silhouette when the distance field uses the depth threshold source.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void SetDistanceFieldDepthRange(int32 NearDepth = 200, int32 FarDepth = 1000);
+
+	// Recreates the ColorTexture, DepthTexture and UpsampledDepthTexture with 
+	// the pixel format of the given compression.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void SetTextureCompression(ETextureCompression Compression);
+
+	// Fills the ColorTexture, DepthTexture and UpsampledDepthTexture with the 
+	// latest buffers, encoding them on worker threads if they are compressed.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void UpdateTextures();
+
+	// Encodes the latest ColorBuffer and DepthBuffer with every compression 
+	// mode and writes the time and error of each to the log.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void BenchmarkTextureCompression();
+
+	// Replaces the camera with a stand-in source that writes the frame number 
+	// and capture time into the top rows of every color image. Each frame is 
+	// read back when the session manager picks it up and, after UpdateTextures(),
+	// from the ColorTexture on the render thread, which measures the latency
+	// from capture to a texture ready for drawing. Requires the color camera 
+	// resolution to be set. The camera does not need to be connected.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void StartLatencyTest(float FramesPerSecond = 30.0f);
+
+	// Writes the latency distributions of the test to the log and switches 
+	// back to the camera.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void StopLatencyTest();
+
+	// Keeps the camera frames of the last DurationSeconds in memory so that 
+	// they can be replayed. The frames are compressed on a worker thread and 
+	// the oldest ones are discarded when they exceed MemoryLimitMB megabytes.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void EnableFrameRecording(float DurationSeconds = 10.0f, int32 MemoryLimitMB = 256);
+
+	// Stops recording frames and discards the recording.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void DisableFrameRecording();
+
+	// Fills the ColorBuffer and DepthBuffer with recorded frames, starting 
+	// SecondsAgo before now and playing at Speed (negative to rewind), while
+	// the camera keeps capturing and recording. The head crop, upsampled 
+	// depth and distance field buffers are blank during the replay; the scan
+	// preview and all non-image outputs stay live.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void StartReplay(float SecondsAgo = 5.0f, float Speed = 1.0f);
+
+	// Jumps to the recorded frame SecondsAgo before now.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void SeekReplay(float SecondsAgo);
+
+	// Changes the playback speed of the replay. 0 holds the current frame.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void SetReplaySpeed(float Speed);
+
+	// Returns to live camera images.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void StopReplay();
+
+	// Returns true while recorded frames are shown.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense")
+	bool IsReplaying();
+
+	// Returns the number of seconds that can currently be replayed.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense")
+	float GetRecordedSeconds();
+
+	// Returns how many seconds before now the replayed frame was captured.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense")
+	float GetReplaySecondsAgo();
+
 	UCameraStreamComponent();
 
 	void InitializeComponent() override;
 
 	void TickComponent(float DeltaTime, enum ELevelTick TickType, 
 					   FActorComponentTickFunction *ThisTickFunction) override;
+
+private:
+	// Used internally to know when to copy the UpsampledDepthBuffer.
+	bool bDepthUpsampleEnabled{ false };
+
+	// Used internally to know when to copy the DistanceFieldBuffer.
+	bool bDistanceFieldEnabled{ false };
+
+	// Used internally to know when to trigger OnReplayFinished.
+	bool bReplayStarted{ false };
+
+	EPixelFormat GetColorPixelFormat() const;
+
+	EPixelFormat GetDepthPixelFormat() const;
 };
@@ -0,0 +1,84 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseComponent.h"
+#include "DepthMeshComponent.generated.h"
+
+class DepthMeshBuilder;
+
+// Builds a lightweight triangle mesh of the surfaces in front of the depth 
+// camera. Flat surfaces such as walls and tables are covered by a few large
+// triangles, while curved and detailed surfaces get smaller ones, so the 
+// mesh has far fewer triangles than one triangle pair per depth pixel for 
+// the same error. The mesh is built on a worker thread, and the arrays match
+// the parameters of CreateMeshSection() on a ProceduralMeshComponent. 
+// Vertices are in centimeters relative to the camera, so place the mesh 
+// where the physical camera is.
+UCLASS(editinlinenew, meta = (BlueprintSpawnableComponent), ClassGroup = RealSense) 
+class UDepthMeshComponent : public URealSenseComponent
+{
+	GENERATED_UCLASS_BODY()
+
+	// Number of meshes built per second, or 0 to stop building
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RealSense", meta = (ClampMin = "0.0"))
+	float UpdatesPerSecond;
+
+	// Grid steps across the depth image at the finest level of detail. 
+	// Rounded to a power of two.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RealSense", meta = (ClampMin = "16", ClampMax = "512"))
+	int32 GridResolution;
+
+	// Largest distance (in millimeters) between a depth sample and the mesh 
+	// that does not need a smaller triangle
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RealSense", meta = (ClampMin = "0.0"))
+	float MaxError;
+
+	// Mesh vertices relative to the camera (in centimeters)
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	TArray<FVector> Vertices;
+
+	// Vertex indices, three per triangle
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	TArray<int32> Triangles;
+
+	// Vertex normals, facing the camera
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	TArray<FVector> Normals;
+
+	// Vertex positions in the depth image, normalized to 0 - 1
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	TArray<FVector2D> UV0;
+
+	// Triggered when a new mesh has been built.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FRealSenseNullaryDelegate OnDepthMeshUpdated;
+
+	UDepthMeshComponent();
+
+	void BeginPlay() override;
+
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	void TickComponent(float DeltaTime, enum ELevelTick TickType, 
+		               FActorComponentTickFunction *ThisTickFunction) override;
+
+private:
+	std::shared_ptr<DepthMeshBuilder> Builder;
+
+	double LastBuildTime;
+	uint64 LastBuildFrame;
+};
@@ -32,6 +32,56 @@ class UHeadTrackingComponent : public URealSenseComponent
 	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
 	FRotator HeadRotation;
 
+	// Array of RGBA color values holding a fixed-size crop of the RGB camera 
+	// image centered on the tracked head. This buffer is only updated after
+	// calling EnableHeadCrop().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	TArray<FSimpleColor> HeadCropBuffer;
+
+	// Texture2D object used to easily visualize the HeadCropBuffer. 
+	// This texture is initialized by EnableHeadCrop(), and should be set by 
+	// calling ColorBufferToTexture().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	UTexture2D* HeadCropTexture;
+
+	// Head poses of all camera frames processed since the previous tick, 
+	// oldest first. This array is only updated after calling 
+	// EnableHeadPoseQueue(), and is refilled on every tick.
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	TArray<FHeadPoseSample> HeadPoseSamples;
+
+	// Number of head poses lost since the previous tick because the queue 
+	// was full.
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	int32 DroppedHeadPoseSamples;
+
+	// Number of head poses lost since EnableHeadPoseQueue() was called.
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	int32 TotalDroppedHeadPoseSamples;
+
+	// Crops and scales the RGB camera image around the tracked head into an 
+	// image of Width x Height pixels. Smoothing (0 - 1) controls how slowly 
+	// the crop follows head movement. This function must be called after 
+	// SetColorCameraResolution(). A running camera is restarted if the size of
+	// the crop changes.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void EnableHeadCrop(int32 Width = 256, int32 Height = 256, float Smoothing = 0.8f);
+
+	// Stops updating the HeadCropBuffer.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void DisableHeadCrop();
+
+	// Queues the head pose of every camera frame, so that no pose is lost 
+	// when the game ticks slower than the camera. Capacity is the number of 
+	// samples held between two ticks; further samples are dropped and 
+	// counted. Only one HeadTrackingComponent should enable the queue.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void EnableHeadPoseQueue(int32 Capacity = 256);
+
+	// Stops updating the HeadPoseSamples.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void DisableHeadPoseQueue();
+
 	UHeadTrackingComponent();
 
 	void InitializeComponent() override;
@@ -40,4 +90,9 @@ class UHeadTrackingComponent : public URealSenseComponent
 		               FActorComponentTickFunction *ThisTickFunction) override;
 
 private:
+	// Used internally to know when to copy the HeadCropBuffer.
+	bool bHeadCropEnabled{ false };
+
+	// Used internally to know when to drain the head pose queue.
+	bool bHeadPoseQueueEnabled{ false };
 };
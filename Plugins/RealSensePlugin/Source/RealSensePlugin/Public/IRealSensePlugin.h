@@ -17,9 +17,18 @@
 
 #include "ModuleManager.h"
 
+#include <memory>
+
+class RealSenseImpl;
+
 struct IRealSensePlugin : public IModuleInterface
 {
 	static inline IRealSensePlugin& Get() { return FModuleManager::LoadModuleChecked<IRealSensePlugin>("RealSensePlugin"); }
 	static inline bool IsAvailable() { return FModuleManager::Get().IsModuleLoaded("RealSensePlugin"); }
+
+	// Returns the capture pipeline shared by all RealSenseSessionManager actors.
+	// The pipeline is created on first use and keeps running across level 
+	// transitions until the module is shut down.
+	virtual std::shared_ptr<RealSenseImpl> GetCaptureService() = 0;
 };
 
@@ -19,6 +19,8 @@
 #include "RealSenseUtils.h"
 #include "RealSenseBlueprintLibrary.generated.h"
 
+DECLARE_DYNAMIC_DELEGATE_OneParam(FScanAssetCreatedDelegate, UStaticMesh*, StaticMesh);
+
 UCLASS() 
 class URealSenseBlueprintLibrary : public UBlueprintFunctionLibrary
 {
@@ -37,18 +39,23 @@ class URealSenseBlueprintLibrary : public UBlueprintFunctionLibrary
 	static FString ECameraModelToString(ECameraModel value);
 
 	// Fills a Texture2D object with the data from a buffer of FSimpleColors.
+	// Textures with the DXT1 pixel format are filled with BC1 blocks encoded
+	// on the CPU.
 	// This function will return null if the size of the input buffer does not
 	// match the resolution of the Texture2D object.
 	// @param Buffer - TArray of FSimpleColor values (RGBA)
 	// @param Texture - Texture2D object to fill with data
+	// @param bHighQuality - Use the slower, more accurate BC1 encoder
 	// @return The input Texture2D object, modified to contain the data from the 
 	// input buffer
 	UFUNCTION(BlueprintCallable, Category = "RealSense Utilities") 
 	static UTexture2D* ColorBufferToTexture(const TArray<FSimpleColor>& Buffer, 
-											UTexture2D* Texture);
+											UTexture2D* Texture, bool bHighQuality = false);
 
 	// Fills a Texture2D object with the data from a buffer of integers 
 	// (representing depth values).
+	// Textures with the BC4 pixel format are filled with BC4 blocks encoded
+	// on the CPU, which hold the depth visualization in the red channel.
 	// This function will return null if the size of the input buffer does not
 	// match the resolution of the Texture2D object.
 	// @param Buffer - TArray of integer values (depth in millimeters)
@@ -59,6 +66,37 @@ class URealSenseBlueprintLibrary : public UBlueprintFunctionLibrary
 	static UTexture2D* DepthBufferToTexture(const TArray<int32>& Buffer, 
 											UTexture2D* Texture);
 
+	// Fills a single-channel (G8 or G16) Texture2D object with the raw pixels 
+	// of a distance field buffer.
+	// This function will return null if the size of the input buffer does not
+	// match the resolution and pixel format of the Texture2D object.
+	// @param Buffer - TArray of raw 8- or 16-bit pixels
+	// @param Texture - Texture2D object to fill with data
+	// @return The input Texture2D object, modified to contain the data from the 
+	// input buffer
+	UFUNCTION(BlueprintCallable, Category = "RealSense Utilities") 
+	static UTexture2D* DistanceFieldBufferToTexture(const TArray<uint8>& Buffer, 
+													UTexture2D* Texture);
+
+	// Smooths a triangle mesh in place with Taubin's shrink-free Laplacian filter.
+	// @param Vertices - Vertex positions, replaced with the smoothed positions
+	// @param Triangles - Vertex indices, three per triangle
+	// @param Iterations - Number of smoothing iterations
+	UFUNCTION(BlueprintCallable, Category = "RealSense Utilities") 
+	static void SmoothMesh(UPARAM(ref) TArray<FVector>& Vertices, const TArray<int32>& Triangles, 
+						   int32 Iterations = 5);
+
+	// Converts a scan file into a static mesh asset with LODs, convex collision
+	// and, optionally, a baked color texture named AssetPath + "_Color", applied
+	// to the mesh by a material named AssetPath + "_Material". The conversion
+	// runs in the background and OnCreated is called with the new asset, or 
+	// with null on failure. Assets can only be created in the editor.
+	// Note: Filename is relative to the /Game/Content asset directory.
+	// Example: ConvertScanToStaticMesh("Scans/Face.obj", "/Game/Scans/Face", ...)
+	UFUNCTION(BlueprintCallable, Category = "RealSense Utilities") 
+	static void ConvertScanToStaticMesh(FString Filename, FString AssetPath, const FScanAssetOptions& Options,
+										const FScanAssetCreatedDelegate& OnCreated);
+
 	// Returns an array of .OBJ filenames found in the specified directory.
 	// Note: The path is relative to the /Game/Content asset directory.
 	// Example: GetMeshFiles("Scans/Faces") searches for .OBJ files in 
@@ -79,6 +79,20 @@ class URealSenseComponent : public UActorComponent
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense") 
 	bool IsCameraRunning();
 
+	// Loads and initializes the middleware of all enabled features on a background 
+	// thread. Call this during a loading screen, after enabling the features and 
+	// setting the camera resolutions, so that the first frames after StartCamera()
+	// arrive without the multi-second delay of loading the middleware. The camera 
+	// stays prewarmed across level transitions. Changing the resolutions or the 
+	// middleware features afterwards discards the prewarmed pipeline.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void PrewarmCamera();
+
+	// Returns true if the background initialization started by PrewarmCamera() has 
+	// finished and the camera has not been started since.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense")
+	bool IsCameraPrewarmed();
+
 	// Returns the color camera resolution as an FStreamResolution object: 
 	// width, height, fps, and pixel format.
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense") 
@@ -105,6 +119,42 @@ class URealSenseComponent : public UActorComponent
 	bool IsStreamSetValid(EColorResolution ColorResolution, 
 						  EDepthResolution DepthResolution);
 	
+	// Returns the time in seconds since the latest frame, according to its 
+	// sensor timestamp mapped to the host clock. The mapping follows the 
+	// fastest observed arrival of frames, so the minimum transport latency 
+	// of the camera is not included.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense") 
+	float GetFrameAge();
+
+	// Returns the estimated standard deviation (in seconds) of the frame 
+	// timing, or a negative value until enough frames have been received.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense") 
+	float GetFrameTimestampUncertainty();
+
+	// Returns how much faster the sensor clock runs than the host clock, in 
+	// parts per million.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense") 
+	float GetClockDrift();
+
+	// Lowers the capture rate to KeepAliveFPS frames per second, or pauses the 
+	// capture if KeepAliveFPS is 0, once no component has rendered or read 
+	// RealSense data for IdleSeconds. Capturing resumes at full rate on the 
+	// next access. Setting IdleSeconds to 0 disables throttling.
+	UFUNCTION(BlueprintCallable, Category = "RealSense") 
+	void SetCaptureThrottling(float IdleSeconds = 2.0f, float KeepAliveFPS = 1.0f);
+
+	// Keeps the capture running at full rate. Camera and scan textures count 
+	// as accessed while they are being rendered, so call this function if 
+	// RealSense data is used in any other way, for example when it is only 
+	// read from the buffers or drawn by a UMG widget.
+	UFUNCTION(BlueprintCallable, Category = "RealSense") 
+	void NotifyDataAccess();
+
+	// Returns true if the capture is throttled because no RealSense data has 
+	// been accessed recently.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense") 
+	bool IsCaptureThrottled();
+	
 	URealSenseComponent();
 
 	void InitializeComponent() override;
@@ -116,4 +166,7 @@ protected:
 	ARealSenseSessionManager* globalRealSenseSession;
 
 	RealSenseFeature m_feature;
+
+	// Calls NotifyDataAccess() if the texture has been rendered recently
+	void NotifyDataAccessIfRendered(const UTexture* Texture);
 };
@@ -0,0 +1,94 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseImpl.h"
+
+// All outputs of one RealSense camera frame, obtained from 
+// ARealSenseSessionManager::GetFrameSnapshot().
+//
+// The snapshot references the frame instead of copying it, and the camera 
+// processing thread never writes to a frame that is referenced by a snapshot,
+// so every stream read from one snapshot belongs to the same frame. Release
+// snapshots when they are no longer needed, since the camera thread has to 
+// allocate a new frame for every frame that is still held.
+class FRealSenseFrameSnapshot
+{
+public:
+	FRealSenseFrameSnapshot() {}
+
+	FRealSenseFrameSnapshot(std::shared_ptr<const RealSenseDataFrame> InFrame, 
+							const FStreamResolution& InColorResolution, const FStreamResolution& InDepthResolution,
+							const FStreamResolution& InScan3DResolution, const FStreamResolution& InHeadCropResolution,
+							const FStreamResolution& InUpsampledDepthResolution, const FStreamResolution& InDistanceFieldResolution)
+		: Frame(MoveTemp(InFrame)), ColorResolution(InColorResolution), DepthResolution(InDepthResolution),
+		  Scan3DResolution(InScan3DResolution), HeadCropResolution(InHeadCropResolution),
+		  UpsampledDepthResolution(InUpsampledDepthResolution), DistanceFieldResolution(InDistanceFieldResolution) {}
+
+	// Returns true if the snapshot references a frame.
+	inline bool IsValid() const { return Frame != nullptr; }
+
+	// Releases the frame.
+	inline void Reset() { Frame.reset(); }
+
+	// Frame number, increasing with every frame acquired by the camera thread
+	inline uint64 GetFrameNumber() const { return Frame->number; }
+
+	// Host time (FPlatformTime::Seconds()) of the frame, mapped from its sensor timestamp
+	inline double GetTimestamp() const { return Frame->hostTimestamp; }
+
+	// Standard deviation (in seconds) of the timestamp, negative if unknown
+	inline double GetTimestampUncertainty() const { return Frame->timestampUncertainty; }
+
+	// Color image (BGRA, 4 bytes per pixel)
+	inline const TArray<uint8>& GetColorImage() const { return Frame->colorImage; }
+	inline const FStreamResolution& GetColorResolution() const { return ColorResolution; }
+
+	// Depth image (in millimeters)
+	inline const TArray<uint16>& GetDepthImage() const { return Frame->depthImage; }
+	inline const FStreamResolution& GetDepthResolution() const { return DepthResolution; }
+	inline const FDepthQualityMetrics& GetDepthQuality() const { return Frame->depthQuality; }
+
+	// Scan preview of the 3D scanning middleware (BGRA, 4 bytes per pixel)
+	inline const TArray<uint8>& GetScanImage() const { return Frame->scanImage; }
+	inline const FStreamResolution& GetScan3DResolution() const { return Scan3DResolution; }
+
+	// Head tracking
+	inline int32 GetHeadCount() const { return Frame->headCount; }
+	inline FVector GetHeadPosition() const { return Frame->headPosition; }
+	inline FRotator GetHeadRotation() const { return Frame->headRotation; }
+	inline const TArray<uint8>& GetHeadCropImage() const { return Frame->headCropImage; }
+	inline const FStreamResolution& GetHeadCropResolution() const { return HeadCropResolution; }
+
+	// Derived products, empty unless enabled on the session manager
+	inline const TArray<uint16>& GetUpsampledDepthImage() const { return Frame->upsampledDepthImage; }
+	inline const FStreamResolution& GetUpsampledDepthResolution() const { return UpsampledDepthResolution; }
+	inline const TArray<uint8>& GetDistanceFieldImage() const { return Frame->distanceFieldImage; }
+	inline const FStreamResolution& GetDistanceFieldResolution() const { return DistanceFieldResolution; }
+	inline const TArray<FTouchPoint>& GetTouchPoints() const { return Frame->touchPoints; }
+	inline const FBodyBounds& GetBodyBounds() const { return Frame->bodyBounds; }
+	inline const TArray<FIntPoint>& GetTriggerOccupancy() const { return Frame->triggerOccupancy; }
+
+private:
+	std::shared_ptr<const RealSenseDataFrame> Frame;
+
+	FStreamResolution ColorResolution;
+	FStreamResolution DepthResolution;
+	FStreamResolution Scan3DResolution;
+	FStreamResolution HeadCropResolution;
+	FStreamResolution UpsampledDepthResolution;
+	FStreamResolution DistanceFieldResolution;
+};
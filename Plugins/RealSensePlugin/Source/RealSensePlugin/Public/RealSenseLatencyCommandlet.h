@@ -0,0 +1,41 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "RealSenseLatencyCommandlet.generated.h"
+
+// Measures the latency from capture to an uploaded texture for every 
+// combination of color resolution and texture compression. A stand-in camera
+// source stamps every color image with its frame number and capture time. 
+// The commandlet then runs the steps of a game tick with a 
+// CameraStreamComponent: it swaps frames, copies the color buffer, and fills 
+// and uploads the color texture. The stamp is read back after each step. No
+// RealSense camera is needed, although the RealSense SDK runtime is. With 
+// -nullrhi, textures cannot be read back, so upload latencies are measured
+// when the render thread runs the upload.
+//
+// Usage: UE4Editor-Cmd <Project> -run=RealSenseLatency [-nullrhi] 
+//        [-Frames=<Frames per configuration>] [-FPS=<Camera frame rate>] 
+//        [-TickRate=<Game ticks per second>] [-Output=<CSV file>]
+// A relative output file is relative to the /Game/Saved directory.
+UCLASS()
+class URealSenseLatencyCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	int32 Main(const FString& Params) override;
+};
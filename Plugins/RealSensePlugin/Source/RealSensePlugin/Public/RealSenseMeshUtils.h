@@ -0,0 +1,109 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+// Vertex adjacency of a triangle mesh in compressed sparse row form: the 
+// neighbors of vertex i are Neighbors[Offsets[i]] to Neighbors[Offsets[i + 1] - 1].
+struct FMeshAdjacency {
+	TArray<int32> Offsets;
+	TArray<int32> Neighbors;
+
+	inline int32 NumNeighbors(int32 Vertex) const { return Offsets[Vertex + 1] - Offsets[Vertex]; }
+};
+
+// Builds the adjacency of a mesh with NumVertices vertices. Triangles that 
+// reference vertices outside of that range are ignored.
+void BuildMeshAdjacency(int32 NumVertices, const TArray<int32>& Triangles, FMeshAdjacency& Adjacency);
+
+// Smooths the mesh with Taubin's shrink-free Laplacian filter. Each iteration
+// applies a smoothing step (Lambda > 0) followed by an inflating step 
+// (Mu < -Lambda).
+void SmoothMeshTaubin(TArray<FVector>& Vertices, const TArray<int32>& Triangles, int32 Iterations,
+					  float Lambda = 0.5f, float Mu = -0.53f);
+
+// Computes area-weighted vertex normals and matching unit tangents of a 
+// triangle mesh. Vertices that are not referenced by any triangle receive 
+// an up-facing normal.
+void ComputeMeshNormalsAndTangents(const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+								   TArray<FVector>& Normals, TArray<FVector>& Tangents);
+
+// Removes triangles with invalid or repeated indices, connected components 
+// with less than MinComponentFraction of the remaining triangles, and the 
+// vertices that are no longer referenced. VertexRemap receives the new index
+// of each old vertex, or INDEX_NONE if it was removed.
+void CleanMesh(TArray<FVector>& Vertices, TArray<int32>& Triangles, float MinComponentFraction, 
+			   TArray<int32>& VertexRemap);
+
+// Simplifies the mesh by vertex clustering: the vertices in each cell of a 
+// grid with the given cell size are merged into their average, and triangles
+// that collapse are removed. Vertices are only merged if they have the same
+// entry in VertexGroups, unless that array is empty. VertexClusters receives
+// the output vertex of each input vertex, for averaging other attributes.
+void ClusterMeshVertices(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, 
+						 const TArray<int32>& VertexGroups, float CellSize, TArray<int32>& VertexClusters, 
+						 TArray<FVector>& ClusteredVertices, TArray<int32>& ClusteredTriangles);
+
+// Approximates the mesh by at most MaxHulls convex hulls, computed on a solid 
+// voxelization with Resolution voxels along the longest side of the mesh.
+void ComputeConvexDecomposition(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, 
+								int32 MaxHulls, int32 Resolution, TArray<FScanConvexHull>& Hulls);
+
+// Returns the name of the file that caches the convex hulls of a scan file.
+FString GetConvexHullCacheFilename(const FString& ScanFilename);
+
+// Loads the cached convex hulls of a scan file. Returns false if there is no 
+// cache or if it was computed from a different mesh or with different parameters.
+bool LoadConvexHullCache(const FString& ScanFilename, const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+						 int32 MaxHulls, int32 Resolution, TArray<FScanConvexHull>& Hulls);
+
+// Saves the convex hulls next to the scan file.
+bool SaveConvexHullCache(const FString& ScanFilename, const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+						 int32 MaxHulls, int32 Resolution, const TArray<FScanConvexHull>& Hulls);
+
+// Result of BakeVertexColorAtlas: the mesh split along the chart seams with a
+// texture coordinate per vertex, and the square BGRA atlas.
+struct FBakedColorAtlas {
+	TArray<FVector> Vertices;
+	TArray<int32> Triangles;
+	TArray<FVector2D> UVs;
+
+	// Index of the source vertex that each vertex was copied from, for 
+	// remapping other per-vertex attributes.
+	TArray<int32> SourceVertices;
+
+	// Chart of each vertex. Simplification must not merge vertices of 
+	// different charts.
+	TArray<int32> VertexCharts;
+
+	int32 TextureSize;
+	TArray<FColor> Texels;
+
+	// Per-vertex attributes of the source mesh, indexed by SourceVertices. 
+	// These are not filled by BakeVertexColorAtlas; a bake running in the 
+	// background stores the attributes of the mesh it baked here, so that 
+	// they are remapped from that mesh rather than from a later one.
+	TArray<FColor> SourceColors;
+	TArray<FVector> SourceNormals;
+	TArray<FVector> SourceTangents;
+};
+
+// Parameterizes the mesh into charts, packs them into a TextureSize x TextureSize
+// atlas and rasterizes the vertex colors into it. Returns false if the mesh
+// is invalid or does not fit into the atlas.
+bool BakeVertexColorAtlas(const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+						  const TArray<FColor>& Colors, int32 TextureSize, FBakedColorAtlas& Atlas);
@@ -0,0 +1,30 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseTypes.h"
+
+class UStaticMesh;
+
+// Converts a scan file into a static mesh asset in the package PackageName 
+// (e.g. "/Game/Scans/Face"). Loading, LOD simplification, texture baking and
+// convex decomposition run on worker threads; only the creation and 
+// registration of the assets happen on the game thread, where OnComplete is
+// called with the new asset, or with nullptr on failure. An invalid package
+// name fails immediately, before any work is queued.
+// Assets can only be created in editor builds.
+void ConvertScanToStaticMeshAsync(const FString& ScanFilename, const FString& PackageName, 
+								  const FScanAssetOptions& Options, TFunction<void(UStaticMesh*)> OnComplete);
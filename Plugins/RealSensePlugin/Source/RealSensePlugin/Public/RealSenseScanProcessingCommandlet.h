@@ -0,0 +1,39 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "RealSenseScanProcessingCommandlet.generated.h"
+
+// Processes a library of scans offline. Every .OBJ file of the input directory
+// is cleaned of small disconnected pieces, smoothed and decimated, then written
+// to the output directory together with its convex hull cache, a .PNG 
+// thumbnail and a .settings file recording the processing settings. Files 
+// whose outputs are newer than the scan and were written with the same 
+// settings are skipped, unless -Force is given.
+//
+// Usage: UE4Editor-Cmd <Project> -run=RealSenseScanProcessing -Input=<Directory>
+//        [-Output=<Directory>] [-Jobs=<Files processed at once>] [-Smooth=<Iterations>]
+//        [-Resolution=<Decimation grid cells, 0 to keep all vertices>] 
+//        [-Hulls=<Maximum convex hulls, 0 to skip>] [-ThumbnailSize=<Pixels>] [-Force]
+// Relative directories are relative to the /Game/Content directory.
+UCLASS()
+class URealSenseScanProcessingCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	int32 Main(const FString& Params) override;
+};
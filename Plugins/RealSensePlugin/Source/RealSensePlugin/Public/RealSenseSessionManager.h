@@ -17,11 +17,15 @@
 
 #include "RealSenseImpl.h"
 #include "RealSenseTypes.h"
+#include "RealSenseFrameSnapshot.h"
 
 #include "RealSenseSessionManager.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FRealSenseNullaryDelegate);
 
+class UTriggerVolumeComponent;
+class LatencyProbe;
+
 UCLASS(ClassGroup = RealSense)
 class ARealSenseSessionManager : public AActor
 {
@@ -44,6 +48,13 @@ class ARealSenseSessionManager : public AActor
 	// Returns true if the camera processing thread is currently executing.
 	bool IsCameraRunning() const;
 
+	// Initializes the camera pipeline and the enabled middleware in the 
+	// background.
+	void PrewarmCamera();
+
+	// Returns true if a prewarmed pipeline is ready for StartCamera().
+	bool IsCameraPrewarmed() const;
+
 	// Returns true if there is a physical camera connected.
 	bool IsCameraConnected() const;
 
@@ -93,6 +104,79 @@ class ARealSenseSessionManager : public AActor
 	// resolution is valid. Validity is determined internally by the RSSDK.
 	bool IsStreamSetValid(EColorResolution ColorResolution, EDepthResolution DepthResolution) const;
 
+	// Returns all outputs of the latest frame without copying them. Unlike the
+	// buffers returned by the other functions, which are copied in Tick(), 
+	// the snapshot stays consistent when it is kept across ticks.
+	FRealSenseFrameSnapshot GetFrameSnapshot() const;
+
+	// Returns the number of the latest frame.
+	uint64 GetFrameNumber() const;
+
+	// Returns the timestamp of the latest frame in the sensor clock (in 100 ns units).
+	int64 GetFrameSensorTimestamp() const;
+
+	// Returns the host time (FPlatformTime::Seconds()) of the latest frame, 
+	// mapped from its sensor timestamp.
+	double GetFrameTimestamp() const;
+
+	// Returns the standard deviation (in seconds) of GetFrameTimestamp(), or a 
+	// negative value until enough frames have been received.
+	double GetFrameTimestampUncertainty() const;
+
+	// Returns the drift of the sensor clock relative to the host clock, in 
+	// parts per million.
+	double GetClockDriftPPM() const;
+
+	// Throttles the camera processing thread once NotifyDataAccess() has not 
+	// been called for IdleSeconds. The throttled thread acquires KeepAliveFPS 
+	// frames per second, or none at all if KeepAliveFPS is 0, until the next 
+	// access. Setting IdleSeconds to 0 disables throttling.
+	void SetCaptureThrottling(float IdleSeconds, float KeepAliveFPS);
+
+	// Records that RealSense data has been rendered or read, and resumes 
+	// capturing at full rate if the camera processing thread is throttled.
+	void NotifyDataAccess();
+
+	// Returns true if the camera processing thread is currently throttled.
+	bool IsCaptureThrottled() const;
+
+	// Keeps the camera frames of the last DurationSeconds in memory, as long 
+	// as they fit into MemoryLimitMB megabytes once compressed.
+	void EnableFrameRecording(float DurationSeconds, int32 MemoryLimitMB);
+
+	// Stops recording frames, ends the replay, and discards the recording.
+	void DisableFrameRecording();
+
+	// Returns true if camera frames are being recorded.
+	bool IsFrameRecordingEnabled() const;
+
+	// Returns the time span (in seconds) covered by the recorded frames.
+	float GetRecordedSeconds() const;
+
+	// Replaces the camera images of the published frames with recorded ones, 
+	// starting SecondsAgo before the latest recorded frame and advancing at 
+	// Speed times the game time. A negative Speed plays backwards. Replays 
+	// played forward end when they reach the frame at which they started.
+	// The head crop, upsampled depth and distance field images are blank 
+	// during a replay; the scan preview and all non-image outputs stay live.
+	void StartReplay(float SecondsAgo, float Speed);
+
+	// Moves the replay to SecondsAgo before the latest recorded frame.
+	void SeekReplay(float SecondsAgo);
+
+	// Changes the speed of the replay.
+	void SetReplaySpeed(float Speed);
+
+	// Returns to publishing live camera images.
+	void StopReplay();
+
+	// Returns true while recorded camera images are published.
+	bool IsReplaying() const;
+
+	// Returns how many seconds the replayed frame lies before the latest 
+	// recorded frame.
+	float GetReplaySecondsAgo() const;
+
 	// CameraStreamComponent Support
 
 	// Returns a pointer to the latest frame obtained from the RealSense RGB camera.
@@ -101,6 +185,119 @@ class ARealSenseSessionManager : public AActor
 	// Returns a pointer to the latest frame obtained from the RealSense depth camera.
 	TArray<int32> GetDepthBuffer() const;
 
+	// Returns the quality metrics of the latest frame from the RealSense depth camera.
+	FDepthQualityMetrics GetDepthQuality() const;
+
+	// Enables upsampling of the depth image to half or full color resolution, 
+	// guided by the RGB camera image. Requires both camera resolutions to be set.
+	void EnableDepthUpsampling(EDepthUpsampleScale Scale);
+
+	// Disables upsampling of the depth image.
+	void DisableDepthUpsampling();
+
+	// Returns the width of the upsampled depth image.
+	int32 GetUpsampledDepthImageWidth() const;
+
+	// Returns the height of the upsampled depth image.
+	int32 GetUpsampledDepthImageHeight() const;
+
+	// Returns the latest depth image upsampled to color resolution.
+	TArray<int32> GetUpsampledDepthBuffer() const;
+
+	// Returns the average time (in milliseconds) spent upsampling one depth image.
+	float GetDepthUpsampleMilliseconds() const;
+
+	// Enables a per-frame signed distance field of the foreground mask, taken
+	// either from 3D segmentation or from a depth threshold.
+	void EnableDistanceField(EDistanceFieldSource Source, int32 Width, int32 Height, 
+							 EDistanceFieldFormat Format, float MaxDistance);
+
+	// Disables the distance field.
+	void DisableDistanceField();
+
+	// Sets the depth range (in millimeters) treated as foreground by the 
+	// depth threshold source of the distance field.
+	void SetDistanceFieldDepthRange(int32 NearDepth, int32 FarDepth);
+
+	// Returns the width of the distance field image.
+	int32 GetDistanceFieldImageWidth() const;
+
+	// Returns the height of the distance field image.
+	int32 GetDistanceFieldImageHeight() const;
+
+	// Returns the latest distance field image as raw 8- or 16-bit pixels.
+	TArray<uint8> GetDistanceFieldBuffer() const;
+
+	// Replaces the camera with a stand-in source that stamps its color images
+	// with their frame number and capture time at FramesPerSecond, and starts
+	// measuring the latency of the stamped frames. Requires the color camera
+	// resolution to be set.
+	void StartLatencyTest(float FramesPerSecond);
+
+	// Logs the latency distributions and switches back to the camera.
+	void StopLatencyTest();
+
+	// Returns true while the stand-in source is running.
+	bool IsLatencyTestRunning() const;
+
+	// Measures the latency of the stamped frame that was written from the 
+	// Buffer to the Texture.
+	void RecordColorTextureUpload(const TArray<FSimpleColor>& Buffer, UTexture2D* Texture);
+
+	// TriggerVolumeComponent Support
+
+	// Registers a trigger volume to be tested against the depth points of 
+	// each frame and returns its identifier. The component is notified of 
+	// point count changes during Tick().
+	int32 AddTriggerVolume(UTriggerVolumeComponent* Component, const TriggerVolume& Volume);
+
+	// Replaces the transform, size, and point threshold of a trigger volume.
+	void UpdateTriggerVolume(int32 Id, const TriggerVolume& Volume);
+
+	// Unregisters a trigger volume.
+	void RemoveTriggerVolume(int32 Id);
+
+	// Sets the spacing (in pixels) of the depth points tested against the 
+	// trigger volumes.
+	void SetTriggerVolumeStride(int32 Stride);
+
+	// TouchDetectionComponent Support
+
+	// Averages the next NumFrames depth images into the reference surface 
+	// used by touch detection.
+	void StartTouchCalibration(int32 NumFrames);
+
+	// Enables detection of touches within a height band (in millimeters) 
+	// above the reference surface.
+	void EnableTouchDetection(int32 MinHeight, int32 MaxHeight, int32 MinArea, int32 MaxArea);
+
+	// Disables touch detection.
+	void DisableTouchDetection();
+
+	// Returns true once the reference surface has been calibrated.
+	bool IsTouchCalibrated() const;
+
+	// Returns the touches of the latest depth image.
+	TArray<FTouchPoint> GetTouchPoints() const;
+
+	// BodyBoundsComponent Support
+
+	// Enables estimating the bounds of the person closest to the depth camera.
+	void EnableBodyBounds();
+
+	// Disables estimating the body bounds.
+	void DisableBodyBounds();
+
+	// Sets the floor plane in world space. Body points must lie above it, and
+	// head heights are measured from it.
+	void SetFloorPlane(const FPlane& Plane);
+
+	// Removes the floor plane, so that world Z points up.
+	void ClearFloorPlane();
+
+	// Returns the body bounds of the latest depth image.
+	FBodyBounds GetBodyBounds() const;
+
 	// Scan3DComponent Support 
 
 	// Configures the 3D Scanning middleware.
@@ -151,6 +348,11 @@ class ARealSenseSessionManager : public AActor
 	// module, representing a preview of the current scanning progress.
 	TArray<FSimpleColor> GetScanBuffer() const;
 
+	// Sets whether Tick() copies the scan preview into the buffer returned by 
+	// GetScanBuffer(). Consumers that upload the preview from a frame snapshot
+	// can turn the copy off.
+	void SetScanBufferEnabled(bool bEnabled);
+
 	// Returns true if the resolution of the 3D scanning module has changed.
 	bool HasScan3DImageSizeChanged() const;
 
@@ -168,18 +370,84 @@ class ARealSenseSessionManager : public AActor
 	// Return the current head rotation
 	FRotator GetHeadRotation() const;
 
+	// Enables a fixed-size crop of the RGB camera image that follows the 
+	// tracked head. Requires the color camera resolution to be set.
+	void EnableHeadCrop(int32 Width, int32 Height, float Smoothing);
+
+	// Disables the head-centered crop of the RGB camera image.
+	void DisableHeadCrop();
+
+	// Returns the width of the head-centered crop.
+	int32 GetHeadCropImageWidth() const;
+
+	// Returns the height of the head-centered crop.
+	int32 GetHeadCropImageHeight() const;
+
+	// Returns the latest head-centered crop of the RGB camera image.
+	TArray<FSimpleColor> GetHeadCropBuffer() const;
+
+	// Starts queueing the head pose of every camera frame in a ring of at 
+	// least Capacity samples. Only a single consumer may drain the queue.
+	void EnableHeadPoseQueue(int32 Capacity);
+
+	// Stops queueing head poses and discards the queued samples.
+	void DisableHeadPoseQueue();
+
+	// Appends the head poses queued since the last call to Samples, and 
+	// returns the number of samples appended.
+	int32 DrainHeadPoseSamples(TArray<FHeadPoseSample>& Samples);
+
+	// Returns the number of head poses dropped because the queue was full,
+	// counted since the queue was enabled.
+	int32 GetDroppedHeadPoseSamples() const;
+
 	ARealSenseSessionManager();
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void Tick(float DeltaSeconds) override;
 
 private:
-	std::unique_ptr<RealSenseImpl> impl;
+	// Capture pipeline owned by the plugin module
+	std::shared_ptr<RealSenseImpl> impl;
 
 	uint8 RealSenseFeatureSet;
 
+	bool bScanBufferEnabled;
+
+	float CaptureIdleSeconds;
+	float CaptureKeepAliveFPS;
+	double LastDataAccessTime;
+
+	double ReplayTime;
+	double ReplayEndTime;
+	float ReplaySpeed;
+
+	// Latencies of the stamped frames while a latency test runs
+	std::shared_ptr<LatencyProbe> LatencyTestProbe;
+
 	TArray<FSimpleColor> ColorBuffer;
 	TArray<int32> DepthBuffer;
 	TArray<FSimpleColor> ScanBuffer;
+	TArray<FSimpleColor> HeadCropBuffer;
+	TArray<int32> UpsampledDepthBuffer;
+	TArray<uint8> DistanceFieldBuffer;
+	TArray<FTouchPoint> TouchPoints;
+
+	// Registered trigger volumes, keyed by identifier
+	TMap<int32, TriggerVolume> TriggerVolumes;
+	TMap<int32, TWeakObjectPtr<UTriggerVolumeComponent>> TriggerVolumeComponents;
+	int32 NextTriggerVolumeId;
+	bool bTriggerVolumesChanged;
+
+	// Occupied trigger volumes of the previous frame, sorted by identifier
+	TArray<FIntPoint> TriggerOccupancy;
+
+	void UpdateTriggerVolumes();
+
+	void UpdateCaptureThrottling();
+
+	void UpdateReplay(float DeltaTime);
 };
@@ -64,6 +64,35 @@ enum class ERealSensePixelFormat : uint8 {
 	DEPTH_G16_MM,   // 16-bit unsigned integer with precision mm.
 };
 
+// Output resolutions of the depth upsampling, relative to the RGB camera resolution
+UENUM(BlueprintType) 
+enum class EDepthUpsampleScale : uint8 {
+	HALF = 0 UMETA(DisplayName = "Half Color Resolution"),
+	FULL = 1 UMETA(DisplayName = "Full Color Resolution")
+};
+
+// Sources of the foreground mask used for the distance field
+UENUM(BlueprintType) 
+enum class EDistanceFieldSource : uint8 {
+	SEGMENTATION_3D = 0 UMETA(DisplayName = "3D Segmentation"),
+	DEPTH_THRESHOLD = 1 UMETA(DisplayName = "Depth Threshold")
+};
+
+// Pixel formats of the distance field image
+UENUM(BlueprintType) 
+enum class EDistanceFieldFormat : uint8 {
+	G8 = 0 UMETA(DisplayName = "8-bit"),
+	G16 = 1 UMETA(DisplayName = "16-bit")
+};
+
+// Pixel formats of the color and depth textures of the CameraStreamComponent
+UENUM(BlueprintType) 
+enum class ETextureCompression : uint8 {
+	NONE = 0 UMETA(DisplayName = "Uncompressed"),
+	FAST = 1 UMETA(DisplayName = "BC1 / BC4 (Fast)"),
+	HIGH_QUALITY = 2 UMETA(DisplayName = "BC1 / BC4 (High Quality)")
+};
+
 // Supported RealSense camera models
 UENUM(BlueprintType) 
 enum class ECameraModel : uint8 {
@@ -118,3 +147,155 @@ struct FStreamResolution
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	ERealSensePixelFormat format;
 };
+
+// Vertices of one convex piece of a scanned mesh, usable as convex collision
+USTRUCT(BlueprintType)
+struct FScanConvexHull
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<FVector> Vertices;
+};
+
+// Per-frame quality metrics of the RealSense depth stream
+USTRUCT(BlueprintType)
+struct FDepthQualityMetrics
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Fraction (0 - 1) of depth pixels that hold a valid depth value
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ValidRatio;
+	// Number of connected regions of invalid pixels that do not touch the image border
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 HoleCount;
+	// Number of pixels covered by those regions
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 HoleArea;
+	// Mean absolute change (in millimeters) of pixels that are valid and static in 
+	// this frame and the previous one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TemporalNoise;
+	// Median of all valid depth values (in millimeters)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MedianDepth;
+
+	FDepthQualityMetrics() : ValidRatio(0.0f), HoleCount(0), HoleArea(0), TemporalNoise(0.0f), MedianDepth(0) {}
+};
+
+// A fingertip touching the calibrated surface seen by the depth camera
+USTRUCT(BlueprintType)
+struct FTouchPoint
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Identifier that stays the same while the touch is tracked
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Id;
+	// Center of the touch in normalized (0 - 1) depth image coordinates
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2D Position;
+	// Mean height (in millimeters) of the touch above the surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Height;
+	// Number of depth pixels covered by the touch
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 Area;
+
+	FTouchPoint() : Id(0), Position(0.0f, 0.0f), Height(0.0f), Area(0) {}
+};
+
+// Bounds of the person closest to the depth camera, in world space
+USTRUCT(BlueprintType)
+struct FBodyBounds
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Whether a person-sized object was found in the latest frame
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bDetected;
+	// Center of the oriented bounding box (in centimeters)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Center;
+	// Half size of the box along its local axes. X is the widest horizontal 
+	// direction and Z points up.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Extent;
+	// Orientation of the box
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FRotator Rotation;
+	// Height of the top of the head above the floor plane, or its world Z if 
+	// no floor plane is set (in centimeters)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float HeadHeight;
+	// Mean of the body points (in centimeters)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Centroid;
+	// Smoothed velocity of the Centroid (in centimeters per second)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Velocity;
+	// Number of decimated depth points on the body
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 NumPoints;
+
+	FBodyBounds() : bDetected(false), Center(0.0f), Extent(0.0f), Rotation(0.0f, 0.0f, 0.0f), HeadHeight(0.0f), 
+					Centroid(0.0f), Velocity(0.0f), NumPoints(0) {}
+};
+
+// Head pose estimated from one camera frame
+USTRUCT(BlueprintType)
+struct FHeadPoseSample
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of the camera frame the pose was estimated from
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 FrameNumber;
+	// Host time of the camera frame (in seconds since the engine started)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Timestamp;
+	// Number of heads detected in the frame. Position and Rotation keep the 
+	// last tracked pose while this is 0.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 HeadCount;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Position;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FRotator Rotation;
+
+	FHeadPoseSample() : FrameNumber(0), Timestamp(0.0f), HeadCount(0), Position(0.0f), Rotation(0.0f, 0.0f, 0.0f) {}
+};
+
+// Options for converting a scan file into a static mesh asset
+USTRUCT(BlueprintType)
+struct FScanAssetOptions
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of LODs, including the full resolution LOD 0
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 NumLODs;
+	// Grid cells along the longest side of the scan used to simplify LOD 1.
+	// Each further LOD halves this number.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 LOD1Resolution;
+	// Number of Taubin smoothing iterations applied before building the LODs
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 SmoothingIterations;
+	// Whether to add convex collision computed by convex decomposition
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bGenerateCollision;
+	// Maximum number of convex hulls of the collision
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxCollisionHulls;
+	// Whether to bake the vertex colors into a texture asset mapped by UV 0
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bBakeTexture;
+	// Size of the baked texture
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 TextureSize;
+
+	FScanAssetOptions() : NumLODs(4), LOD1Resolution(128), SmoothingIterations(0), bGenerateCollision(true), 
+						  MaxCollisionHulls(16), bBakeTexture(true), TextureSize(1024) {}
+};
@@ -22,6 +22,9 @@
 // Log Category that can be used by all RealSensePlugin source files that inclue this file
 DECLARE_LOG_CATEGORY_EXTERN(RealSensePlugin, Log, All);
 
+// Stat group for the counters and timers of the RealSense processing stages
+DECLARE_STATS_GROUP(TEXT("RealSense"), STATGROUP_RealSense, STATCAT_Advanced);
+
 #if defined ( WIN32 )
 #define __func__ __FUNCTION__
 #endif
@@ -49,6 +52,9 @@ DECLARE_LOG_CATEGORY_EXTERN(RealSensePlugin, Log, All);
 // Converts a Vector from RealSense camera space to UE4 world space.
 FVector ConvertRSVectorToUnreal(FVector v);
 
+// Converts a Vector from UE4 world space to RealSense camera space.
+FVector ConvertUnrealVectorToRS(FVector v);
+
 // Converts a depth value (in millimeters) to an 8-bit scale (between 0 - 255).
 uint8 ConvertDepthValueTo8Bit(int32 depth, int32 width);
 
@@ -76,4 +82,33 @@ void CopySegmentedImageToBuffer(PXCImage* image, TArray<uint8>& data, const uint
 // Copies the data from the input depth PXCImage into the input data structure.
 void CopyDepthImageToBuffer(PXCImage* image, TArray<uint16>& data, const uint32 width, const uint32 height);
 
-void LoadMeshFile(const FString& filename, TArray<FVector>& Vertices, TArray<int32>& Triangles, TArray<FColor>& Colors);
+// Resamples a rectangular window of the input BGRA image into the output BGRA image.
+void CropAndScaleImage(const TArray<uint8>& src, const uint32 srcWidth, const uint32 srcHeight,
+					   float x0, float y0, float width, float height,
+					   TArray<uint8>& dst, const uint32 dstWidth, const uint32 dstHeight);
+
+// Loads an .OBJ file written by the 3D Scanning middleware, converts it to UE4 
+// world space, and computes vertex normals and tangents for lit rendering.
+void LoadMeshFile(const FString& filename, TArray<FVector>& Vertices, TArray<int32>& Triangles, TArray<FColor>& Colors,
+				  TArray<FVector>& Normals, TArray<FVector>& Tangents);
+
+// Size and timings of a SaveMeshFile() call
+struct FMeshFileWriteStats {
+	int64 Bytes{ 0 };
+	double FormatSeconds{ 0.0 };
+	double WriteSeconds{ 0.0 };
+	double TotalSeconds{ 0.0 };
+
+	inline double GetMegabytesPerSecond(double Seconds) const 
+	{ 
+		return (Seconds > 0.0) ? (Bytes / (1024.0 * 1024.0)) / Seconds : 0.0; 
+	}
+};
+
+// Writes a mesh in UE4 world space to an .OBJ file in the layout of the 3D 
+// Scanning middleware, so that LoadMeshFile() can read it back, or to an 
+// ASCII .PLY file if the filename ends in .ply. Normals are computed if the 
+// Normals array does not hold one per vertex. Throughput is logged and, if
+// Stats is not null, returned.
+bool SaveMeshFile(const FString& filename, const TArray<FVector>& Vertices, const TArray<int32>& Triangles,
+				  const TArray<FColor>& Colors, const TArray<FVector>& Normals, FMeshFileWriteStats* Stats = nullptr);
@@ -16,6 +16,8 @@
 #pragma once
 
 #include "RealSenseComponent.h"
+#include "Async.h"
+#include "RealSenseMeshUtils.h"
 #include "Scan3DComponent.generated.h"
 
 UCLASS(editinlinenew, meta = (BlueprintSpawnableComponent), ClassGroup = RealSense) 
@@ -30,10 +32,17 @@ class UScan3DComponent : public URealSenseComponent
 	TArray<FSimpleColor> ScanBuffer;
 
 	// Convenient Texture2D object used to easily visualize the ScanBuffer. 
-	// This texture can be set by calling ColorBufferToTexture().
+	// This texture can be set by calling ColorBufferToTexture(), or is updated
+	// automatically if bDirectPreviewUpload is set.
 	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
 	UTexture2D* ScanTexture;
 
+	// If set, the scanning preview is uploaded from the camera frame straight 
+	// to the ScanTexture on the render thread every tick, and the ScanBuffer 
+	// is no longer filled.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RealSense") 
+	bool bDirectPreviewUpload;
+
 	// Array of mesh vertices. This array is populated by the LoadScan() function.
 	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
 	TArray<FVector> Vertices;
@@ -45,6 +54,29 @@ class UScan3DComponent : public URealSenseComponent
 	// Array of mesh vertex colors. This array is populated by the LoadScan() function.
 	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
 	TArray<FColor> Colors;
+
+	// Array of convex hulls approximating the loaded scan, suitable for
+	// convex collision. This array is populated by ComputeCollisionHulls().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	TArray<FScanConvexHull> CollisionHulls;
+
+	// Array of mesh vertex normals. This array is populated by the LoadScan() function.
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	TArray<FVector> Normals;
+
+	// Array of mesh vertex tangents. This array is populated by the LoadScan() function.
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	TArray<FVector> Tangents;
+
+	// Array of mesh texture coordinates into the ColorTexture. This array is 
+	// populated by BakeColorTexture() and empty otherwise.
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	TArray<FVector2D> UV0;
+
+	// Texture holding the vertex colors of the loaded scan, mapped by the UV0
+	// array. This texture is created by BakeColorTexture().
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense") 
+	UTexture2D* ColorTexture;
 	
 	// Triggered after a scan has been saved to disk. A call to SaveScan() will 
 	// asynchronously save the scan. You can use this event to be notified when the 
@@ -52,6 +84,16 @@ class UScan3DComponent : public URealSenseComponent
 	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
 	FRealSenseNullaryDelegate OnScanComplete;
 
+	// Triggered when the CollisionHulls requested by ComputeCollisionHulls() 
+	// are available.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FRealSenseNullaryDelegate OnCollisionHullsComputed;
+
+	// Triggered when the ColorTexture requested by BakeColorTexture() is 
+	// available and the mesh arrays have been replaced by the textured mesh.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FRealSenseNullaryDelegate OnColorTextureBaked;
+
 	// Sets the scanning mode and options for 3D Scanning. After calling this function, 
 	// the scanning preview image will be available in the ScanBuffer.
 	UFUNCTION(BlueprintCallable, Category = "RealSense") 
@@ -72,10 +114,45 @@ class UScan3DComponent : public URealSenseComponent
 	void SaveScan(FString Filename);
 
 	// Opens the specified .OBJ file and loads the mesh information into this 
-	// component's Vertices, Triangles, and Colors arrays.
+	// component's Vertices, Triangles, Colors, Normals, and Tangents arrays.
 	UFUNCTION(BlueprintCallable, Category = "RealSense") 
 	void LoadScan(FString Filename);
 
+	// Writes the loaded scan, including any smoothing or other processing, to 
+	// an .OBJ file, or to a .PLY file if the filename ends in .ply. The file 
+	// is written relative to the /Game/Content directory like SaveScan().
+	UFUNCTION(BlueprintCallable, Category = "RealSense") 
+	bool ExportScan(FString Filename);
+
+	// Smooths the loaded scan in place with the given number of Taubin 
+	// smoothing iterations, removing sensor noise without shrinking the mesh.
+	// Call this function after LoadScan().
+	UFUNCTION(BlueprintCallable, Category = "RealSense") 
+	void SmoothScan(int32 Iterations = 5);
+
+	// Asynchronously decomposes the loaded scan into at most MaxHulls convex
+	// hulls, computed on a voxel grid with Resolution voxels along the longest
+	// side of the scan. The hulls are cached next to the scan file, so loading
+	// the same scan again returns them without recomputing. OnCollisionHullsComputed
+	// is triggered when the CollisionHulls array has been filled. Loading or 
+	// smoothing the scan in the meantime discards the pending result.
+	UFUNCTION(BlueprintCallable, Category = "RealSense") 
+	void ComputeCollisionHulls(int32 MaxHulls = 16, int32 Resolution = 48);
+
+	// Asynchronously bakes the vertex colors of the loaded scan into a square 
+	// ColorTexture of the given size. When OnColorTextureBaked is triggered, 
+	// the mesh arrays have been split along the texture seams and UV0 maps 
+	// each vertex into the ColorTexture, so the mesh can be decimated without
+	// losing color detail. Loading or smoothing the scan in the meantime 
+	// discards the pending bake.
+	UFUNCTION(BlueprintCallable, Category = "RealSense") 
+	void BakeColorTexture(int32 TextureSize = 1024);
+
+	// Switches between filling the ScanBuffer and uploading the preview 
+	// directly to the ScanTexture. See bDirectPreviewUpload.
+	UFUNCTION(BlueprintCallable, Category = "RealSense") 
+	void SetDirectPreviewUpload(bool bEnable);
+
 	// Returns true if the scanning is currently happening. Use this function after 
 	// calling StartScanning() to know when the scanning process has begun.
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense") 
@@ -91,4 +168,24 @@ class UScan3DComponent : public URealSenseComponent
 private:
 	// Used internally to know when to listen for ScanComplete events.
 	bool bHasScanStarted{ false };
+
+	// Absolute path of the scan file loaded by LoadScan()
+	FString LoadedScanFilename;
+
+	// Result of the convex decomposition running in the background. It is 
+	// discarded when the mesh is replaced before the decomposition finishes.
+	TFuture<TArray<FScanConvexHull>> CollisionHullsResult;
+
+	// Result of the color texture baking running in the background. It is 
+	// discarded when the mesh is replaced before the baking finishes.
+	TFuture<TSharedPtr<FBakedColorAtlas, ESPMode::ThreadSafe>> ColorAtlasResult;
+
+	// Number of the frame last uploaded to the ScanTexture
+	uint64 PreviewFrameNumber{ 0 };
+
+	// Swaps the baked mesh and texture into this component
+	void ApplyColorAtlas(FBakedColorAtlas& Atlas);
+
+	// Enqueues the upload of the latest preview image to the ScanTexture
+	void UploadPreview();
 };
@@ -0,0 +1,76 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseComponent.h"
+#include "TouchDetectionComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FTouchPointDelegate, FTouchPoint, Touch);
+
+// Detects fingertips touching a physical surface, such as a table that 
+// is seen from above by the depth camera. Call Calibrate() while the 
+// surface is empty, then the touches are updated every frame. Touches keep 
+// their Id while they move, so they can drive multi-touch interaction.
+UCLASS(editinlinenew, meta = (BlueprintSpawnableComponent), ClassGroup = RealSense) 
+class UTouchDetectionComponent : public URealSenseComponent
+{
+	GENERATED_UCLASS_BODY()
+
+	// Touches of the latest depth image
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	TArray<FTouchPoint> TouchPoints;
+
+	// True once the reference surface has been calibrated
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	bool bCalibrated;
+
+	// Triggered when the calibration requested by Calibrate() has finished.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FRealSenseNullaryDelegate OnCalibrated;
+
+	// Triggered when a new touch appears.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FTouchPointDelegate OnTouchBegin;
+
+	// Triggered when a touch is lifted, with its last known position.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FTouchPointDelegate OnTouchEnd;
+
+	// Averages the next NumFrames (at most 1024) depth images into the 
+	// reference surface. Nothing should touch the surface until OnCalibrated 
+	// is triggered. Calibration runs while touch detection is enabled.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void Calibrate(int32 NumFrames = 30);
+
+	// Starts detecting touches. Pixels between MinHeight and MaxHeight 
+	// millimeters above the surface belong to a touch, and groups of 
+	// pixels are only reported if their area (in depth pixels) lies 
+	// between MinArea and MaxArea. Requires the depth camera resolution 
+	// to be set.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void EnableTouchDetection(int32 MinHeight = 5, int32 MaxHeight = 30, int32 MinArea = 8, int32 MaxArea = 2000);
+
+	// Stops detecting touches.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void DisableTouchDetection();
+
+	UTouchDetectionComponent();
+
+	void InitializeComponent() override;
+	
+	void TickComponent(float DeltaTime, enum ELevelTick TickType, 
+		               FActorComponentTickFunction *ThisTickFunction) override;
+};
@@ -0,0 +1,89 @@
+/////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright 2017 Intel Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+/////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include "RealSenseComponent.h"
+#include "TriggerVolumeComponent.generated.h"
+
+// Box in the world that is tested against the points of the RealSense depth
+// camera. The RealSenseSessionManager actor stands for the camera, so place 
+// it where the physical camera is relative to the scene. The volume is 
+// occupied while at least MinPoints depth points fall inside it.
+UCLASS(editinlinenew, meta = (BlueprintSpawnableComponent), ClassGroup = RealSense) 
+class UTriggerVolumeComponent : public URealSenseComponent
+{
+	GENERATED_UCLASS_BODY()
+
+	// Transform of the box relative to the owning actor
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RealSense")
+	FTransform VolumeTransform;
+
+	// Half size of the box (in centimeters)
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RealSense")
+	FVector BoxExtent;
+
+	// Number of depth points needed for the volume to become occupied
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RealSense")
+	int32 MinPoints;
+
+	// Number of depth points inside the volume in the latest frame, or 0 
+	// while the volume is not occupied
+	UPROPERTY(BlueprintReadOnly, Category = "RealSense")
+	int32 PointCount;
+
+	// Triggered when the volume becomes occupied.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FRealSenseNullaryDelegate OnTriggerEnter;
+
+	// Triggered when the volume is no longer occupied.
+	UPROPERTY(BlueprintAssignable, Category = "RealSense") 
+	FRealSenseNullaryDelegate OnTriggerExit;
+
+	// Sets the transform and size of the box. Call UpdateVolume() instead 
+	// if only the owning actor has moved.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void SetVolume(FTransform Transform, FVector Extent);
+
+	// Sends the current world transform of the volume to the camera 
+	// processing thread.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void UpdateVolume();
+
+	// Sets the spacing (in pixels) of the depth points tested against all 
+	// trigger volumes. Larger strides are cheaper but need a lower MinPoints.
+	UFUNCTION(BlueprintCallable, Category = "RealSense")
+	void SetPointStride(int32 Stride = 2);
+
+	// Returns true if the volume is occupied.
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "RealSense")
+	bool IsOccupied() const;
+
+	// Called by the RealSenseSessionManager with the point count of the 
+	// latest frame. Raises OnTriggerEnter and OnTriggerExit.
+	void UpdatePointCount(int32 Count);
+
+	UTriggerVolumeComponent();
+
+	void BeginPlay() override;
+
+	void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	TriggerVolume MakeVolume() const;
+
+	// Identifier of the volume in the RealSenseSessionManager, or INDEX_NONE
+	int32 VolumeId;
+};
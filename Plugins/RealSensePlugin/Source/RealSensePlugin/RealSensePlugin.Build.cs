@@ -26,7 +26,13 @@ namespace UnrealBuildTool.Rules
             UEBuildConfiguration.bForceEnableExceptions = true;
 
             PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine" });
-            PrivateDependencyModuleNames.AddRange(new string[] { "RHI", "RenderCore", "ShaderCore" });
+            PrivateDependencyModuleNames.AddRange(new string[] { "RHI", "RenderCore", "ShaderCore", "ImageWrapper" });
+
+            // Creating static mesh assets from scans is only supported in the editor
+            if (UEBuildConfiguration.bBuildEditor)
+            {
+                PrivateDependencyModuleNames.AddRange(new string[] { "UnrealEd", "RawMesh", "AssetRegistry" });
+            }
 
             PrivateIncludePaths.AddRange(new string[] { "RealSensePlugin/Private" });
 